@@ -0,0 +1,26 @@
+# - Find zstd
+# Find the native zstd includes and library
+#
+#  ZSTD_INCLUDE_DIRS  - where to find zstd.h, etc
+#  ZSTD_LIBRARIES     - Link these libraries when using zstd
+#  ZSTD_FOUND         - True if zstd was found
+
+if (ZSTD_INCLUDE_DIR AND ZSTD_LIBRARY)
+  # Already in cache, be silent
+  set (ZSTD_FIND_QUIETLY TRUE)
+endif (ZSTD_INCLUDE_DIR AND ZSTD_LIBRARY)
+
+find_path (ZSTD_INCLUDE_DIR zstd.h
+  HINTS ZSTD_DIR ENV ZSTD_DIR)
+
+find_library (ZSTD_LIBRARY NAMES zstd zstd_static)
+
+# handle the QUIETLY and REQUIRED arguments and set ZSTD_FOUND to TRUE if
+# all listed variables are TRUE
+include (FindPackageHandleStandardArgs)
+find_package_handle_standard_args (ZSTD DEFAULT_MSG ZSTD_LIBRARY ZSTD_INCLUDE_DIR)
+
+set (ZSTD_INCLUDE_DIRS ${ZSTD_INCLUDE_DIR})
+set (ZSTD_LIBRARIES ${ZSTD_LIBRARY})
+
+mark_as_advanced (ZSTD_LIBRARY ZSTD_INCLUDE_DIR)
@@ -5,9 +5,11 @@
 #define CHEMFILES_ATOM_HPP
 
 #include <string>
+#include <memory>
 
 #include "chemfiles/exports.hpp"
 #include "chemfiles/Property.hpp"
+#include "chemfiles/interned_string.hpp"
 #include "chemfiles/external/optional.hpp"
 
 namespace chemfiles {
@@ -22,6 +24,10 @@ namespace chemfiles {
 /// The atom name is usually an unique identifier ("H1", "C_a") while the atom
 /// type will be shared between all particles of the same type: "H", "Ow",
 /// "CH3".
+///
+/// To keep the memory used by large systems small, the atom names and types
+/// are stored only once and shared between all atoms with the same name or
+/// type, and the properties are only allocated when the first property is set.
 class CHFL_EXPORT Atom final {
 public:
     /// Create an atom with the given `name` and set the atom type to be the
@@ -51,18 +57,18 @@ public:
     ~Atom() = default;
     Atom(Atom&&) = default;
     Atom& operator=(Atom&&) = default;
-    Atom(const Atom&) = default;
-    Atom& operator=(const Atom&) = default;
+    Atom(const Atom& other);
+    Atom& operator=(const Atom& other);
 
     /// Get the atom name.
     ///
     /// @example{tests/doc/atom/name.cpp}
-    const std::string& name() const { return name_; }
+    const std::string& name() const { return name_.str(); }
 
     /// Get the atom type.
     ///
     /// @example{tests/doc/atom/type.cpp}
-    const std::string& type() const { return type_; }
+    const std::string& type() const { return type_.str(); }
 
     /// Get the atom mass.
     ///
@@ -85,12 +91,12 @@ public:
     /// Set the atom name to `name`.
     ///
     /// @example{tests/doc/atom/name.cpp}
-    void set_name(std::string name) { name_ = std::move(name); }
+    void set_name(std::string name) { name_ = interned_string(std::move(name)); }
 
     /// Set the atom type to `type`.
     ///
     /// @example{tests/doc/atom/type.cpp}
-    void set_type(std::string type) { type_ = std::move(type); }
+    void set_type(std::string type) { type_ = interned_string(std::move(type)); }
 
     /// Set the atom mass to `mass`.
     ///
@@ -174,7 +180,7 @@ public:
     ///
     /// @example{tests/doc/atom/properties.cpp}
     const property_map& properties() const {
-        return properties_;
+        return properties_ ? *properties_ : no_properties();
     }
 
     /// Set an arbitrary `Property` for this atom with the given `name` and
@@ -183,7 +189,10 @@ public:
     ///
     /// @example{tests/doc/atom/property.cpp}
     void set(std::string name, Property value) {
-        properties_.set(std::move(name), std::move(value));
+        if (!properties_) {
+            properties_.reset(new property_map());  // NOLINT no make_unique in C++11
+        }
+        properties_->set(std::move(name), std::move(value));
     }
 
     /// Get the `Property` with the given `name` for this atom if it exists.
@@ -198,7 +207,10 @@ public:
     ///
     /// @example{tests/doc/atom/property.cpp}
     optional<const Property&> get(const std::string& name) const {
-        return properties_.get(name);
+        if (!properties_) {
+            return nullopt;
+        }
+        return properties_->get(name);
     }
 
     /// Get the `Property` with the given `name` for this atom if it exists,
@@ -218,28 +230,33 @@ public:
     /// @example{tests/doc/atom/property.cpp}
     template<Property::Kind kind>
     optional<typename property_metadata<kind>::type> get(const std::string& name) const {
-        return properties_.get<kind>(name);
+        if (!properties_) {
+            return nullopt;
+        }
+        return properties_->get<kind>(name);
     }
 
 private:
+    /// Get an empty property map, used for atoms without properties
+    static const property_map& no_properties();
+
     /// the atom name
-    std::string name_;
+    interned_string name_;
     /// the atom type
-    std::string type_;
+    interned_string type_;
     /// the atom mass
     double mass_ = 0;
     /// the atom charge
     double charge_ = 0;
-    /// Additional properties of this atom
-    property_map properties_;
-
-    friend bool operator==(const Atom& lhs, const Atom& rhs);
+    /// Additional properties of this atom, only allocated when setting the
+    /// first property
+    std::unique_ptr<property_map> properties_;
 };
 
 inline bool operator==(const Atom& lhs, const Atom& rhs) {
     return (lhs.name() == rhs.name() && lhs.type() == rhs.type() &&
             lhs.mass() == rhs.mass() && lhs.charge() == rhs.charge() &&
-            lhs.properties_ == rhs.properties_);
+            lhs.properties() == rhs.properties());
 }
 
 inline bool operator!=(const Atom& lhs, const Atom& rhs) {
@@ -4,6 +4,7 @@
 #ifndef CHEMFILES_CONFIGURATION_HPP
 #define CHEMFILES_CONFIGURATION_HPP
 
+#include <atomic>
 #include <string>
 #include <unordered_map>
 
@@ -78,6 +79,13 @@ public:
     /// thrown.
     static void add(const std::string& path);
 
+    /// Get the current generation of the atomic data, which changes every
+    /// time the atomic data is modified by a configuration file. This is
+    /// used to know when atomic data cached elsewhere must be looked up again.
+    static uint64_t generation() {
+        return instance().generation_.load(std::memory_order_acquire);
+    }
+
 private:
     Configuration();
     void read(const std::string& path);
@@ -92,6 +100,7 @@ private:
     mutex<types_map> types_;
     /// Map for element type => data assocations
     mutex<atomic_data_map> atoms_;
+    std::atomic<uint64_t> generation_ = {1};
 };
 
 } // namespace chemfiles
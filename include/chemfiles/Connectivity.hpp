@@ -5,6 +5,8 @@
 #define CHEMFILES_CONNECTIVITY_HPP
 
 #include <array>
+#include <atomic>
+#include <mutex>
 #include <cassert>
 
 #include "chemfiles/sorted_set.hpp"
@@ -292,9 +294,17 @@ inline bool operator>=(const Improper& lhs, const Improper& rhs) {
 /// in the system. The `recalculate` function should be called when bonds are
 /// added or removed. The `bonds` set is the main source of information, all the
 /// other data are cached from it.
+///
+/// The angles, dihedrals and impropers are computed from the bonds when first
+/// needed, and can be safely accessed from multiple threads.
 class Connectivity final {
 public:
     Connectivity() = default;
+    ~Connectivity() = default;
+    Connectivity(const Connectivity& other);
+    Connectivity& operator=(const Connectivity& other);
+    Connectivity(Connectivity&& other) noexcept;
+    Connectivity& operator=(Connectivity&& other) noexcept;
 
     /// Get the bonds in this connectivity
     const sorted_set<Bond>& bonds() const;
@@ -325,7 +335,12 @@ public:
 
     /// Get the bond order of the bond between i and j
     Bond::BondOrder bond_order(size_t i, size_t j) const;
+
+    /// Remove all bonds in this connectivity, keeping the allocated memory
+    void clear();
 private:
+    /// Recalculate the angles and the dihedrals from the bond list if needed
+    void update() const;
     /// Recalculate the angles and the dihedrals from the bond list
     void recalculate() const;
 
@@ -341,7 +356,10 @@ private:
     /// Improper dihedral angles in the system
     mutable sorted_set<Improper> impropers_;
     /// Is the cached content up to date ?
-    mutable bool uptodate_ = false;
+    mutable std::atomic<bool> uptodate_ = {false};
+    /// Mutex used to recalculate the cached content only once when
+    /// accessing it from multiple threads
+    mutable std::mutex mutex_;
     /// Store the bond orders
     std::vector<Bond::BondOrder> bond_orders_;
 };
@@ -5,6 +5,7 @@
 #define CHEMFILES_ERROR_FMT_HPP
 
 #include "chemfiles/Error.hpp"
+#include "chemfiles/string_view.hpp"
 #include <fmt/format.h>
 
 /// This file contains [fmt] based error constructors. These constructors are
@@ -65,4 +66,14 @@ inline PropertyError property_error(const char *format, const Args & ... argumen
 
 } // namespace chemfiles
 
+namespace fmt {
+    /// Allow to use `chemfiles::string_view` as arguments to fmt functions
+    template <> struct formatter<chemfiles::string_view>: formatter<string_view> {
+        template <typename FormatContext>
+        auto format(const chemfiles::string_view& view, FormatContext& context) -> decltype(context.out()) {
+            return formatter<string_view>::format(string_view(view.data(), view.size()), context);
+        }
+    };
+}
+
 #endif
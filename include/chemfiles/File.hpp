@@ -10,9 +10,15 @@
 #include <memory>
 
 #include "chemfiles/exports.hpp"
+#include "chemfiles/string_view.hpp"
+#include "chemfiles/external/optional.hpp"
 
 namespace chemfiles {
 
+/// Get the size of the buffers used by compressed files, as set by
+/// `chemfiles::set_compressed_buffer_size`
+size_t CHFL_EXPORT compressed_buffer_size();
+
 /// Abstract base class for file representation.
 class CHFL_EXPORT File {
 public:
@@ -34,6 +40,8 @@ public:
         GZIP,
         /// lzma compression (.xz)
         LZMA,
+        /// zstd compression (.zst)
+        ZSTD,
     };
 
     virtual ~File() noexcept = default;
@@ -71,12 +79,43 @@ class CHFL_EXPORT TextFile: public File, public std::iostream {
 public:
     /// Open the file at the given `path` with the requested `mode` and
     /// `compression` method using the most adapted child class of `TextFile`.
-    static std::unique_ptr<TextFile> open(std::string path, File::Mode mode, File::Compression compression);
+    /// Compressed files use buffers of `buffer_size` bytes to read and write
+    /// data.
+    static std::unique_ptr<TextFile> open(
+        std::string path, File::Mode mode, File::Compression compression,
+        size_t buffer_size = compressed_buffer_size()
+    );
 
     /// Read a line from the file
     std::string readline();
     /// Read `n` lines from the file
     std::vector<std::string> readlines(size_t n);
+
+    /// Read a line from the file, without allocating a new string. The
+    /// returned view is only valid until the next read, seek or write
+    /// operation on this file.
+    string_view readline_view();
+    /// Read `n` lines from the file, without allocating new strings. The
+    /// returned views are only valid until the next read, seek or write
+    /// operation on this file.
+    const std::vector<string_view>& readlines_view(size_t n);
+
+    /// Read a line from the file like `readline_view`, returning `nullopt`
+    /// instead of throwing an error if the line can not be read.
+    optional<string_view> try_readline_view();
+    /// Skip over the next `n` lines in the file, returning `false` if the
+    /// file does not contain `n` more lines.
+    bool skip_lines(size_t n);
+    /// Signal that a full step was written to the file, and that the next
+    /// data belongs to a new step. Compressed files can use this to start a
+    /// new independent block of compressed data. The default implementation
+    /// does nothing.
+    virtual void step_boundary() {}
+    /// Share the data used to seek in this file with `other`, a file opened
+    /// for reading at the same path. Compressed files use this to share the
+    /// index of their compressed data. The default implementation does
+    /// nothing.
+    virtual void share_index(TextFile& /*other*/) {}
     /// Reset the file cursor
     void rewind();
     /// Are we at the end of the file ?
@@ -88,8 +127,29 @@ protected:
     /// through the provided `buffer`.
     TextFile(std::string path, File::Mode mode, File::Compression compression, std::streambuf* buffer);
 
+    /// Read a single line in `string`, handling all possible end of line
+    /// markers (`\n`, `\r`, `\r\n`). Implementations with direct access to
+    /// the file content can override this function to search for the line
+    /// endings in bulk.
+    ///
+    /// This function is only called when the file is in a good state, and
+    /// should set `eofbit` if it reaches the end of the file without reading
+    /// anything. It must not set `failbit`, to avoid throwing exceptions in
+    /// ordinary conditions.
+    virtual void get_line(std::string& string);
+
+    /// Read a single line, and return a view of it. The default
+    /// implementation reads the line in `buffer` using `get_line`.
+    /// Implementations with direct access to the file content can return a
+    /// view inside this content instead.
+    virtual string_view get_line_view(std::string& buffer);
+
 private:
-    void get_line(std::string& string);
+    /// Reusable storage for the lines read with `readline_view` and
+    /// `readlines_view`
+    std::vector<std::string> lines_buffers_;
+    /// Views returned by `readlines_view`
+    std::vector<string_view> lines_views_;
 };
 
 } // namespace chemfiles
@@ -6,6 +6,7 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 #include <functional>
 
 #include "chemfiles/exports.hpp"
@@ -13,6 +14,7 @@
 
 namespace chemfiles {
 class Frame;
+struct FrameMetadata;
 
 /// The `Format` class defines the interface to implement in order to add a new
 /// format to chemfiles. It is possible to implement only one of `Format::read`;
@@ -44,6 +46,22 @@ public:
     /// @param frame The frame to fill
     virtual void read(Frame& frame);
 
+    /// @brief Read the metadata of a specific step from the trajectory file,
+    /// without reading the positions of the atoms if possible.
+    ///
+    /// The default implementation reads the whole step with `read_step`.
+    /// Formats where the number of atoms, the unit cell or the frame
+    /// properties can be found without reading everything else should
+    /// override this function. This can change the step read by the next
+    /// call to `read`.
+    ///
+    /// @throw FormatError if the file does not follow the format
+    /// @throw FileError if their is an OS error while reading the file
+    ///
+    /// @param step The step to read
+    /// @param metadata The metadata to fill
+    virtual void read_metadata(size_t step, FrameMetadata& metadata);
+
     /// @brief Write a frame to the trajectory file.
     ///
     /// @throw FormatError if the file does not follow the format
@@ -55,6 +73,60 @@ public:
     /// @brief Get the number of frames in the associated file
     /// @return The number of frames
     virtual size_t nsteps() = 0;
+
+    /// @brief Check if the associated file contains the given `step`.
+    ///
+    /// The default implementation compares `step` with `nsteps()`. Formats
+    /// finding the steps in the file incrementally should override this
+    /// function to only look as far in the file as needed.
+    ///
+    /// @param step The step to check
+    /// @return `true` if `step` can be read from the file
+    virtual bool has_step(size_t step);
+
+    /// @brief Re-use the information about the steps already found by `other`,
+    /// such as the position of the steps in the file or the number of steps.
+    ///
+    /// This is used when opening the same file multiple times for reading,
+    /// to avoid finding the steps again in each copy. `other` is a format of
+    /// the same type, reading the same file. Immutable data can be shared
+    /// between both formats, but both must still be usable from different
+    /// threads. The default implementation does nothing.
+    ///
+    /// @param other The format to take steps information from
+    virtual void reuse_steps(Format& other);
+
+    /// @brief Only read the atoms with the given `indices` in the next
+    /// frames, if the format is able to do so.
+    ///
+    /// The `indices` are sorted and unique, and an empty vector means that
+    /// all atoms should be read again. Formats able to read only part of the
+    /// data in a step should override this function and return `true`, and
+    /// then fill frames containing only these atoms, in the same order as in
+    /// the file. The default implementation returns `false`, and the atoms
+    /// are then extracted from the full frames by `chemfiles::Trajectory`.
+    ///
+    /// @param indices The indices of the atoms to read
+    /// @return `true` if the next frames will only contain the given atoms
+    virtual bool set_atom_subset(const std::vector<size_t>& indices);
+
+    /// @brief Only read the positions, velocities and unit cell in the next
+    /// frames, skipping the topology.
+    ///
+    /// This is used when the topology is the same for all the steps, and
+    /// already known by `chemfiles::Trajectory`. Formats reading topological
+    /// data (atom names, residues, bonds, *etc.*) for each step should
+    /// override this function and return `true` if `positions_only` is
+    /// `true`. The formats can then skip parsing everything but the positions,
+    /// velocities and unit cell, and only `resize` the frames to the right
+    /// number of atoms. The frames given to `read` usually already contain the
+    /// known topology, which `resize` keeps if the number of atoms matches.
+    /// The default implementation returns `false`.
+    ///
+    /// @param positions_only should the next frames only contain positions,
+    ///                       velocities and unit cell?
+    /// @return `true` if the next frames will not contain the topology
+    virtual bool set_positions_only(bool positions_only);
 };
 
 /// Metadata associated with a format.
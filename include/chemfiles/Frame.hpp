@@ -142,8 +142,8 @@ public:
     ///
     /// @example{tests/doc/frame/velocities.cpp}
     optional<span<Vector3D>> velocities() {
-        if (velocities_) {
-            return {*velocities_};
+        if (has_velocities_) {
+            return {velocities_};
         } else {
             return nullopt;
         }
@@ -154,8 +154,8 @@ public:
     ///
     /// @example{tests/doc/frame/velocities.cpp}
     optional<const std::vector<Vector3D>&> velocities() const {
-        if (velocities_) {
-            return {*velocities_};
+        if (has_velocities_) {
+            return {velocities_};
         } else {
             return nullopt;
         }
@@ -180,6 +180,16 @@ public:
     /// @example{tests/doc/frame/reserve.cpp}
     void reserve(size_t size);
 
+    /// Remove all atoms, bonds, residues, velocities and properties from this
+    /// frame, and reset the unit cell and the step.
+    ///
+    /// The memory used by the frame is kept, and will be reused when adding
+    /// new atoms. This is used by `Trajectory::read(Frame&)` to read multiple
+    /// steps in the same frame.
+    ///
+    /// @example{tests/doc/frame/clear.cpp}
+    void clear();
+
     /// Add an `atom` at the given `position` and optionally with the given
     /// `velocity`. The `velocity` value will only be used if this frame
     /// contains velocity data.
@@ -398,18 +408,53 @@ private:
     Frame(const Frame&) = default;
     Frame& operator=(const Frame&) = default;
 
+    /// Clear this frame like `clear`, and then use `topology` as the topology
+    /// of this frame, with default positions. This is used to read steps
+    /// containing only positions with the same topology.
+    void reset(const Topology& topology);
+
+    /// Forget about the references to the atoms used while reading this
+    /// frame, so that copies of the topology can share the atoms
+    void forget_atom_references() {
+        topology_.forget_atom_references();
+    }
+
     /// Current simulation step
     size_t step_ = 0;
     /// Positions of the particles
     std::vector<Vector3D> positions_;
-    /// Velocities of the particles
-    optional<std::vector<Vector3D>> velocities_;
+    /// Velocities of the particles, only used if `has_velocities_` is true
+    std::vector<Vector3D> velocities_;
+    /// Does this frame contains velocities? This is separated from
+    /// `velocities_` to keep the allocated memory in `clear`.
+    bool has_velocities_ = false;
     /// Topology of the described system
     Topology topology_;
     /// Unit cell of the system
     UnitCell cell_;
     /// Properties stored in this frame
     property_map properties_;
+
+    friend class Trajectory;
+};
+
+/// Metadata about a single step of a trajectory, which can be read without
+/// reading the positions of the atoms with `Trajectory::read_metadata`.
+struct CHFL_EXPORT FrameMetadata {
+    FrameMetadata() = default;
+    /// Get the metadata of an already read `frame`
+    explicit FrameMetadata(const Frame& frame);
+
+    /// Index of this step in the trajectory
+    size_t step = 0;
+    /// Number of atoms in this step
+    size_t natoms = 0;
+    /// Simulation time of this step in picoseconds, if the format provides it
+    optional<double> time;
+    /// Unit cell of the system at this step
+    UnitCell cell;
+    /// Properties of the frame at this step
+    property_map properties;
 };
 
 } // namespace chemfiles
@@ -264,6 +264,11 @@ public:
         return data_.size();
     }
 
+    /// Remove all properties from this map, keeping the allocated memory
+    void clear() {
+        data_.clear();
+    }
+
     /// Get an iterator to the first property in the property map
     iterator begin() const {
         return data_.begin();
@@ -0,0 +1,121 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+
+#ifndef CHEMFILES_TEXT_FORMAT_HPP
+#define CHEMFILES_TEXT_FORMAT_HPP
+
+#include <memory>
+#include <string>
+#include <cstdint>
+#include <vector>
+
+#include "chemfiles/Format.hpp"
+#include "chemfiles/File.hpp"
+#include "chemfiles/parallel_scan.hpp"
+#include "chemfiles/external/optional.hpp"
+
+namespace chemfiles {
+
+/// Base class for text formats, where multiple steps follow each other in a
+/// single `TextFile`.
+///
+/// This class keeps track of the position of each step in the file, and
+/// implements `Format::read_step` and `Format::nsteps` on top of it. The
+/// formats only need to implement `read_next` and `write_next` to read and
+/// write a single step, and `forward` to skip over a step.
+///
+/// When reading, the steps are indexed lazily: the file is only scanned as far
+/// as needed to find the requested step, and the full file is only scanned if
+/// the total number of steps is requested. The scan goes through the same
+/// file, and the reading position is restored afterward. When reading
+/// sequentially, this goes back to the start of the step which was just
+/// scanned, which compressed files keep in memory.
+class TextFormat: public Format {
+public:
+    /// Open the file at `path` with the given `mode` and `compression`. The
+    /// `name` of the format is used to check that step index files match this
+    /// format.
+    TextFormat(std::string path, File::Mode mode, File::Compression compression, std::string name);
+    ~TextFormat() noexcept override;
+
+    TextFormat(const TextFormat&) = delete;
+    TextFormat& operator=(const TextFormat&) = delete;
+    TextFormat(TextFormat&&) = default;
+    TextFormat& operator=(TextFormat&&) = default;
+
+    void read_step(size_t step, Frame& frame) final;
+    void read(Frame& frame) final;
+    void read_metadata(size_t step, FrameMetadata& metadata) final;
+    void write(const Frame& frame) final;
+    size_t nsteps() final;
+    bool has_step(size_t step) final;
+    void reuse_steps(Format& other) final;
+
+protected:
+    /// Read the step starting at the current position of `file_` in `frame`
+    virtual void read_next(Frame& frame) = 0;
+    /// Read the metadata of the step starting at the current position of
+    /// `file_`. This does not need to read the whole step. The default
+    /// implementation uses `read_next`.
+    virtual void read_next_metadata(FrameMetadata& metadata);
+    /// Write `frame` as a new step at the current position of `file_`
+    virtual void write_next(const Frame& frame);
+    /// Fast-forward `file` over one step, returning the position where this
+    /// step starts, or `nullopt` if the file does not contain one more step.
+    virtual optional<std::streampos> forward(TextFile& file) = 0;
+    /// Find all the steps in `data`, containing the whole file, starting at
+    /// offset `start`. This is used when all the remaining steps are needed
+    /// and the file is memory-mapped, and can be implemented to find steps
+    /// faster than calling `forward` repeatedly. The default implementation
+    /// does not find any step, leaving all of them to `forward`.
+    virtual scanned_steps scan_steps(string_view data, size_t start);
+
+    /// Text file where we read from and write to
+    std::unique_ptr<TextFile> file_;
+
+private:
+    /// Scan the file until `step` is found, returning `false` if the file
+    /// does not contain this step
+    bool index_until(size_t step);
+    /// Scan `file_` from `scan_position_` until `step` is found or all steps
+    /// are found
+    void scan_until(size_t step);
+    /// Try to find all the remaining steps at once with `scan_steps`
+    void scan_remaining();
+    /// Scan the file for one more step, setting `scan_done_` if there are no
+    /// more steps in the file. When reading, this returns `false` if the
+    /// last step in the file is incomplete, leaving `scan_position_` at the
+    /// start of this step.
+    bool scan_next();
+    /// Start scanning again from the start of the last known step, after new
+    /// data was added to the file
+    void resume_scan();
+    /// Get the positions of the steps for modification, copying them first
+    /// if they are shared with another format
+    std::vector<std::streampos>& unique_positions();
+
+    /// Name of the format
+    std::string name_;
+    /// Mode used to open the file
+    File::Mode mode_;
+    /// Positions of the steps in the file found so far, so that we can just
+    /// `seekg` them instead of reading the whole step. This is shared with
+    /// other formats reading the same file created with `reuse_steps`, and
+    /// copied before being modified.
+    std::shared_ptr<std::vector<std::streampos>> steps_positions_;
+    /// Are the positions in `steps_positions_` shared with another format?
+    bool positions_shared_ = false;
+    /// Position in `file_` where scanning for steps should continue
+    std::streampos scan_position_ = 0;
+    /// Size of the file when we started scanning it, used to find out if
+    /// more steps were written to the file after the scan finished
+    uint64_t scanned_size_ = 0;
+    /// Did we try to load the positions from a step index file?
+    bool index_loaded_ = false;
+    /// Did we find all the steps in the file?
+    bool scan_done_ = false;
+};
+
+} // namespace chemfiles
+
+#endif
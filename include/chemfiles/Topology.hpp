@@ -4,6 +4,8 @@
 #ifndef CHEMFILES_TOPOLOGY_HPP
 #define CHEMFILES_TOPOLOGY_HPP
 
+#include <atomic>
+#include <memory>
 #include <vector>
 #include <unordered_map>
 
@@ -26,6 +28,11 @@ namespace chemfiles {
 /// It is also possible to iterate over a `Topology`, yielding all the atoms in
 /// the system.
 ///
+/// Copies of a topology share the same atoms, bonds and residues until one of
+/// them is modified, making copies cheap even for very large systems. The data
+/// is copied only when a shared topology is modified, including when getting a
+/// non-const reference to one of its atoms.
+///
 /// @example{tests/doc/topology/iterate.cpp}
 class CHFL_EXPORT Topology final {
 public:
@@ -35,13 +42,13 @@ public:
     /// Construct a new empty topology
     ///
     /// @example{tests/doc/topology/topology.cpp}
-    Topology() = default;
+    Topology();
 
     ~Topology() = default;
-    Topology(const Topology&) = default;
-    Topology& operator=(const Topology&) = default;
-    Topology(Topology&&) = default;
-    Topology& operator=(Topology&&) = default;
+    Topology(const Topology& other);
+    Topology& operator=(const Topology& other);
+    Topology(Topology&& other) noexcept;
+    Topology& operator=(Topology&& other) noexcept;
 
     /// Get a reference to the atom at the position `index`.
     ///
@@ -57,7 +64,7 @@ public:
                 + std::to_string(index)
             );
         }
-        return atoms_[index];
+        return mutable_atoms()[index];
     }
 
     /// Get a const reference to the atom at the position `index`.
@@ -74,15 +81,15 @@ public:
                 + std::to_string(index)
             );
         }
-        return atoms_[index];
+        return data_->atoms[index];
     }
 
-    iterator begin() {return atoms_.begin();}
-    const_iterator begin() const {return atoms_.begin();}
-    const_iterator cbegin() const {return atoms_.cbegin();}
-    iterator end() {return atoms_.end();}
-    const_iterator end() const {return atoms_.end();}
-    const_iterator cend() const {return atoms_.cend();}
+    iterator begin() {return mutable_atoms().begin();}
+    const_iterator begin() const {return data_->atoms.begin();}
+    const_iterator cbegin() const {return data_->atoms.cbegin();}
+    iterator end() {return mutable_atoms().end();}
+    const_iterator end() const {return data_->atoms.end();}
+    const_iterator cend() const {return data_->atoms.cend();}
 
     /// Add an `atom` at the end of this topology.
     ///
@@ -143,7 +150,7 @@ public:
     ///
     /// @example{tests/doc/topology/size.cpp}
     size_t size() const {
-        return atoms_.size();
+        return data_->atoms.size();
     }
 
     /// Resize the topology to hold `size` atoms, adding new atoms as needed.
@@ -169,6 +176,14 @@ public:
     /// @param size the number of elements to reserve memory for
     void reserve(size_t size);
 
+    /// Remove all atoms, bonds and residues from this topology.
+    ///
+    /// The memory used by the topology is kept, and will be reused when adding
+    /// new atoms.
+    ///
+    /// @example{tests/doc/topology/clear.cpp}
+    void clear();
+
     /// Get the bonds in the system
     ///
     /// The bonds are sorted according to `operator<(const Bond&, const Bond&)`,
@@ -220,7 +235,7 @@ public:
     ///
     /// @example{tests/doc/topology/clear_bonds.cpp}
     void clear_bonds() {
-        connect_ = Connectivity();
+        mutable_data().connect = Connectivity();
     }
 
     /// Add a `residue` to this topology.
@@ -261,32 +276,66 @@ public:
     ///
     /// @example{tests/doc/topology/residue.cpp}
     const Residue& residue(size_t index) const {
-        if (index >= residues_.size()) {
+        if (index >= data_->residues.size()) {
             throw OutOfBounds(
                 "Residue index out of bounds in topology: we have "
-                + std::to_string(residues_.size()) + " residues, "
+                + std::to_string(data_->residues.size()) + " residues, "
                 + "but the index is " + std::to_string(index)
             );
         }
-        return residues_[index];
+        return data_->residues[index];
     }
 
     /// Get all the residues in the topology as a vector
     ///
     /// @example{tests/doc/topology/residues.cpp}
     const std::vector<Residue>& residues() const {
-        return residues_;
+        return data_->residues;
     }
 
 private:
-    /// Atoms in the system.
-    std::vector<Atom> atoms_;
-    /// Connectivity of the system.
-    Connectivity connect_;
-    /// List of residues in the system.
-    std::vector<Residue> residues_;
-    /// Association between atom indexes and residues indexes.
-    std::unordered_map<size_t, size_t> residue_mapping_;
+    /// Data of a topology, shared between copies of the topology
+    struct data {
+        /// Atoms in the system.
+        std::vector<Atom> atoms;
+        /// Connectivity of the system.
+        Connectivity connect;
+        /// List of residues in the system.
+        std::vector<Residue> residues;
+        /// Association between atom indexes and residues indexes.
+        std::unordered_map<size_t, size_t> residue_mapping;
+    };
+
+    /// Get the data of this topology for modification, copying it first if
+    /// it was shared with other topologies
+    data& mutable_data();
+    /// Get the atoms of this topology for modification through references
+    /// given to the user. Since these references can be used to modify the
+    /// atoms at any time, the atoms will be copied instead of shared when
+    /// copying this topology.
+    std::vector<Atom>& mutable_atoms();
+    /// Forget about the references to the atoms given by `mutable_atoms`,
+    /// allowing copies to share the atoms again. This must only be called
+    /// when these references are no longer used.
+    void forget_atom_references() {
+        references_given_ = false;
+    }
+    /// Get the data to use in a copy of this topology
+    std::shared_ptr<data> share() const;
+    /// Get the data shared by all empty topologies
+    static const std::shared_ptr<data>& empty_data();
+
+    /// Data of this topology, never null
+    std::shared_ptr<data> data_;
+    /// Was `data_` given to another topology? Shared data is never modified,
+    /// even if the other topologies no longer use it. This is set when
+    /// copying a const topology, possibly from multiple threads.
+    mutable std::atomic<bool> shared_;
+    /// Were references to the atoms given to the user since the last time
+    /// the data was replaced?
+    bool references_given_ = false;
+
+    friend class Frame;
 };
 
 } // namespace chemfiles
@@ -4,8 +4,11 @@
 #ifndef CHEMFILES_TRAJECTORY_HPP
 #define CHEMFILES_TRAJECTORY_HPP
 
+#include <cstdint>
 #include <memory>
 #include <string>
+#include <vector>
+#include <functional>
 
 #include "chemfiles/Frame.hpp"
 #include "chemfiles/exports.hpp"
@@ -14,6 +17,9 @@
 namespace chemfiles {
 
 class Format;
+class Selection;
+class PrefetchedFrames;
+class FrameRange;
 
 /// A `Trajectory` is a chemistry file on the hard drive. It is the entry point
 /// of the chemfiles library.
@@ -25,7 +31,7 @@ public:
     /// `"<format>/<compression>"` or `"/<compression>"`. `<format>` should be
     /// the format name (see the corresponding [documentation section][formats]
     /// for the names) or an empty string. `<compression>` should be `GZ` for
-    /// gzip files, or `XZ` for lzma/.xz files. If `<compression>` is present,
+    /// gzip files, `XZ` for lzma/.xz files, or `ZST` for zstd files. If `<compression>` is present,
     /// it will determine which compression method is used to read/write the
     /// file. For example, `format = "XYZ"` will force usage of XYZ format
     /// regardless of the file extension; `format = "XYZ / GZ"` will
@@ -34,7 +40,7 @@ public:
     ///
     /// If the `<format>` is an empty string, the file extension will be used
     /// to guess the format. If `<compression>` is NOT presentand the file path
-    /// ends with either `.gz` or `.xz` the file will be treated as a
+    /// ends with either `.gz`, `.xz` or `.zst` the file will be treated as a
     /// compressed file and the next extension is used to guess the format. For
     /// example `Trajectory("file.xyz.gz")` will open the file for reading
     /// using the XYZ format and the gzip compression method.
@@ -59,6 +65,40 @@ public:
     /// [formats]: http://chemfiles.org/chemfiles/latest/formats.html#list-of-supported-formats
     explicit Trajectory(std::string path, char mode = 'r', const std::string& format = "");
 
+    /// Open multiple files for reading, as a single trajectory containing all
+    /// the steps of the first file, then all the steps of the second file,
+    /// *etc.*
+    ///
+    /// Each entry in `paths` can contain `*` and `?` wildcards in the file
+    /// name (but not in the directories), which are expanded to all the
+    /// matching files sorted in natural order: numbers in the names are
+    /// compared by value, so `part-2.xyz` comes before `part-10.xyz`. All the
+    /// files are read using the given `format`, following the same rules as
+    /// the `Trajectory` constructor.
+    ///
+    /// The files are opened lazily when reading steps from them, and only one
+    /// file is opened at the same time. The number of steps in the files is
+    /// only computed when needed to find a step, using multiple threads for
+    /// text formats when the total number of steps is requested.
+    ///
+    /// Simulation restarts often write the same frame at the end of a file
+    /// and at the beginning of the next file. If `skip_duplicates` is `true`,
+    /// the first step of each file except the first one is skipped.
+    ///
+    /// The `path()` of the resulting trajectory is the path of the first file.
+    ///
+    /// @example{tests/doc/trajectory/concatenate.cpp}
+    ///
+    /// @param paths paths of the files to read, possibly containing wildcards
+    /// @param format Specific format to use for all the files
+    /// @param skip_duplicates should the first step of all the files but the
+    ///                        first one be skipped?
+    ///
+    /// @throws FileError if no file matches one of the paths, or if one of
+    ///                   the files can not be opened.
+    /// @throws FormatError if the files are not valid for the used format.
+    static Trajectory concatenate(const std::vector<std::string>& paths, const std::string& format = "", bool skip_duplicates = false);
+
     ~Trajectory();
 
     Trajectory(Trajectory&& other);
@@ -83,6 +123,28 @@ public:
     ///                     the format does not support reading.
     Frame read();
 
+    /// Read the next frame in the trajectory into an existing `frame`.
+    ///
+    /// All the data previously in `frame` is replaced, but the memory it uses
+    /// is kept and reused. When reading a lot of steps, this function is
+    /// faster than `Trajectory::read()`, which creates a new frame every time.
+    ///
+    /// The trajectory must have been opened in read or append mode, and the
+    /// underlying format must support reading.
+    ///
+    /// This function throws a `FileError` if there are no more frames to read
+    /// in the trajectory.
+    ///
+    /// @example{tests/doc/trajectory/read_into.cpp}
+    ///
+    /// @param frame frame to read the data into
+    ///
+    /// @throws FileError for all errors concerning the physical file: can not
+    ///                   open it, can not read/write it, *etc.*
+    /// @throws FormatError if the file is not valid for the used format, or if
+    ///                     the format does not support reading.
+    void read(Frame& frame);
+
     /// Read a single frame at specified `step` from the trajectory.
     ///
     /// The trajectory must have been opened in read or append mode, and the
@@ -101,6 +163,167 @@ public:
     ///                     the format does not support reading.
     Frame read_step(size_t step);
 
+    /// Read a single frame at specified `step` from the trajectory into an
+    /// existing `frame`.
+    ///
+    /// All the data previously in `frame` is replaced, but the memory it uses
+    /// is kept and reused.
+    ///
+    /// The trajectory must have been opened in read or append mode, and the
+    /// underlying format must support reading.
+    ///
+    /// This function throws a `FileError` if the step is bigger than the
+    /// number of steps in the trajectory.
+    ///
+    /// @example{tests/doc/trajectory/read_into.cpp}
+    ///
+    /// @param step step to read from the trajectory
+    /// @param frame frame to read the data into
+    ///
+    /// @throws FileError for all errors concerning the physical file: can not
+    ///                   open it, can not read/write it, *etc.*
+    /// @throws FormatError if the file is not valid for the used format, or if
+    ///                     the format does not support reading.
+    void read_step(size_t step, Frame& frame);
+
+    /// Read the frames at all the given `steps`, returning them in the same
+    /// order as `steps`.
+    ///
+    /// For text formats, multiple threads (as set with `set_io_threads`) read
+    /// the frames in parallel, each thread using a separate file handle. Other
+    /// formats read all the frames in the calling thread, using
+    /// `Trajectory::read_step`.
+    ///
+    /// The step that will be read by the next call to `Trajectory::read` is
+    /// unspecified after calling this function.
+    ///
+    /// @example{tests/doc/trajectory/read_steps.cpp}
+    ///
+    /// @param steps steps to read from the trajectory
+    ///
+    /// @throws FileError for all errors concerning the physical file: can not
+    ///                   open it, can not read/write it, *etc.*
+    /// @throws FormatError if the file is not valid for the used format, or if
+    ///                     the format does not support reading.
+    std::vector<Frame> read_steps(const std::vector<size_t>& steps);
+
+    /// Read the frames from step `start` to step `stop` (excluded), every
+    /// `stride` steps, possibly in parallel. This function is equivalent to
+    /// calling `Trajectory::read_steps` with the list of steps
+    /// `start, start + stride, start + 2 * stride, ...` smaller than `stop`.
+    ///
+    /// @example{tests/doc/trajectory/read_steps.cpp}
+    ///
+    /// @param start first step to read
+    /// @param stop first step after the last step to read
+    /// @param stride number of steps between two consecutive frames
+    ///
+    /// @throws Error if `stride` is 0
+    /// @throws FileError for all errors concerning the physical file: can not
+    ///                   open it, can not read/write it, *etc.*
+    /// @throws FormatError if the file is not valid for the used format, or if
+    ///                     the format does not support reading.
+    std::vector<Frame> read_steps(size_t start, size_t stop, size_t stride = 1);
+
+    /// Iterate over the frames from step `start` to step `stop` (excluded),
+    /// every `stride` steps.
+    ///
+    /// The returned `FrameRange` can be used in a range-based for loop, and
+    /// reads the frames one at a time in the calling thread, re-using the
+    /// same frame. The iteration stops at the end of the trajectory if `stop`
+    /// is bigger than the number of steps. The steps between the frames are
+    /// skipped by seeking directly to the next frame when the format allows
+    /// it, and without converting them to frames otherwise.
+    ///
+    /// This trajectory must not be destroyed while the returned `FrameRange`
+    /// is used.
+    ///
+    /// @example{tests/doc/trajectory/read_range.cpp}
+    ///
+    /// @param start first step to read
+    /// @param stop first step after the last step to read
+    /// @param stride number of steps between two consecutive frames
+    ///
+    /// @throws Error if `stride` is 0
+    /// @throws FileError if the trajectory was closed
+    FrameRange read_range(size_t start, size_t stop = SIZE_MAX, size_t stride = 1);
+
+    /// Read all the remaining frames in this trajectory, starting at the
+    /// current step, using a background thread.
+    ///
+    /// The returned `PrefetchedFrames` can be used in a range-based for loop.
+    /// The background thread reads up to `prefetch` frames in advance, while
+    /// the calling thread is using the current frame. Any exception thrown
+    /// when reading a frame is re-thrown in the calling thread when getting
+    /// this frame.
+    ///
+    /// This trajectory must not be used or destroyed while the returned
+    /// `PrefetchedFrames` exists. After it has been destroyed, the trajectory
+    /// is positioned after the last frame read by the background thread,
+    /// which can be after the last frame used by the calling thread.
+    ///
+    /// @example{tests/doc/trajectory/frames.cpp}
+    ///
+    /// @param prefetch maximal number of frames to read in advance. At least
+    ///                 one frame is always read in advance.
+    ///
+    /// @throws FileError if the trajectory was closed
+    PrefetchedFrames frames(size_t prefetch = 2);
+
+    /// Read the metadata of the given `step`: number of atoms, simulation
+    /// time, unit cell and frame properties, without reading the positions of
+    /// the atoms when the format allows it.
+    ///
+    /// The metadata is read with a separate file handle, and does not change
+    /// the current step of this trajectory. The unit cell set with
+    /// `Trajectory::set_cell` is used if any, but the number of atoms does
+    /// not take `Trajectory::set_atom_subset` into account.
+    ///
+    /// XYZ, PDB and GRO files only parse the lines containing metadata, and
+    /// Amber NetCDF and TNG files only read the corresponding variables.
+    /// Other formats read the whole step.
+    ///
+    /// @example{tests/doc/trajectory/read_metadata.cpp}
+    ///
+    /// @param step The step to read
+    ///
+    /// @throws FileError if the trajectory was closed or was not opened in
+    ///                   read mode, or if the step does not exist
+    /// @throws FormatError if the file is not valid for the used format
+    FrameMetadata read_metadata(size_t step);
+
+    /// Read the metadata of all the steps in this trajectory, as with
+    /// `Trajectory::read_metadata`. For text formats, multiple threads (as set
+    /// with `set_io_threads`) read the steps in parallel.
+    ///
+    /// @example{tests/doc/trajectory/read_metadata.cpp}
+    ///
+    /// @throws FileError if the trajectory was closed or was not opened in
+    ///                   read mode
+    /// @throws FormatError if the file is not valid for the used format
+    std::vector<FrameMetadata> scan_metadata();
+
+    /// Create a new trajectory reading the same file, with its own file handle
+    /// and current step.
+    ///
+    /// The new trajectory re-uses the information about the steps already
+    /// found in the file by this trajectory (such as the position of each step
+    /// in text formats, or the number of steps) instead of searching for them
+    /// again. It also uses the same topology and unit cell as this
+    /// trajectory, if they were set with `Trajectory::set_topology` or
+    /// `Trajectory::set_cell`. The current step of the new trajectory is the
+    /// first step.
+    ///
+    /// Different clones of a trajectory can be used from different threads at
+    /// the same time with text formats. Formats based on external libraries
+    /// (NetCDF, TNG, Molfile plugins, ...) might not support this.
+    ///
+    /// @example{tests/doc/trajectory/clone.cpp}
+    ///
+    /// @throws FileError if the trajectory was closed or was not opened in
+    ///                   read mode, or if the file can not be opened again.
+    Trajectory clone() const;
+
     /// Write a single frame to the trajectory.
     ///
     /// The trajectory must have been opened in Write or append mode, and the
@@ -169,6 +392,64 @@ public:
     /// @example{tests/doc/trajectory/set_cell.cpp}
     void set_cell(const UnitCell& cell);
 
+    /// Only read the atoms with the given `indices` in the next frames.
+    ///
+    /// The frames read afterward only contain these atoms, in the same order
+    /// as in the file, together with the bonds between them and the residues
+    /// containing them. The `indices` are sorted and duplicated indices are
+    /// removed. Using an empty vector reads all the atoms again.
+    ///
+    /// Formats able to read only part of a step (such as Amber NetCDF) only
+    /// read the data for these atoms from the file. For other formats, the
+    /// full step is read and the other atoms are removed from the frame. If
+    /// a topology was set with `Trajectory::set_topology`, it should still
+    /// contain all the atoms in the file.
+    ///
+    /// @example{tests/doc/trajectory/set_atom_subset.cpp}
+    ///
+    /// @param indices indices of the atoms to read
+    ///
+    /// @throws FileError if the trajectory was opened in write mode
+    /// @throws OutOfBounds if one of the indices is bigger than the number of
+    ///                     atoms in a frame or in the custom topology
+    void set_atom_subset(std::vector<size_t> indices);
+
+    /// Only read the atoms matching the given `selection` in the next frames.
+    ///
+    /// The selection is evaluated once, using the first step of the
+    /// trajectory, and the matching atoms are then used for all steps as with
+    /// `Trajectory::set_atom_subset(std::vector<size_t>)`.
+    ///
+    /// @example{tests/doc/trajectory/set_atom_subset.cpp}
+    ///
+    /// @param selection selection of size 1 used to find the atoms to read
+    ///
+    /// @throws FileError if the trajectory was opened in write mode, or if
+    ///                   it does not contain any step
+    /// @throws SelectionError if the selection size is not 1
+    void set_atom_subset(const Selection& selection);
+
+    /// Only read the positions, velocities and unit cell of the next frames,
+    /// re-using the same topology for all frames.
+    ///
+    /// This is useful for trajectories where the topology does not change,
+    /// since most formats would otherwise parse the full topology (atom
+    /// names, residues, bonds, *etc.*) for every step. The topology used is
+    /// the one set with `Trajectory::set_topology` if any, or the topology of
+    /// the first frame read after calling this function. Formats able to do
+    /// so (currently XYZ, PDB and GRO) then skip all the topological data in
+    /// the file when reading the next frames.
+    ///
+    /// Setting `positions_only` to `false` reads the full frames again.
+    ///
+    /// @example{tests/doc/trajectory/set_positions_only.cpp}
+    ///
+    /// @param positions_only should the next frames re-use the same topology?
+    ///
+    /// @throws Error if a frame does not have the same number of atoms as the
+    ///               topology
+    void set_positions_only(bool positions_only = true);
+
     /// Get the number of steps (the number of frames) in this trajectory.
     ///
     /// @example{tests/doc/trajectory/nsteps.cpp}
@@ -195,21 +476,43 @@ public:
     }
 
 private:
+    /// Create a trajectory reading the file at `path` with the given `format`
+    Trajectory(std::string path, std::unique_ptr<Format> format, std::function<std::unique_ptr<Format>()> reopen);
+    /// Check if the file contains the given `step`
+    bool has_step(size_t step) const;
     /// Perform a few checks before reading a frame
     void pre_read(size_t step);
     /// Set the frame topology and/or cell after reading it
     void post_read(Frame& frame);
+    /// Clear `frame` before reading a new step in it. When the format only
+    /// reads positions, the frame gets the topology it will have after
+    /// `post_read` right away.
+    void clear_frame(Frame& frame) const;
     /// Check that the trajectory is still open, and throw a `FileError` is it
     /// has been closed.
     void check_opened() const;
+    /// Tell the format whether it should only read positions, depending on
+    /// `positions_only_` and on the availability of a topology
+    void update_positions_only();
+    /// Create a new format reading the same file, re-using the steps already
+    /// found by `format_`
+    std::unique_ptr<Format> reopen_format() const;
+    /// Check that the trajectory was opened in read mode, using `action` in
+    /// the error message
+    void check_read_mode(const char* action) const;
+
+    friend class FrameRange;
 
     /// Path of the associated file
     std::string path_;
     /// Opening mode of the associated file
     char mode_;
+    /// Function creating a new format reading the same file(s), used to clone
+    /// this trajectory
+    std::function<std::unique_ptr<Format>()> reopen_;
     /// Current step
     size_t step_;
-    /// Number of steps in the file, if available
+    /// Number of steps in the file, when writing or appending to it
     size_t nsteps_;
     /// Format used to read the associated file. It will be `nullptr` is the
     /// trajectory is closed
@@ -220,6 +523,160 @@ private:
     /// UnitCell to use for reading/writing files when no unit cell information
     /// is present
     optional<UnitCell> custom_cell_;
+    /// Indices of the atoms to read, or empty to read all atoms
+    std::vector<size_t> atom_subset_;
+    /// Does the format only read the atoms in `atom_subset_`?
+    bool format_subset_ = false;
+    /// Part of the custom topology containing the atoms in `atom_subset_`
+    optional<Topology> subset_topology_;
+    /// Should we only read positions, velocities and unit cell?
+    bool positions_only_ = false;
+    /// Topology of the first frame read with `positions_only_`
+    optional<Topology> fixed_topology_;
+    /// Does the format only read positions, velocities and unit cell?
+    bool format_positions_only_ = false;
+    /// Format used to read metadata, created on first use
+    std::unique_ptr<Format> metadata_format_;
+};
+
+/// Frames in a range of steps from a `Trajectory`, as created by
+/// `Trajectory::read_range`.
+class CHFL_EXPORT FrameRange final {
+public:
+    /// Input iterator over the frames, for use in range-based for loops
+    class CHFL_EXPORT iterator final {
+    public:
+        iterator(): range_(nullptr) {}
+
+        Frame& operator*() const {
+            return range_->current_;
+        }
+
+        Frame* operator->() const {
+            return &range_->current_;
+        }
+
+        /// Read the frame at the next step in the range
+        iterator& operator++();
+
+        bool operator==(const iterator& other) const {
+            return range_ == other.range_;
+        }
+
+        bool operator!=(const iterator& other) const {
+            return range_ != other.range_;
+        }
+
+    private:
+        explicit iterator(FrameRange* range): range_(range) {}
+        /// Range for this iterator, `nullptr` for the end iterator
+        FrameRange* range_;
+
+        friend class FrameRange;
+    };
+
+    /// Get an iterator pointing to the frame at the first step of the range
+    iterator begin();
+
+    /// Get the end iterator
+    iterator end() {
+        return iterator();
+    }
+
+private:
+    FrameRange(Trajectory& trajectory, size_t start, size_t stop, size_t stride);
+    /// Read the frame at `next_`, returning `false` at the end of the range
+    bool read_next();
+
+    /// Trajectory to read from
+    Trajectory* trajectory_;
+    /// Next step to read
+    size_t next_;
+    /// Last step in the range, excluded
+    size_t stop_;
+    /// Number of steps between two frames
+    size_t stride_;
+    /// Current frame for iterators
+    Frame current_;
+
+    friend class Trajectory;
+};
+
+/// Frames read in advance from a `Trajectory` by a background thread, as
+/// created by `Trajectory::frames`.
+///
+/// Destroying this object stops the background thread.
+class CHFL_EXPORT PrefetchedFrames final {
+public:
+    /// Input iterator over the frames, for use in range-based for loops
+    class CHFL_EXPORT iterator final {
+    public:
+        iterator(): frames_(nullptr) {}
+
+        Frame& operator*() const {
+            return frames_->current_;
+        }
+
+        Frame* operator->() const {
+            return &frames_->current_;
+        }
+
+        /// Go to the next frame, re-throwing any exception from the background
+        /// thread
+        iterator& operator++();
+
+        bool operator==(const iterator& other) const {
+            return frames_ == other.frames_;
+        }
+
+        bool operator!=(const iterator& other) const {
+            return frames_ != other.frames_;
+        }
+
+    private:
+        explicit iterator(PrefetchedFrames* frames): frames_(frames) {}
+        /// Frames for this iterator, `nullptr` for the end iterator
+        PrefetchedFrames* frames_;
+
+        friend class PrefetchedFrames;
+    };
+
+    ~PrefetchedFrames();
+    PrefetchedFrames(PrefetchedFrames&&);
+    PrefetchedFrames& operator=(PrefetchedFrames&&);
+
+    PrefetchedFrames(const PrefetchedFrames&) = delete;
+    PrefetchedFrames& operator=(const PrefetchedFrames&) = delete;
+
+    /// Get the next frame in `frame`, waiting for the background thread to
+    /// read it if needed. The memory previously used by `frame` is re-used to
+    /// read the next frames.
+    ///
+    /// @returns `false` if there are no more frames, `true` otherwise
+    /// @throws FileError, FormatError or any other exception thrown when
+    ///         reading this frame in the background thread
+    bool next(Frame& frame);
+
+    /// Get an iterator pointing to the next frame
+    iterator begin();
+
+    /// Get the end iterator
+    iterator end() {
+        return iterator();
+    }
+
+private:
+    PrefetchedFrames(Trajectory& trajectory, size_t prefetch);
+    /// Stop and join the background thread
+    void stop();
+
+    struct state;
+    /// State shared with the background thread
+    std::unique_ptr<state> state_;
+    /// Current frame for iterators
+    Frame current_;
+
+    friend class Trajectory;
 };
 
 } // namespace chemfiles
@@ -0,0 +1,29 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+
+#ifndef CHEMFILES_ATOM_SUBSET_HPP
+#define CHEMFILES_ATOM_SUBSET_HPP
+
+#include <vector>
+
+namespace chemfiles {
+class Frame;
+class Topology;
+
+/// Get the part of `topology` containing only the atoms with the given
+/// `indices`, which must be sorted and unique. The atoms are renumbered from
+/// 0, and only the bonds between two atoms in the subset are kept. Residues
+/// are kept if they contain at least one atom of the subset.
+///
+/// @throws OutOfBounds if one of the indices is not in the topology
+Topology topology_subset(const Topology& topology, const std::vector<size_t>& indices);
+
+/// Remove all the atoms from `frame` except for the ones with the given
+/// `indices`, which must be sorted and unique.
+///
+/// @throws OutOfBounds if one of the indices is not in the frame
+void keep_atoms(Frame& frame, const std::vector<size_t>& indices);
+
+}
+
+#endif
@@ -77,6 +77,32 @@ CHFL_EXPORT chfl_status chfl_trajectory_read_step(
     CHFL_TRAJECTORY* trajectory, uint64_t step, CHFL_FRAME* frame
 );
 
+/// Read the next step of the `trajectory` into a `frame`, reusing the memory
+/// already allocated by the `frame`.
+///
+/// All the data previously in the `frame` is replaced. When reading a lot of
+/// steps with the same `frame`, this function is faster than
+/// `chfl_trajectory_read`.
+///
+/// @example{tests/capi/doc/chfl_trajectory/read_into.c}
+/// @return The operation status code. You can use `chfl_last_error` to learn
+///         about the error if the status code is not `CHFL_SUCCESS`.
+CHFL_EXPORT chfl_status chfl_trajectory_read_into(
+    CHFL_TRAJECTORY* trajectory, CHFL_FRAME* frame
+);
+
+/// Read a specific `step` of the `trajectory` into a `frame`, reusing the
+/// memory already allocated by the `frame`.
+///
+/// All the data previously in the `frame` is replaced.
+///
+/// @example{tests/capi/doc/chfl_trajectory/read_into.c}
+/// @return The operation status code. You can use `chfl_last_error` to learn
+///         about the error if the status code is not `CHFL_SUCCESS`.
+CHFL_EXPORT chfl_status chfl_trajectory_read_step_into(
+    CHFL_TRAJECTORY* trajectory, uint64_t step, CHFL_FRAME* frame
+);
+
 /// Write a single `frame` to the `trajectory`.
 ///
 /// @example{tests/capi/doc/chfl_trajectory/write.c}
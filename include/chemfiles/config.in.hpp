@@ -14,8 +14,10 @@
 /// The full version of chemfiles ("x.y.z"), as a string
 #define CHEMFILES_VERSION "@CHEMFILES_VERSION@"
 
+/// Is thread_local supported by the compiler?
+#define CHFL_HAS_THREAD_LOCAL @CHFL_HAS_THREAD_LOCAL@
 /// thread_local implementation
-#if @CHFL_HAS_THREAD_LOCAL@
+#if CHFL_HAS_THREAD_LOCAL
     #define CHFL_THREAD_LOCAL thread_local
 #else
     #define CHFL_THREAD_LOCAL
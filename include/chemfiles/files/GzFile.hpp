@@ -5,18 +5,51 @@
 #define CHEMFILES_GZ_FILES_HPP
 
 #include <streambuf>
+#include <memory>
 #include <vector>
+#include <cstdio>
 
 #include <zlib.h>
 
 #include "chemfiles/File.hpp"
+#include "chemfiles/mutex.hpp"
 
 namespace chemfiles {
 
-/// An implementation of std::streambuf for gziped files
+/// Options used to compress gzip files, set with `set_gz_compression`
+struct gz_compression_options {
+    /// Number of threads to use, 0 means `io_threads()`
+    size_t threads;
+    /// zlib compression level
+    int level;
+    /// Minimal size of uncompressed members, 0 means the default size
+    size_t block_size;
+};
+
+/// Get the current gzip compression options
+gz_compression_options gz_compression();
+
+/// An implementation of std::streambuf for gziped files.
+///
+/// When reading, this class keeps an index of checkpoints in the compressed
+/// data, in the same way as zlib's `examples/zran.c`. Every
+/// `CHECKPOINT_SPAN` bytes of uncompressed data, the decompression state is
+/// saved, and seeking restarts decompression from the nearest checkpoint
+/// instead of the beginning of the file. The checkpoints can be shared
+/// between buffers reading the same file with `share_checkpoints`.
+///
+/// When writing with multiple threads or a fixed block size (see
+/// `set_gz_compression`), the data is accumulated in chunks ending at step
+/// boundaries, and batches of chunks are compressed in parallel as separate
+/// gzip members. Each member start is a checkpoint when reading the file
+/// back.
 class gzstreambuf final: public std::streambuf {
 public:
-    gzstreambuf(size_t buffer_size = 512);
+    /// Minimal distance in uncompressed bytes between two checkpoints
+    static constexpr uint64_t CHECKPOINT_SPAN = 1024 * 1024;
+
+    /// Create a new buffer, using internal buffers of `buffer_size` bytes
+    gzstreambuf(size_t buffer_size = compressed_buffer_size());
     ~gzstreambuf() override;
 
     gzstreambuf(const gzstreambuf&) = delete;
@@ -24,33 +57,143 @@ public:
     gzstreambuf(gzstreambuf&&) = delete;
     gzstreambuf& operator=(gzstreambuf&&) = delete;
 
-    /// Open the file at `path` with the given `mode`. The mode will be passed
-    /// down to gzopen.
+    /// Open the file at `path` with the given `mode`. The mode should start
+    /// with `r` for reading, and will be passed down to gzopen when writing,
+    /// together with the compression level from `set_gz_compression`.
     void open(const std::string& path, const std::string& mode);
+    bool is_open() const;
+
+    /// Signal a step boundary when writing, starting a new gzip member if
+    /// the current one is large enough.
+    void step_boundary();
+
+    /// Use the same checkpoints as `other`, which must be reading the same
+    /// file. The checkpoints found by any of the buffers are then used by
+    /// all of them, including from different threads.
+    void share_checkpoints(const gzstreambuf& other);
 
+protected:
     int underflow() override;
     int overflow(int ch) override;
-
     int sync() override;
-    bool is_open() const;
-
-    std::streampos seekpos(std::streampos offset, std::ios_base::openmode mode) override {
-        return pubseekoff(offset, std::ios_base::beg, mode);
-    }
-
-    std::streampos seekoff(std::streamoff offset, std::ios_base::seekdir way, std::ios_base::openmode mode) override;
+    pos_type seekoff(off_type offset, std::ios_base::seekdir way, std::ios_base::openmode which) override;
+    pos_type seekpos(pos_type position, std::ios_base::openmode which) override;
 
 private:
-    std::vector<char> buffer_;
-    gzFile file_ = nullptr;
+    /// A point in the compressed data where decompression can be restarted
+    struct checkpoint {
+        /// Offset of this checkpoint in the uncompressed data
+        uint64_t uncompressed;
+        /// Offset of the first full byte after this checkpoint in the
+        /// compressed file
+        uint64_t compressed;
+        /// Number of bits from the previous byte to use when restarting
+        int bits;
+        /// Last 32 KiB of uncompressed data before this checkpoint. This is
+        /// empty for checkpoints at the start of a gzip member.
+        std::vector<unsigned char> window;
+    };
+
+    /// Decompress the next chunk of data in `window_`, returning the number
+    /// of produced bytes. This can return 0 if no data was produced yet,
+    /// and sets `finished_` when all the data has been read.
+    size_t inflate_chunk();
+    /// Read more compressed data from the file
+    void replenish_compressed_buffer();
+    /// Start decompressing a new gzip member, possibly after skipping the
+    /// trailer of the previous one
+    void start_member();
+    /// Add a checkpoint at the current position, if needed
+    void add_checkpoint(bool member_start);
+    /// Restart decompression from the given `checkpoint`
+    void restore(const checkpoint& checkpoint);
+
+    /// Version of `sync` used when compressing members in parallel
+    int sync_members();
+    /// End the current member, and compress it with the other finished
+    /// members if there are enough of them
+    void end_member();
+    /// Compress and write all the members in `finished_members_`
+    void compress_members();
+
+    /// Is this buffer used for reading or writing?
+    bool reading_ = true;
+    /// Compressed file, used for writing
+    gzFile gz_file_ = nullptr;
+    /// Compressed file, used for reading and for writing members in parallel
+    std::FILE* file_ = nullptr;
+
+    /// Buffer used to accumulate the data before writing it
+    std::vector<char> out_buffer_;
+    /// Buffer used to read compressed data
+    std::vector<unsigned char> in_buffer_;
+    /// Circular buffer containing the decompressed data. It is always at
+    /// least 32 KiB long, and the last 32 KiB of data before a checkpoint
+    /// are taken from it.
+    std::vector<char> window_;
+    /// Position of the next decompressed byte in `window_`
+    size_t window_used_ = 0;
+
+    /// Kind of data in the file being read
+    enum class input_kind {
+        /// One or more gzip members
+        gzip,
+        /// A single zlib stream
+        zlib,
+        /// Uncompressed data, copied as-is like gzread does
+        plain,
+    };
+
+    /// zlib stream used for reading
+    z_stream stream_;
+    /// Kind of data in the file being read, found from the first bytes of
+    /// the file
+    input_kind input_ = input_kind::gzip;
+    /// Are we currently decompressing a gzip member?
+    bool in_member_ = false;
+    /// Are we decompressing raw deflate data (after restoring a checkpoint)
+    /// instead of a full gzip member?
+    bool raw_ = false;
+    /// Did we reach the end of the compressed data?
+    bool finished_ = false;
+    /// Offset in the compressed file of the end of `in_buffer_`
+    uint64_t compressed_position_ = 0;
+    /// Offset in the uncompressed data of the end of the get area
+    uint64_t decoded_position_ = 0;
+    /// Number of decompressed bytes to discard before the requested position
+    /// after a seek
+    uint64_t discard_amount_ = 0;
+
+    /// Known checkpoints, sorted by uncompressed offset. This can be shared
+    /// with other buffers reading the same file.
+    std::shared_ptr<mutex<std::vector<checkpoint>>> checkpoints_;
+
+    /// Are we compressing members in parallel when writing?
+    bool member_writer_ = false;
+    /// Number of threads to use to compress members
+    size_t write_threads_ = 1;
+    /// Minimal size of the members when writing
+    size_t block_size_ = 0;
+    /// zlib compression level used when writing
+    int level_ = 7;
+    /// Number of uncompressed bytes in the members already written
+    uint64_t written_ = 0;
+    /// Uncompressed data for the member currently being written
+    std::vector<char> member_data_;
+    /// Finished members, waiting to be compressed
+    std::vector<std::vector<char>> finished_members_;
 };
 
 
 /// A gziped text file
 class GzFile final: public TextFile {
 public:
-    /// Open the file at the given `path` using the specified `mode`
-    GzFile(std::string path, File::Mode mode);
+    /// Open the file at the given `path` using the specified `mode`, using
+    /// buffers of `buffer_size` bytes for compressed and decompressed data
+    GzFile(std::string path, File::Mode mode, size_t buffer_size = compressed_buffer_size());
+
+    void step_boundary() override;
+    void share_index(TextFile& other) override;
 
 private:
     gzstreambuf buffer_;
@@ -0,0 +1,102 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+
+#ifndef CHEMFILES_MMAP_FILES_HPP
+#define CHEMFILES_MMAP_FILES_HPP
+
+#include <streambuf>
+
+#include "chemfiles/File.hpp"
+
+namespace chemfiles {
+
+/// An implementation of std::streambuf for read-only memory-mapped files. The
+/// whole file is mapped at once, and used directly as the get area.
+///
+/// The file stays open, and its size is checked again when seeking to a new
+/// position. If the size changed (for example because a simulation is still
+/// writing to the file), the file is mapped again, invalidating any pointer
+/// inside the previous mapping.
+class mmapstreambuf final: public std::streambuf {
+public:
+    mmapstreambuf() = default;
+    ~mmapstreambuf() override;
+
+    mmapstreambuf(const mmapstreambuf&) = delete;
+    mmapstreambuf& operator=(const mmapstreambuf&) = delete;
+    mmapstreambuf(mmapstreambuf&&) = delete;
+    mmapstreambuf& operator=(mmapstreambuf&&) = delete;
+
+    /// Map the file at `path` in memory for reading.
+    void open(const std::string& path);
+    bool is_open() const;
+
+    /// Get a view of the whole mapped file
+    string_view contents() const { return {data_, size_}; }
+    /// Get a pointer to the current read position in the mapping
+    const char* current() const { return gptr(); }
+    /// Get a pointer past the end of the mapping
+    const char* end() const { return egptr(); }
+    /// Advance the read position by `count` characters
+    void advance(size_t count) {
+        setg(eback(), gptr() + count, egptr());
+    }
+
+protected:
+    pos_type seekoff(off_type offset, std::ios_base::seekdir way, std::ios_base::openmode which) override;
+    pos_type seekpos(pos_type position, std::ios_base::openmode which) override;
+
+private:
+    /// Get the current size of the file
+    size_t file_size() const;
+    /// Map the whole file in memory, using its current size
+    void map();
+    /// Release the current memory mapping
+    void unmap();
+    /// Map the file again if its size changed since the last mapping
+    void update_size();
+
+    /// Path to the file, used for error messages
+    std::string path_;
+    /// Start of the mapped memory, or `nullptr` for empty files
+    char* data_ = nullptr;
+    /// Size of the mapped memory
+    size_t size_ = 0;
+    /// Did we successfully open the file?
+    bool opened_ = false;
+#ifdef CHEMFILES_WINDOWS
+    /// Windows file and file mapping handles
+    void* file_ = nullptr;
+    void* mapping_ = nullptr;
+#else
+    /// File descriptor of the mapped file
+    int fd_ = -1;
+#endif
+};
+
+/// A read-only text file accessed through a memory map. Lines are searched for
+/// directly in the mapped memory, letting the OS page cache do the IO.
+class MmapFile final: public TextFile {
+public:
+    /// Open the file at the given `path` using the specified `mode`. Only
+    /// `File::READ` is supported.
+    MmapFile(std::string path, File::Mode mode);
+
+    /// Get a view of the whole file content, independently of the current
+    /// read position
+    string_view contents() const {
+        return buffer_.contents();
+    }
+
+protected:
+    void get_line(std::string& string) override;
+    /// Get a view directly inside the mapped memory, without copying the line
+    string_view get_line_view(std::string& buffer) override;
+
+private:
+    mmapstreambuf buffer_;
+};
+
+} // namespace chemfiles
+
+#endif
@@ -15,10 +15,34 @@
 
 namespace chemfiles {
 
+/// Options used to compress xz files, set with `set_xz_compression`
+struct xz_compression_options {
+    /// Number of threads to use, 0 means `io_threads()`
+    size_t threads;
+    /// lzma compression preset
+    uint32_t preset;
+    /// Minimal size of uncompressed blocks, 0 means the default size
+    size_t block_size;
+};
+
+/// Get the current xz compression options
+xz_compression_options xz_compression();
+
 /// An implementation of std::streambuf for lzma/xz files
+///
+/// When reading files containing multiple blocks, the blocks are decompressed
+/// in parallel, using the index at the end of the file to find them. The
+/// decompressed blocks are then given to the stream in order. Files
+/// containing a single block are decompressed sequentially.
+///
+/// When writing with multiple threads or a fixed block size (see
+/// `set_xz_compression`), the data is accumulated in blocks ending at step
+/// boundaries, and batches of blocks are compressed in parallel. The stream
+/// header, index and footer are then written manually around the blocks.
 class xzstreambuf final: public std::streambuf {
 public:
-    xzstreambuf(size_t buffer_size = 128 * 1024);
+    /// Create a new buffer, using internal buffers of `buffer_size` bytes
+    xzstreambuf(size_t buffer_size = compressed_buffer_size());
     ~xzstreambuf() override;
 
     xzstreambuf(const xzstreambuf&) = delete;
@@ -31,6 +55,10 @@ public:
     void open(const std::string& path, const std::string& mode);
     bool is_open() const;
 
+    /// Signal a step boundary when writing, starting a new block if the
+    /// current one is large enough.
+    void step_boundary();
+
 protected:
     int underflow() override;
     int overflow(int ch) override;
@@ -39,8 +67,43 @@ protected:
     pos_type seekpos(pos_type position, std::ios_base::openmode which) override;
 
 private:
+    /// A single block in the compressed file, used for parallel
+    /// decompression
+    struct block_info {
+        /// Offset of the start of the block in the compressed file
+        uint64_t compressed_offset;
+        /// Size of the block in the compressed file, including header,
+        /// padding and check
+        uint64_t compressed_size;
+        /// Offset of the block in the uncompressed data
+        uint64_t uncompressed_offset;
+        /// Size of the block in the uncompressed data
+        uint64_t uncompressed_size;
+    };
+
     void replenish_compressed_buffer();
     bool init_index();
+    /// Check if the file can be decompressed in parallel, and find all the
+    /// blocks in it if this is the case
+    void init_parallel();
+    /// Version of `underflow` used for parallel decompression
+    int underflow_parallel();
+    /// Decompress the next few blocks in `decompressed_`, in parallel
+    void decompress_blocks();
+    /// Version of `seekpos` used for parallel decompression
+    pos_type seekpos_parallel(pos_type position);
+
+    /// Initialize the writer compressing blocks in parallel
+    void init_block_writer(const xz_compression_options& options);
+    /// Version of `sync` used when compressing blocks in parallel
+    int sync_blocks();
+    /// End the current block, and compress it with the other finished blocks
+    /// if there are enough of them
+    void end_block();
+    /// Compress and write all the blocks in `finished_blocks_`
+    void compress_blocks();
+    /// Write the stream index and footer at the end of the file
+    void finish_blocks();
 
 private:
     FILE* file_ = nullptr;
@@ -66,14 +129,47 @@ private:
     uint64_t decoded_position_ = 0;
     uint64_t discard_amount_ = 0;
     bool at_block_boundary_ = true;
+    /// Did we reach the index at the end of the stream while reading?
+    bool stream_end_ = false;
     bool reading_ = true;
+
+    /// Are we decompressing blocks in parallel?
+    bool parallel_ = false;
+    /// All the blocks in the file, when decompressing in parallel
+    std::vector<block_info> blocks_;
+    /// Index in `blocks_` of the next block to decompress
+    size_t next_block_ = 0;
+    /// Blocks decompressed in parallel, waiting to be given to the stream
+    std::vector<std::vector<char>> decompressed_;
+    /// Index in `decompressed_` of the next block to give to the stream
+    size_t next_decompressed_ = 0;
+    /// Block currently used as the get area
+    std::vector<char> current_block_;
+
+    /// Are we compressing blocks in parallel when writing?
+    bool block_writer_ = false;
+    /// Did we finish writing the file?
+    bool finished_ = false;
+    /// Number of threads to use to compress blocks
+    size_t write_threads_ = 1;
+    /// Minimal size of the blocks when writing
+    size_t block_size_ = 0;
+    /// Options of the lzma2 filter used to compress blocks
+    lzma_options_lzma lzma_options_;
+    /// Uncompressed data for the block currently being written
+    std::vector<char> block_data_;
+    /// Finished blocks, waiting to be compressed
+    std::vector<std::vector<char>> finished_blocks_;
 };
 
 /// A xz-compressed text file
 class XzFile final: public TextFile {
 public:
-    /// Open the file at the given `path` using the specified `mode`
-    XzFile(std::string path, File::Mode mode);
+    /// Open the file at the given `path` using the specified `mode`, using
+    /// buffers of `buffer_size` bytes for compressed and decompressed data
+    XzFile(std::string path, File::Mode mode, size_t buffer_size = compressed_buffer_size());
+
+    void step_boundary() override;
 
 private:
     xzstreambuf buffer_;
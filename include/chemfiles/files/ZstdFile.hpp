@@ -0,0 +1,140 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+
+#ifndef CHEMFILES_ZSTD_FILES_HPP
+#define CHEMFILES_ZSTD_FILES_HPP
+
+#include <streambuf>
+#include <vector>
+#include <cstdio>
+
+#include <zstd.h>
+#include <zstd_seekable.h>
+
+#include "chemfiles/File.hpp"
+
+namespace chemfiles {
+
+/// Options used to compress zstd files, set with `set_zstd_compression`
+struct zstd_compression_options {
+    /// zstd compression level
+    int level;
+    /// Minimal size of uncompressed frames, 0 means the default size
+    size_t frame_size;
+};
+
+/// Get the current zstd compression options
+zstd_compression_options zstd_compression();
+
+/// An implementation of std::streambuf for zstd files.
+///
+/// Files are written using the zstd seekable format: the data is split in
+/// independent frames ending at step boundaries, and a seek table listing all
+/// the frames is added at the end of the file. When reading files containing
+/// a seek table, seeking only decompresses the frame containing the target
+/// position. Other zstd files are decompressed as a stream, and seeking
+/// backward restarts decompression from the beginning of the file.
+class zstdstreambuf final: public std::streambuf {
+public:
+    /// Create a new buffer, using internal buffers of `buffer_size` bytes
+    zstdstreambuf(size_t buffer_size = compressed_buffer_size());
+    ~zstdstreambuf() override;
+
+    zstdstreambuf(const zstdstreambuf&) = delete;
+    zstdstreambuf& operator=(const zstdstreambuf&) = delete;
+    zstdstreambuf(zstdstreambuf&&) = delete;
+    zstdstreambuf& operator=(zstdstreambuf&&) = delete;
+
+    /// Open the file at `path` with the given `mode`. The mode must be `rb` or
+    /// `wb`.
+    void open(const std::string& path, const std::string& mode);
+    bool is_open() const;
+
+    /// Signal a step boundary when writing, starting a new frame if the
+    /// current one is large enough.
+    void step_boundary();
+
+protected:
+    int underflow() override;
+    int overflow(int ch) override;
+    int sync() override;
+    pos_type seekoff(off_type offset, std::ios_base::seekdir way, std::ios_base::openmode which) override;
+    pos_type seekpos(pos_type position, std::ios_base::openmode which) override;
+
+private:
+    /// Decompress the next chunk of data from a file with a seek table,
+    /// returning the number of produced bytes
+    size_t decompress_seekable();
+    /// Decompress the next chunk of data from a file without seek table,
+    /// returning the number of produced bytes. This can return 0 if no data
+    /// was produced yet, and sets `finished_` at the end of the file.
+    size_t decompress_stream();
+    /// Restart decompression of a file without seek table from the
+    /// beginning
+    void restart_stream();
+    /// Call `function` until it returns 0, writing the compressed data it
+    /// produces to the file. This is used to end frames and the stream.
+    template <typename Function>
+    void flush_compressed(Function function);
+    /// Write the compressed data in `out_buffer_` to the file
+    void write_compressed(size_t size);
+
+    /// File used for reading or writing
+    std::FILE* file_ = nullptr;
+    /// Is this buffer used for reading or writing?
+    bool reading_ = true;
+
+    /// Decompression state for files with a seek table
+    ZSTD_seekable* seekable_ = nullptr;
+    /// Total size of the uncompressed data for files with a seek table
+    uint64_t uncompressed_size_ = 0;
+
+    /// Decompression state for files without seek table
+    ZSTD_DStream* dstream_ = nullptr;
+    /// Compressed data available to `dstream_`
+    ZSTD_inBuffer input_ = {nullptr, 0, 0};
+    /// Last value returned by `ZSTD_decompressStream`, 0 at the end of a
+    /// frame
+    size_t stream_status_ = 0;
+    /// Did we reach the end of the file without seek table?
+    bool finished_ = false;
+
+    /// Compression state used when writing
+    ZSTD_seekable_CStream* cstream_ = nullptr;
+    /// Number of uncompressed bytes in the current frame
+    size_t frame_bytes_ = 0;
+    /// Minimal size of the frames when writing
+    size_t frame_size_ = 0;
+    /// Maximal size of the frames when writing
+    size_t max_frame_size_ = 0;
+    /// Number of uncompressed bytes written to the file
+    uint64_t written_ = 0;
+
+    /// Compressed data when reading, put area when writing
+    std::vector<char> in_buffer_;
+    /// Get area when reading, compressed data when writing
+    std::vector<char> out_buffer_;
+
+    /// Offset in the uncompressed data of the end of the get area
+    uint64_t decoded_position_ = 0;
+    /// Number of decompressed bytes to discard before the requested position
+    /// after a seek
+    uint64_t discard_amount_ = 0;
+};
+
+/// A zstd-compressed text file
+class ZstdFile final: public TextFile {
+public:
+    /// Open the file at the given `path` using the specified `mode`, using
+    /// buffers of `buffer_size` bytes for compressed and decompressed data
+    ZstdFile(std::string path, File::Mode mode, size_t buffer_size = compressed_buffer_size());
+
+    void step_boundary() override;
+
+private:
+    zstdstreambuf buffer_;
+};
+
+}
+
+#endif
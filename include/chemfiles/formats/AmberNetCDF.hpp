@@ -4,6 +4,9 @@
 #ifndef CHEMFILES_FORMAT_NC_HPP
 #define CHEMFILES_FORMAT_NC_HPP
 
+#include <vector>
+#include <utility>
+
 #include "chemfiles/types.hpp"
 #include "chemfiles/Format.hpp"
 #include "chemfiles/files/NcFile.hpp"
@@ -23,15 +26,18 @@ public:
 
     void read_step(size_t step, Frame& frame) override;
     void read(Frame& frame) override;
+    void read_metadata(size_t step, FrameMetadata& metadata) override;
     void write(const Frame& frame) override;
 
     size_t nsteps() override;
+    bool set_atom_subset(const std::vector<size_t>& indices) override;
 private:
-    /// Read the unit cell at the current internal step, the file is assumed to
-    /// be valid.
-    UnitCell read_cell();
+    /// Read the unit cell at the given `step`, the file is assumed to be
+    /// valid.
+    UnitCell read_cell(size_t step);
     /// Generic function to read an std::vector<Vector3D> at the current
-    /// internal step, the file is assumed to be valid.
+    /// internal step, the file is assumed to be valid. Only the atoms in
+    /// `atom_subset_` are read if it is not empty.
     void read_array(span<Vector3D> array, const std::string& name);
 
     /// Write an std::vector<Vector3D> to the file, as a variable with the name
@@ -46,6 +52,11 @@ private:
     size_t step_;
     /// Was the associated file validated?
     bool validated_;
+    /// Indices of the atoms to read, or empty to read all atoms
+    std::vector<size_t> atom_subset_;
+    /// Contiguous runs of atoms in `atom_subset_`, as (first atom, number of
+    /// atoms) pairs. Each run is read with a single hyperslab.
+    std::vector<std::pair<size_t, size_t>> subset_runs_;
 };
 
 template<> FormatInfo format_information<AmberNetCDFFormat>();
@@ -0,0 +1,98 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+
+#ifndef CHEMFILES_FORMAT_CONCATENATED_HPP
+#define CHEMFILES_FORMAT_CONCATENATED_HPP
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include <functional>
+
+#include "chemfiles/Format.hpp"
+#include "chemfiles/external/optional.hpp"
+
+namespace chemfiles {
+
+/// Read multiple files one after the other, as a single trajectory.
+///
+/// The files are opened lazily when reading steps from them, and only one file
+/// is kept open at the same time. The number of steps in each file is found
+/// when needed to locate a step, and kept afterward. This is used to
+/// implement `Trajectory::concatenate`.
+class ConcatenatedFormat final: public Format {
+public:
+    using opener_t = std::function<std::unique_ptr<Format>(const std::string& path)>;
+
+    /// Read the files at `paths` one after the other, using `opener` to open
+    /// each file. If `skip_first` is `true`, the first step of each file
+    /// after the first one is skipped.
+    ConcatenatedFormat(std::vector<std::string> paths, opener_t opener, bool skip_first);
+
+    void read_step(size_t step, Frame& frame) override;
+    void read(Frame& frame) override;
+    size_t nsteps() override;
+    bool has_step(size_t step) override;
+    void reuse_steps(Format& other) override;
+    bool set_atom_subset(const std::vector<size_t>& indices) override;
+    bool set_positions_only(bool positions_only) override;
+
+private:
+    /// Location of a step in the concatenated files
+    struct location {
+        /// Index of the file containing the step
+        size_t file;
+        /// Index of the step in this file
+        size_t step;
+    };
+
+    /// Find the file containing the global `step`, returning `nullopt` if
+    /// there is no such step
+    optional<location> locate(size_t step);
+    /// Get the format used to read the file at index `i`, opening it if
+    /// needed and closing the previously opened file
+    Format& open(size_t i);
+    /// Get the number of steps in the file at index `i`, excluding the first
+    /// step when it is skipped
+    size_t count(size_t i);
+    /// Get the index of the first step to use in the file at index `i`
+    size_t first_step(size_t i) const {
+        return (skip_first_ && i > 0) ? 1 : 0;
+    }
+    /// Find the number of steps in all the files
+    void count_all();
+
+    /// Paths of the files
+    std::vector<std::string> paths_;
+    /// Function used to open the files
+    opener_t opener_;
+    /// Should we skip the first step of all files but the first one?
+    bool skip_first_;
+
+    /// Number of steps in each file (including skipped steps), if known
+    std::vector<optional<size_t>> nsteps_;
+    /// Global index of the first step of each file. This is only known for
+    /// the files up to the first file with an unknown number of steps.
+    std::vector<size_t> offsets_;
+    /// Index of the currently opened file
+    size_t current_file_ = SIZE_MAX;
+    /// Format used to read the currently opened file
+    std::unique_ptr<Format> current_;
+    /// Next global step to read with `read`
+    size_t next_ = 0;
+    /// Indices of the atoms to read, or empty to read all atoms
+    std::vector<size_t> atom_subset_;
+    /// Does the currently opened format only read the atoms in
+    /// `atom_subset_`?
+    bool current_subset_ = false;
+    /// Should the formats only read positions, velocities and unit cell?
+    bool positions_only_ = false;
+    /// Does the currently opened format only read positions, velocities and
+    /// unit cell?
+    bool current_positions_only_ = false;
+};
+
+} // namespace chemfiles
+
+#endif
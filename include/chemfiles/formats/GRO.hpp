@@ -6,8 +6,7 @@
 
 #include <map>
 
-#include "chemfiles/Format.hpp"
-#include "chemfiles/File.hpp"
+#include "chemfiles/TextFormat.hpp"
 #include "chemfiles/Residue.hpp"
 
 namespace chemfiles {
@@ -15,22 +14,21 @@ namespace chemfiles {
 /// [GRO] file format reader and writer.
 ///
 /// [GRO]: http://manual.gromacs.org/current/online/gro.html
-class GROFormat final: public Format {
+class GROFormat final: public TextFormat {
 public:
     GROFormat(std::string path, File::Mode mode, File::Compression compression);
 
-    void read_step(size_t step, Frame& frame) override;
-    void read(Frame& frame) override;
-    void write(const Frame& frame) override;
-    size_t nsteps() override;
+    void read_next(Frame& frame) override;
+    void read_next_metadata(FrameMetadata& metadata) override;
+    void write_next(const Frame& frame) override;
+    optional<std::streampos> forward(TextFile& file) override;
+    scanned_steps scan_steps(string_view data, size_t start) override;
+    bool set_positions_only(bool positions_only) override;
 private:
     /// Map of residues, indexed by residue id.
     std::map<size_t, Residue> residues_;
-    /// Text file where we read from
-    std::unique_ptr<TextFile> file_;
-    /// Storing the positions of all the steps in the file, so that we can
-    /// just `seekg` them instead of reading the whole step.
-    std::vector<std::streampos> steps_positions_;
+    /// Should we only read the positions, velocities and unit cell?
+    bool positions_only_ = false;
 };
 
 template<> FormatInfo format_information<GROFormat>();
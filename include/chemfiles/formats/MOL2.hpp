@@ -6,8 +6,7 @@
 
 #include <unordered_map>
 
-#include "chemfiles/Format.hpp"
-#include "chemfiles/File.hpp"
+#include "chemfiles/TextFormat.hpp"
 #include "chemfiles/Residue.hpp"
 
 namespace chemfiles {
@@ -18,7 +17,7 @@ namespace chemfiles {
 /// `END` records, separating the steps.
 ///
 /// [MOL2]:
-class MOL2Format final: public Format {
+class MOL2Format final: public TextFormat {
 public:
     MOL2Format(std::string path, File::Mode mode, File::Compression compression);
 
@@ -27,10 +26,9 @@ public:
     MOL2Format(MOL2Format&&) = default;
     MOL2Format& operator=(MOL2Format&&) = default;
 
-    void read_step(size_t step, Frame& frame) override;
-    void read(Frame& frame) override;
-    void write(const Frame& frame) override;
-    size_t nsteps() override;
+    void read_next(Frame& frame) override;
+    void write_next(const Frame& frame) override;
+    optional<std::streampos> forward(TextFile& file) override;
 
 private:
     // Read Atoms
@@ -39,12 +37,8 @@ private:
     // Read Bonds
     void read_bonds(Frame& frame, size_t nbonds);
 
-    std::unique_ptr<TextFile> file_;
     /// Map of residues, indexed by residue id.
     std::unordered_map<size_t, Residue> residues_;
-    /// Storing the positions of all the steps in the file, so that we can
-    /// just `seekg` them instead of reading the whole step.
-    std::vector<std::streampos> steps_positions_;
 };
 
 template<> FormatInfo format_information<MOL2Format>();
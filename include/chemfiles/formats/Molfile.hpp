@@ -65,6 +65,7 @@ public:
     void read(Frame& frame) override;
     void read_step(size_t step, Frame& frame) override;
     size_t nsteps() override;
+    void reuse_steps(Format& other) override;
 private:
     /// Convert a molfile timestep to a chemfiles frame
     void molfile_to_frame(const molfile_timestep_t& timestep, Frame& frame);
@@ -72,6 +73,12 @@ private:
     void read_topology();
 
     int read_next_timestep(molfile_timestep_t* timestep);
+    /// Skip the next `count` steps in the file, without converting them to
+    /// frames. Plugins are able to skip steps without decoding them in
+    /// most formats.
+    void skip_steps(size_t count);
+    /// Close and re-open the file, to go back to the first step
+    void reopen();
 
     /// Path of the underlying file
     std::string path_;
@@ -85,8 +92,10 @@ private:
     int natoms_;
     /// Store optional topological information
     optional<Topology> topology_;
-    /// Store pre-read steps to implement read_step
-    std::vector<Frame> frames_;
+    /// Index of the next step the plugin will read
+    size_t step_ = 0;
+    /// Number of steps in the file, if we already counted them
+    optional<size_t> nsteps_;
 };
 
 template<> FormatInfo format_information<Molfile<DCD>>();
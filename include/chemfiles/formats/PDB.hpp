@@ -8,9 +8,10 @@
 #include <vector>
 #include <tuple>
 
-#include "chemfiles/Format.hpp"
-#include "chemfiles/File.hpp"
+#include "chemfiles/TextFormat.hpp"
 #include "chemfiles/Residue.hpp"
+#include "chemfiles/UnitCell.hpp"
+#include "chemfiles/types.hpp"
 
 namespace chemfiles {
 
@@ -20,7 +21,7 @@ namespace chemfiles {
 /// `END` records, separating the steps.
 ///
 /// [PDB]: ftp://ftp.wwpdb.org/pub/pdb/doc/format_descriptions/Format_v33_A4.pdf
-class PDBFormat final: public Format {
+class PDBFormat final: public TextFormat {
 public:
     PDBFormat(std::string path, File::Mode mode, File::Compression compression);
 
@@ -30,33 +31,33 @@ public:
     PDBFormat(PDBFormat&&) = default;
     PDBFormat& operator=(PDBFormat&&) = default;
 
-    void read_step(size_t step, Frame& frame) override;
-    void read(Frame& frame) override;
-    void write(const Frame& frame) override;
-    size_t nsteps() override;
+    void read_next(Frame& frame) override;
+    void read_next_metadata(FrameMetadata& metadata) override;
+    void write_next(const Frame& frame) override;
+    optional<std::streampos> forward(TextFile& file) override;
+    bool set_positions_only(bool positions_only) override;
 
     // Connect residues based on a predefined table
     static void link_standard_residue_bonds(Frame& frame);
 
 private:
     // Read CRYST1 record
-    void read_CRYST1(Frame& frame, const std::string& line);
+    UnitCell read_CRYST1(string_view line);
+    // Check if an ENDMDL record ends the current frame, i.e. if it is not
+    // followed by an END record
+    bool end_of_model();
     // Read ATOM and HETATM records
-    void read_ATOM(Frame& frame, const std::string& line, bool is_hetatm);
+    void read_ATOM(Frame& frame, string_view line, bool is_hetatm);
     // Read secondary structure records. All push secinfo_ vector if line is valid
-    void read_HELIX(const std::string& line);
+    void read_HELIX(string_view line);
     // reads SHEET and TURN records. i1 and i2 are the indicies of the chain ids
-    void read_secondary(const std::string& line, size_t i1, size_t i2,
+    void read_secondary(string_view line, size_t i1, size_t i2,
                         const std::string& sec);
     // Read CONECT record
-    void read_CONECT(Frame& frame, const std::string& line);
+    void read_CONECT(Frame& frame, string_view line);
 
-    std::unique_ptr<TextFile> file_;
     /// Map of residues, indexed by residue id and chainid.
     std::map<std::pair<char, size_t>, Residue> residues_;
-    /// Storing the positions of all the steps in the file, so that we can
-    /// just `seekg` them instead of reading the whole step.
-    std::vector<std::streampos> steps_positions_;
     /// Number of models written/read to the file.
     size_t models_;
     /// List of all atom offsets. This maybe pushed in read_ATOM or if a TER
@@ -68,6 +69,11 @@ private:
     /// Store secondary structure information. First field is the chainid,
     /// followed by the first and last residue id in the secondary structure.
     std::vector<std::tuple<char, size_t, size_t, std::string>> secinfo_;
+    /// Should we only read the positions and unit cell?
+    bool positions_only_ = false;
+    /// Positions of the atoms in the current frame, when only reading the
+    /// positions
+    std::vector<Vector3D> positions_;
 };
 
 template<> FormatInfo format_information<PDBFormat>();
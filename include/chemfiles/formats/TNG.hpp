@@ -5,6 +5,7 @@
 #define CHEMFILES_TNG_FORMAT_HPP
 
 #include "chemfiles/Format.hpp"
+#include "chemfiles/UnitCell.hpp"
 #include "chemfiles/files/TNGFile.hpp"
 
 namespace chemfiles {
@@ -18,11 +19,13 @@ public:
 
     void read_step(size_t step, Frame& frame) override;
     void read(Frame& frame) override;
+    void read_metadata(size_t step, FrameMetadata& metadata) override;
     size_t nsteps() override;
 private:
     void read_positions(Frame& frame);
     void read_velocities(Frame& frame);
-    void read_cell(Frame& frame);
+    /// Read the unit cell at the given `step`
+    UnitCell read_cell(int64_t step);
     void read_topology(Frame& frame);
 
     /// Reference to the associated file
@@ -4,28 +4,26 @@
 #ifndef CHEMFILES_FORMAT_XYZ_HPP
 #define CHEMFILES_FORMAT_XYZ_HPP
 
-#include "chemfiles/Format.hpp"
-#include "chemfiles/File.hpp"
+#include "chemfiles/TextFormat.hpp"
 
 namespace chemfiles {
 
 /// [XYZ] file format reader and writer.
 ///
 /// [XYZ]: http://openbabel.org/wiki/XYZ
-class XYZFormat final: public Format {
+class XYZFormat final: public TextFormat {
 public:
     XYZFormat(std::string path, File::Mode mode, File::Compression compression);
 
-    void read_step(size_t step, Frame& frame) override;
-    void read(Frame& frame) override;
-    void write(const Frame& frame) override;
-    size_t nsteps() override;
+    void read_next(Frame& frame) override;
+    void read_next_metadata(FrameMetadata& metadata) override;
+    void write_next(const Frame& frame) override;
+    optional<std::streampos> forward(TextFile& file) override;
+    scanned_steps scan_steps(string_view data, size_t start) override;
+    bool set_positions_only(bool positions_only) override;
 private:
-    /// Text file where we read from
-    std::unique_ptr<TextFile> file_;
-    /// Storing the positions of all the steps in the file, so that we can
-    /// just `seekg` them instead of reading the whole step.
-    std::vector<std::streampos> steps_positions_;
+    /// Should we only read the positions of the atoms?
+    bool positions_only_ = false;
 };
 
 template<> FormatInfo format_information<XYZFormat>();
@@ -0,0 +1,96 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+
+#ifndef CHEMFILES_INTERNED_STRING_HPP
+#define CHEMFILES_INTERNED_STRING_HPP
+
+#include <atomic>
+#include <string>
+
+#include "chemfiles/exports.hpp"
+#include "chemfiles/periodic_table.hpp"
+#include "chemfiles/external/optional.hpp"
+
+namespace chemfiles {
+
+/// An immutable string, stored only once in a global pool and shared by all
+/// the `interned_string` with the same value. This is used for atomic names
+/// and types, which usually take a small number of different values.
+///
+/// Each thread keeps a small cache of recently interned strings, so that
+/// creating strings with the same value again does not need to lock the
+/// pool. The pool itself is split in multiple shards with separate locks.
+///
+/// The pool never shrinks, so only a limited number of different strings is
+/// added to it. When the pool is full, new strings are owned by the
+/// `interned_string` and copied with it, making them as expensive as a
+/// `std::string`. This only happens for systems with a very large number of
+/// different atomic names and types, which would otherwise make the pool grow
+/// without limit.
+class CHFL_EXPORT interned_string final {
+public:
+    /// Create an empty string
+    interned_string();
+    /// Create an interned string with the given `value`
+    explicit interned_string(std::string value);
+
+    ~interned_string();
+    interned_string(const interned_string& other);
+    interned_string& operator=(const interned_string& other);
+    interned_string(interned_string&& other) noexcept;
+    interned_string& operator=(interned_string&& other) noexcept;
+
+    /// Get the value of this string
+    const std::string& str() const {
+        return entry_->value;
+    }
+
+    /// Get the atomic data for atoms with this string as type, looking first
+    /// in the configuration files and then in the periodic table.
+    ///
+    /// The result is cached with the string, and only looked up again when
+    /// the configuration changes.
+    optional<const AtomicData&> atomic_data() const;
+
+private:
+    /// Cached result of `atomic_data`. This is never modified after being
+    /// published, so that the data and its generation are always consistent.
+    struct cached_element {
+        /// Atomic data for this type, or `nullptr` if there is none
+        const AtomicData* element;
+        /// Configuration generation used to compute `element`
+        uint64_t generation;
+        /// Previously published value, kept alive since other threads might
+        /// still be using it
+        const cached_element* previous;
+    };
+
+    /// Entry containing the value of interned strings
+    struct entry {
+        entry(std::string value_, bool pooled_): value(std::move(value_)), pooled(pooled_) {}
+        entry(const entry& other);
+        entry& operator=(const entry&) = delete;
+        ~entry();
+
+        /// Value of the string
+        std::string value;
+        /// Is this entry stored in the global pool? Other entries are owned
+        /// by a single `interned_string`.
+        bool pooled;
+        /// Latest cached result of `atomic_data`, or `nullptr` if it was
+        /// never computed
+        mutable std::atomic<const cached_element*> element = {nullptr};
+    };
+
+    /// Find or create the entry for the given `value`
+    static const entry* intern(std::string value);
+    /// Release the entry used by this string
+    void release();
+
+    /// Entry for this string, never null
+    const entry* entry_;
+};
+
+} // namespace chemfiles
+
+#endif
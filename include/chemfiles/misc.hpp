@@ -5,6 +5,7 @@
 #define CHEMFILES_GENERIC_H
 
 #include <string>
+#include <cstddef>
 #include <functional>
 #include "chemfiles/exports.hpp"
 
@@ -43,6 +44,107 @@ void CHFL_EXPORT set_warning_callback(warning_callback callback);
 ///                            is invalid.
 void CHFL_EXPORT add_configuration(const std::string& path);
 
+/// Enable or disable the use of step index files. The default is to not use
+/// them.
+///
+/// Text formats need to scan the whole file when opening it to find the
+/// position of each step, which can take a long time for large trajectories.
+/// When step index files are enabled, the positions found when reading the
+/// file at `path` are saved in `path.chfl-idx`, and re-used the next time the
+/// same file is opened. The index file is ignored and re-created if the
+/// trajectory was modified since the index was written.
+///
+/// @example{tests/doc/set_step_index_files.cpp}
+///
+/// @param enabled should step index files be read and written
+void CHFL_EXPORT set_step_index_files(bool enabled);
+
+/// Set the maximal number of threads chemfiles can use to read and write
+/// files. Setting this to 0 uses the number of CPU cores on the current
+/// machine, which is the default.
+///
+/// @example{tests/doc/set_io_threads.cpp}
+///
+/// @param threads maximal number of threads to use
+void CHFL_EXPORT set_io_threads(size_t threads);
+
+/// Set the size in bytes of the buffers used to read and write compressed
+/// files (gzip and xz). The default is 1 MiB.
+///
+/// Larger buffers reduce the number of calls to the decompression library and
+/// to the filesystem, at the cost of more memory per opened file. Each opened
+/// compressed file uses a few buffers of this size. The new size is used by
+/// all the files opened after calling this function.
+///
+/// @example{tests/doc/set_compressed_buffer_size.cpp}
+///
+/// @param size size of the buffers in bytes
+void CHFL_EXPORT set_compressed_buffer_size(size_t size);
+
+/// Set the options used to compress xz files when writing.
+///
+/// With the default options (`threads = 1` and `block_size = 0`), files are
+/// compressed in a single block by a single thread. Otherwise, the data is
+/// split in independent blocks of about `block_size` bytes, compressed in
+/// parallel by `threads` threads. When writing trajectories, blocks only end
+/// between two steps, making it faster to read a single step afterward.
+/// Using more threads or smaller blocks reduces the compression ratio a bit.
+/// The new options are used by all the files opened after calling this
+/// function.
+///
+/// @example{tests/doc/set_xz_compression.cpp}
+///
+/// @param threads number of threads to use for compression, 0 means the
+///                value given to `set_io_threads`
+/// @param preset lzma compression preset, from 0 (fastest) to 9 (smallest
+///               files). The default is 6.
+/// @param block_size minimal size in bytes of the uncompressed blocks. 0
+///                   uses 4 MiB blocks when compressing with multiple threads
+/// @throws Error if `preset` is larger than 9
+void CHFL_EXPORT set_xz_compression(size_t threads, unsigned preset = 6, size_t block_size = 0);
+
+/// Set the options used to compress gzip files when writing.
+///
+/// With the default options (`threads = 1` and `block_size = 0`), files are
+/// compressed as a single gzip member by a single thread. Otherwise, the data
+/// is split in chunks of about `block_size` bytes, compressed in parallel by
+/// `threads` threads and written as multiple concatenated gzip members, which
+/// can be read by all the standard tools. When writing trajectories, members
+/// only end between two steps, giving natural starting points to read a
+/// single step afterward. Using more threads or smaller chunks reduces the
+/// compression ratio a bit. The new options are used by all the files opened
+/// after calling this function.
+///
+/// @example{tests/doc/set_gz_compression.cpp}
+///
+/// @param threads number of threads to use for compression, 0 means the
+///                value given to `set_io_threads`
+/// @param level zlib compression level, from 0 (no compression) to 9
+///              (smallest files). The default is 7.
+/// @param block_size minimal size in bytes of the uncompressed chunks. 0 uses
+///                   1 MiB chunks when compressing with multiple threads
+/// @throws Error if `level` is larger than 9
+void CHFL_EXPORT set_gz_compression(size_t threads, unsigned level = 7, size_t block_size = 0);
+
+/// Set the options used to compress zstd files when writing.
+///
+/// zstd files are written in the seekable format, as a sequence of
+/// independent frames of about `frame_size` bytes, followed by a table of
+/// all the frames. When writing trajectories, frames only end between two
+/// steps, so that reading a single step afterward only needs to decompress
+/// the frames containing it. Smaller frames make reading a single step
+/// faster, at the cost of a lower compression ratio. The new options are used
+/// by all the files opened after calling this function.
+///
+/// @example{tests/doc/set_zstd_compression.cpp}
+///
+/// @param level zstd compression level, from 1 (fastest) to 22 (smallest
+///              files). The default is 3.
+/// @param frame_size minimal size in bytes of the uncompressed frames. 0
+///                   uses 1 MiB frames, which is the default.
+/// @throws Error if `level` is not between 1 and 22
+void CHFL_EXPORT set_zstd_compression(unsigned level, size_t frame_size = 0);
+
 } // namespace chemfiles
 
 #endif
@@ -0,0 +1,41 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+
+#ifndef CHEMFILES_PARALLEL_SCAN_HPP
+#define CHEMFILES_PARALLEL_SCAN_HPP
+
+#include <ios>
+#include <vector>
+
+#include "chemfiles/string_view.hpp"
+
+namespace chemfiles {
+
+/// Steps found when scanning a file in memory
+struct scanned_steps {
+    /// Positions of the steps found in the file
+    std::vector<std::streampos> positions;
+    /// Offset in the file where scanning stopped. Any remaining step after
+    /// this offset must be found by reading the file sequentially.
+    size_t end;
+};
+
+/// Find the steps in `data`, containing the whole content of a text file,
+/// starting at offset `start`, which must be the start of a step.
+///
+/// This function is intended for formats where each step contains
+/// `natoms + extra_lines` lines, and the number of atoms is alone on the line
+/// `count_line` of the step (starting at 0). The data is split in chunks which
+/// are searched in parallel for lines containing a single integer, and the
+/// steps are then found by following the number of atoms from one step to the
+/// next.
+///
+/// Scanning stops at the first step which does not have this exact layout,
+/// for example when the number of atoms is not found on the expected line,
+/// or if the step is incomplete. These cases are left to the format's own
+/// sequential code, which should resume at the returned `end` offset.
+scanned_steps scan_steps_parallel(string_view data, size_t start, size_t count_line, size_t extra_lines);
+
+} // namespace chemfiles
+
+#endif
@@ -0,0 +1,250 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+
+#ifndef CHEMFILES_PARSE_HPP
+#define CHEMFILES_PARSE_HPP
+
+#include <string>
+#include <limits>
+#include <cstdint>
+#include <type_traits>
+#include <system_error>
+
+#include "chemfiles/ErrorFmt.hpp"
+#include "chemfiles/string_view.hpp"
+#include "chemfiles/external/optional.hpp"
+
+namespace chemfiles {
+
+/// Result of `from_chars`, mirroring `std::from_chars_result` from C++17
+struct from_chars_result {
+    /// Pointer to the first character not matching the number
+    const char* ptr;
+    /// `std::errc()` on success, `std::errc::invalid_argument` if the input
+    /// does not start with a number, and `std::errc::result_out_of_range` if
+    /// the number does not fit in the output type.
+    std::errc ec;
+};
+
+/// Parse a double from the characters in `[first, last)`, in the same way as
+/// `std::from_chars` from C++17. The number is made of an optional minus sign,
+/// decimal digits with an optional decimal point and an optional exponent,
+/// or one of `inf`, `infinity` and `nan` (ignoring case). The parsing does not
+/// depend on the current locale, and the result is correctly rounded.
+///
+/// On success, `value` is set and `ptr` points after the number. On errors,
+/// `value` is not modified.
+from_chars_result from_chars(const char* first, const char* last, double& value);
+
+/// Parse a signed decimal integer from the characters in `[first, last)`, in
+/// the same way as `std::from_chars` from C++17.
+from_chars_result from_chars(const char* first, const char* last, long long& value);
+
+/// Parse an unsigned decimal integer from the characters in `[first, last)`,
+/// in the same way as `std::from_chars` from C++17.
+from_chars_result from_chars(const char* first, const char* last, unsigned long long& value);
+
+/// Parse an integer of any type `T` from the characters in `[first, last)`,
+/// checking that the value fits in `T`
+template<typename T>
+inline from_chars_result from_chars_integer(const char* first, const char* last, T& value) {
+    using wide_t = typename std::conditional<std::is_signed<T>::value, long long, unsigned long long>::type;
+    wide_t wide = 0;
+    auto result = from_chars(first, last, wide);
+    if (result.ec == std::errc()) {
+        if (wide < static_cast<wide_t>(std::numeric_limits<T>::min()) || wide > static_cast<wide_t>(std::numeric_limits<T>::max())) {
+            result.ec = std::errc::result_out_of_range;
+        } else {
+            value = static_cast<T>(wide);
+        }
+    }
+    return result;
+}
+
+/// Is `c` a whitespace character, in the same way as `std::isspace` in the
+/// "C" locale?
+inline bool is_ascii_whitespace(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' || c == '\r';
+}
+
+/// Convert a string to `T`, throwing a `chemfiles::Error` if the string is not
+/// a valid `T`. Leading whitespaces and a leading `+` sign are accepted, but
+/// the whole string must be used by the conversion.
+template<typename T> inline T parse(string_view string);
+
+namespace implementation {
+    /// Parse the number in `input` with `from_chars`, skipping leading
+    /// whitespaces and `+` sign, and checking that the whole input was used.
+    template<typename T>
+    inline std::errc parse_full(string_view input, T& value) {
+        auto first = input.data();
+        auto last = input.data() + input.size();
+        while (first != last && is_ascii_whitespace(*first)) {
+            first++;
+        }
+        if (first != last && *first == '+' && (last - first == 1 || first[1] != '-')) {
+            first++;
+        }
+        auto result = from_chars(first, last, value);
+        if (result.ec == std::errc() && result.ptr != last) {
+            return std::errc::invalid_argument;
+        }
+        return result.ec;
+    }
+}
+
+/// Convert a string to `T` in the same way as `parse`, returning `nullopt`
+/// instead of throwing an error if the string is not a valid `T`. This should
+/// be used when invalid values are expected, for example when looking for the
+/// next step in a file.
+template<typename T> inline optional<T> try_parse(string_view string);
+
+template<> inline optional<double> try_parse(string_view string) {
+    double value = 0;
+    if (implementation::parse_full(string, value) != std::errc()) {
+        return nullopt;
+    }
+    return value;
+}
+
+template<> inline optional<long long> try_parse(string_view string) {
+    long long value = 0;
+    if (implementation::parse_full(string, value) != std::errc()) {
+        return nullopt;
+    }
+    return value;
+}
+
+template<> inline optional<size_t> try_parse(string_view string) {
+    auto value = try_parse<long long>(string);
+    if (!value || *value < 0 || (sizeof(long long) < sizeof(size_t) && *value > static_cast<long long>(SIZE_MAX))) {
+        return nullopt;
+    }
+    return static_cast<size_t>(*value);
+}
+
+template<> inline double parse(string_view string) {
+    double value = 0;
+    auto ec = implementation::parse_full(string, value);
+    if (ec == std::errc::result_out_of_range) {
+        throw error("{} is out of range for double type", string);
+    } else if (ec != std::errc()) {
+        throw error("can not convert '{}' to a double", string);
+    }
+    return value;
+}
+
+template<> inline long long parse(string_view string) {
+    long long value = 0;
+    auto ec = implementation::parse_full(string, value);
+    if (ec == std::errc::result_out_of_range) {
+        throw error("{} is out of range for long long type", string);
+    } else if (ec != std::errc()) {
+        throw error("can not convert '{}' to an integer", string);
+    }
+    return value;
+}
+
+template<> inline size_t parse(string_view string) {
+    long long value = parse<long long>(string);
+    if (value < 0) {
+        throw error("invalid integer: should be positive, is {}", value);
+    } else if (sizeof(long long) < sizeof(size_t) && value > static_cast<long long>(SIZE_MAX)) {
+        throw error("{} is out of range for size_t type", value);
+    } else {
+        return static_cast<size_t>(value);
+    }
+}
+
+namespace implementation {
+    /// Remove leading whitespaces from `input`
+    inline void skip_whitespaces(string_view& input) {
+        size_t count = 0;
+        while (count < input.size() && is_ascii_whitespace(input[count])) {
+            count++;
+        }
+        input.remove_prefix(count);
+    }
+
+    /// Get the next whitespace-separated token in `input`, advancing `input`
+    /// after it
+    inline string_view next_token(string_view& input) {
+        skip_whitespaces(input);
+        size_t count = 0;
+        while (count < input.size() && !is_ascii_whitespace(input[count])) {
+            count++;
+        }
+        auto token = input.substr(0, count);
+        input.remove_prefix(count);
+        return token;
+    }
+
+    inline std::errc scan_value(string_view token, double& value) {
+        return parse_full(token, value);
+    }
+
+    inline std::errc scan_value(string_view token, string_view& value) {
+        value = token;
+        return std::errc();
+    }
+
+    inline std::errc scan_value(string_view token, std::string& value) {
+        value = token.to_string();
+        return std::errc();
+    }
+
+    template<typename T>
+    inline std::errc scan_value(string_view token, T& value) {
+        static_assert(std::is_integral<T>::value, "unsupported type in scan");
+        auto first = token.data();
+        auto last = token.data() + token.size();
+        if (first != last && *first == '+' && (last - first == 1 || first[1] != '-')) {
+            first++;
+        }
+        auto result = from_chars_integer(first, last, value);
+        if (result.ec == std::errc() && result.ptr != last) {
+            return std::errc::invalid_argument;
+        }
+        return result.ec;
+    }
+
+    inline void scan_values(string_view /*unused*/, string_view& /*unused*/, size_t /*unused*/) {}
+
+    template<typename T, typename... Args>
+    inline void scan_values(string_view line, string_view& input, size_t index, T& value, Args&... args) {
+        auto token = next_token(input);
+        if (token.empty()) {
+            throw error(
+                "failed to read line '{}': expected {} values, got {}",
+                line, index + 1 + sizeof...(Args), index
+            );
+        }
+        auto ec = scan_value(token, value);
+        if (ec != std::errc()) {
+            throw error(
+                "failed to read line '{}': invalid value '{}' for item {}",
+                line, token, index + 1
+            );
+        }
+        scan_values(line, input, index + 1, args...);
+    }
+}
+
+/// Read whitespace-separated values from `input` into `args`, converting each
+/// one to the type of the corresponding argument. Supported types are `double`,
+/// integer types, `std::string` and `string_view`. This throws an `Error` if
+/// `input` does not contain enough values, or if a value can not be converted.
+///
+/// This returns the number of characters used in `input`, including the
+/// whitespaces after the last value.
+template<typename... Args>
+inline size_t scan(string_view input, Args&... args) {
+    auto remaining = input;
+    implementation::scan_values(input, remaining, 0, args...);
+    implementation::skip_whitespaces(remaining);
+    return input.size() - remaining.size();
+}
+
+}
+
+#endif
@@ -0,0 +1,35 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+
+#ifndef CHEMFILES_STEP_INDEX_HPP
+#define CHEMFILES_STEP_INDEX_HPP
+
+#include <string>
+#include <vector>
+#include <iosfwd>
+
+#include "chemfiles/external/optional.hpp"
+
+namespace chemfiles {
+
+/// Get the path of the step index file associated with the trajectory at
+/// `path`.
+std::string step_index_path(const std::string& path);
+
+/// Read the positions of the steps in the trajectory at `path`, read with
+/// the format named `format`, from the associated step index file.
+///
+/// This returns `nullopt` if step index files are disabled, if there is no
+/// index file, or if the index file does not match the current content of the
+/// trajectory.
+optional<std::vector<std::streampos>> read_step_index(const std::string& path, const std::string& format);
+
+/// Write the positions of the steps in the trajectory at `path`, read with the
+/// format named `format`, to the associated step index file. This does
+/// nothing if step index files are disabled, and errors while writing the
+/// file are ignored.
+void write_step_index(const std::string& path, const std::string& format, const std::vector<std::streampos>& positions);
+
+} // namespace chemfiles
+
+#endif
@@ -0,0 +1,128 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+
+#ifndef CHEMFILES_STRING_VIEW_HPP
+#define CHEMFILES_STRING_VIEW_HPP
+
+#include <string>
+#include <cstring>
+#include <ostream>
+#include <stdexcept>
+#include <algorithm>
+
+namespace chemfiles {
+
+/// A non-owning reference to a sequence of characters, similar to C++17
+/// `std::string_view`. Only the subset of the interface used by chemfiles is
+/// implemented.
+///
+/// The referenced characters are not guaranteed to be null-terminated, and
+/// must outlive the view.
+class string_view final {
+public:
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    /// Create an empty view
+    constexpr string_view() noexcept: data_(nullptr), size_(0) {}
+    /// Create a view of the `size` characters starting at `data`
+    constexpr string_view(const char* data, size_t size) noexcept: data_(data), size_(size) {}
+    /// Create a view of the null-terminated string `string`
+    string_view(const char* string) noexcept: data_(string), size_(std::strlen(string)) {}
+    /// Create a view of the content of `string`
+    string_view(const std::string& string) noexcept: data_(string.data()), size_(string.size()) {}
+
+    string_view(const string_view&) noexcept = default;
+    string_view& operator=(const string_view&) noexcept = default;
+
+    const char* data() const noexcept { return data_; }
+    size_t size() const noexcept { return size_; }
+    size_t length() const noexcept { return size_; }
+    bool empty() const noexcept { return size_ == 0; }
+
+    const char* begin() const noexcept { return data_; }
+    const char* end() const noexcept { return data_ + size_; }
+
+    const char& operator[](size_t i) const { return data_[i]; }
+    const char& front() const { return data_[0]; }
+    const char& back() const { return data_[size_ - 1]; }
+
+    /// Get a view of at most `count` characters starting at `pos`. This
+    /// throws `std::out_of_range` if `pos > size()`.
+    string_view substr(size_t pos, size_t count = npos) const {
+        if (pos > size_) {
+            throw std::out_of_range("position out of range in string_view::substr");
+        }
+        return string_view(data_ + pos, std::min(count, size_ - pos));
+    }
+
+    /// Remove the first `count` characters from this view
+    void remove_prefix(size_t count) {
+        data_ += count;
+        size_ -= count;
+    }
+
+    /// Remove the last `count` characters from this view
+    void remove_suffix(size_t count) {
+        size_ -= count;
+    }
+
+    /// Find the first occurrence of `c` after `pos`
+    size_t find(char c, size_t pos = 0) const noexcept {
+        if (pos >= size_) {
+            return npos;
+        }
+        auto found = static_cast<const char*>(std::memchr(data_ + pos, c, size_ - pos));
+        return found == nullptr ? npos : static_cast<size_t>(found - data_);
+    }
+
+    /// Find the first occurrence of any character in the null-terminated
+    /// string `chars`
+    size_t find_first_of(const char* chars) const noexcept {
+        for (size_t i = 0; i < size_; i++) {
+            if (std::strchr(chars, data_[i]) != nullptr) {
+                return i;
+            }
+        }
+        return npos;
+    }
+
+    /// Find the last occurrence of `c`
+    size_t find_last_of(char c) const noexcept {
+        for (size_t i = size_; i > 0; i--) {
+            if (data_[i - 1] == c) {
+                return i - 1;
+            }
+        }
+        return npos;
+    }
+
+    /// Does this view starts with `prefix`?
+    bool starts_with(string_view prefix) const noexcept {
+        return size_ >= prefix.size_ && std::memcmp(data_, prefix.data_, prefix.size_) == 0;
+    }
+
+    /// Create a new string containing a copy of this view
+    std::string to_string() const {
+        return std::string(data_, size_);
+    }
+
+    friend bool operator==(string_view lhs, string_view rhs) noexcept {
+        return lhs.size_ == rhs.size_ && (lhs.size_ == 0 || std::memcmp(lhs.data_, rhs.data_, lhs.size_) == 0);
+    }
+
+    friend bool operator!=(string_view lhs, string_view rhs) noexcept {
+        return !(lhs == rhs);
+    }
+
+    friend std::ostream& operator<<(std::ostream& stream, string_view view) {
+        return stream.write(view.data_, static_cast<std::streamsize>(view.size_));
+    }
+
+private:
+    const char* data_;
+    size_t size_;
+};
+
+} // namespace chemfiles
+
+#endif
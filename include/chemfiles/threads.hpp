@@ -0,0 +1,25 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+
+#ifndef CHEMFILES_THREADS_HPP
+#define CHEMFILES_THREADS_HPP
+
+#include <cstddef>
+#include <functional>
+
+namespace chemfiles {
+
+/// Get the number of threads to use for IO operations, as set with
+/// `set_io_threads`. This is always at least 1.
+size_t io_threads();
+
+/// Call `function(i)` for all `i` in `[0, count)`, using up to `threads`
+/// threads, including the calling thread. If any call throws an exception,
+/// the first one is re-thrown in the calling thread after all the threads
+/// finished. If the system can not start new threads, the work is done using
+/// the threads which could be started.
+void parallel_for(size_t count, size_t threads, const std::function<void(size_t)>& function);
+
+} // namespace chemfiles
+
+#endif
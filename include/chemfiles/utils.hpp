@@ -8,33 +8,69 @@
 #include <string>
 #include <sstream>
 #include <cctype>
-#include <cstdarg>
+#include <cstdio>
+#include <cstring>
 #include <algorithm>
 
 #include "chemfiles/ErrorFmt.hpp"
+#include "chemfiles/parse.hpp"
+#include "chemfiles/string_view.hpp"
+#include "chemfiles/external/optional.hpp"
 
 namespace chemfiles {
 
-inline std::vector<std::string> split(const std::string &s, char delim) {
-    std::stringstream ss(s);
-    std::string item;
-    std::vector<std::string> elems;
-    while (std::getline(ss, item, delim)) {
-        if (item != "") {
-            elems.push_back(item);
+/// Split `string` in multiple views at each occurence of `delim`, removing
+/// empty items.
+inline std::vector<string_view> split(string_view string, char delim) {
+    std::vector<string_view> elems;
+    size_t start = 0;
+    while (start < string.size()) {
+        auto end = string.find(delim, start);
+        if (end == string_view::npos) {
+            end = string.size();
+        }
+        if (end != start) {
+            elems.push_back(string.substr(start, end - start));
         }
+        start = end + 1;
+    }
+    return elems;
+}
+
+inline std::vector<std::string> split(const std::string& string, char delim) {
+    std::vector<std::string> elems;
+    for (auto item: split(string_view(string), delim)) {
+        elems.push_back(item.to_string());
     }
     return elems;
 }
 
-inline std::string trim(const std::string& str) {
-    auto front = std::find_if_not(str.begin(), str.end(), [](int c) {
-        return std::isspace(c);
+inline std::vector<std::string> split(const char* string, char delim) {
+    return split(std::string(string), delim);
+}
+
+/// Remove leading and trailing whitespaces from `string`, returning a view
+/// inside `string`.
+inline string_view trim(string_view string) {
+    auto front = std::find_if_not(string.begin(), string.end(), [](char c) {
+        return std::isspace(static_cast<unsigned char>(c));
     });
-    auto back = std::find_if_not(str.rbegin(), str.rend(), [](int c) {
-        return std::isspace(c);
-    }).base();
-    return (back <= front ? std::string() : std::string(front, back));
+    auto back = std::find_if_not(
+        std::reverse_iterator<const char*>(string.end()),
+        std::reverse_iterator<const char*>(front),
+        [](char c) {
+            return std::isspace(static_cast<unsigned char>(c));
+        }
+    ).base();
+    return string_view(front, static_cast<size_t>(back - front));
+}
+
+inline std::string trim(const std::string& string) {
+    return trim(string_view(string)).to_string();
+}
+
+inline std::string trim(const char* string) {
+    return trim(string_view(string)).to_string();
 }
 
 inline void tolower(std::string& input) {
@@ -51,82 +87,28 @@ std::string hostname();
 std::string user_name();
 /// Get the process current directory
 std::string current_directory();
+/// Get the size in bytes of the file at `path`, or `nullopt` if the file does
+/// not exist
+optional<uint64_t> file_size(const std::string& path);
+/// Move the cursor of `file` to `offset` bytes from the start of the file,
+/// supporting offsets larger than 2 GiB on all platforms. This returns
+/// `false` if the cursor could not be moved.
+bool seek_file(std::FILE* file, uint64_t offset);
+/// Get the position of the cursor of `file`, supporting positions larger
+/// than 2 GiB on all platforms, or `nullopt` if it can not be determined.
+optional<uint64_t> tell_file(std::FILE* file);
 
-/// Convert a string to `T`, throwing a `chemfiles::Error` if the string is not
-/// a valid `T`.
-template<typename T> inline T parse(const std::string& string);
-
-template<> inline double parse(const std::string& string) {
-    try {
-        size_t length = 0;
-        double value = std::stod(string, &length);
-        if (length != string.length()) {
-            throw error("can not convert '{}' to a double", string);
-        }
-        return value;
-    } catch (const std::invalid_argument&) {
-        throw error("can not convert '{}' to a double", string);
-    } catch (const std::out_of_range&) {
-        throw error("{} is out of range for double type", string);
-    }
-}
-
-template<> inline long long parse(const std::string& string) {
-    try {
-        size_t length = 0;
-        long long int value = std::stoll(string, &length);
-        if (length != string.length()) {
-            throw error("can not convert '{}' to an integer", string);
-        }
-        return value;
-    } catch (const std::invalid_argument&) {
-        throw error("can not convert '{}' to an integer", string);
-    } catch (const std::out_of_range&) {
-        throw error("{} is out of range for long long type", string);
-    }
-}
+/// Check if `name` matches the shell wildcard `pattern`, where `*` matches
+/// any sequence of characters and `?` matches a single character.
+bool wildcard_match(string_view pattern, string_view name);
 
-template<> inline size_t parse(const std::string& string) {
-    long long value = parse<long long>(string);
-    if (value < 0) {
-        throw error("invalid integer: should be positive, is {}", value);
-    } else if (sizeof(long long) < sizeof(size_t) && value > static_cast<long long>(SIZE_MAX)) {
-        throw error("{} is out of range for size_t type", value);
-    } else {
-        return static_cast<size_t>(value);
-    }
-}
-
-/// A checked version of sscanf: the return value of sscanf is checked to see if
-/// all the argument where matched.
-#ifdef __GNUC__
-__attribute__((format(scanf, 2, 3)))
-#endif
-inline void scan(const std::string& input, const char* format, ...) {
-    va_list vlist;
-    va_start(vlist, format);
-    int expected = 0;
-    char c = format[0];
-    for (size_t i = 0; c != 0; i++, c = format[i]) {
-        if (c == '%') {
-            // Do not count %n specifiers, or %* specifiers.
-            if (format[i + 1] == 'n' || format[i + 1] == '*') {
-                // We can access format[i + 1] safely, because we did not reach
-                // the null-terminator yet
-                continue;
-            }
-            expected += 1;
-        }
-    }
-    auto actual = std::vsscanf(input.c_str(), format, vlist);
-    if (actual != expected) {
-        throw chemfiles::Error(
-            "failed to read line '" + input + "' with format '" +
-            std::string(format) + "': " + std::to_string(actual) +
-            " matched out of " + std::to_string(expected)
-        );
-    }
-}
+/// Get the paths of the files matching `pattern`, which can contain `*` and
+/// `?` wildcards in its last component, sorted in natural order (numbers in
+/// the names are compared by value, so `part2` comes before `part10`). If the
+/// pattern does not contain wildcards, it is returned as-is. Only regular
+/// files are matched, hidden files are only matched if the pattern starts with
+/// a dot, and step index files are never matched.
+std::vector<std::string> expand_wildcards(const std::string& pattern);
 
 }
 
@@ -5,7 +5,6 @@
 
 #include "chemfiles/Atom.hpp"
 #include "chemfiles/periodic_table.hpp"
-#include "chemfiles/Configuration.hpp"
 
 using namespace chemfiles;
 
@@ -36,18 +35,8 @@ optional<const AtomicData&> chemfiles::find_in_periodic_table(const std::string&
     }
 }
 
-static optional<const AtomicData&> find_element(const std::string& type) {
-    // Look in the configuration first, and then in the periodic table
-    auto element = Configuration::atom_data(type);
-    if (element) {
-        return element;
-    } else {
-        return find_in_periodic_table(type);
-    }
-}
-
 Atom::Atom(std::string name): name_(std::move(name)), type_(name_) {
-    auto element = find_element(type_);
+    auto element = type_.atomic_data();
     if (element) {
         mass_ = element->mass.value_or(0);
         charge_ = element->charge.value_or(0);
@@ -55,15 +44,35 @@ Atom::Atom(std::string name): name_(std::move(name)), type_(name_) {
 }
 
 Atom::Atom(std::string name, std::string type): name_(std::move(name)), type_(std::move(type)) {
-    auto element = find_element(type_);
+    auto element = type_.atomic_data();
     if (element) {
         mass_ = element->mass.value_or(0);
         charge_ = element->charge.value_or(0);
     }
 }
 
+Atom::Atom(const Atom& other):
+    name_(other.name_), type_(other.type_), mass_(other.mass_), charge_(other.charge_),
+    properties_(other.properties_ ? new property_map(*other.properties_) : nullptr) {}
+
+Atom& Atom::operator=(const Atom& other) {
+    if (this != &other) {
+        name_ = other.name_;
+        type_ = other.type_;
+        mass_ = other.mass_;
+        charge_ = other.charge_;
+        properties_.reset(other.properties_ ? new property_map(*other.properties_) : nullptr);
+    }
+    return *this;
+}
+
+const property_map& Atom::no_properties() {
+    static const property_map EMPTY;
+    return EMPTY;
+}
+
 optional<std::string> Atom::full_name() const {
-    auto element = find_element(type_);
+    auto element = type_.atomic_data();
     if (element) {
         return element->full_name;
     } else {
@@ -72,7 +81,7 @@ optional<std::string> Atom::full_name() const {
 }
 
 optional<double> Atom::vdw_radius() const {
-    auto element = find_element(type_);
+    auto element = type_.atomic_data();
     if (element) {
         return element->vdw_radius;
     } else {
@@ -81,7 +90,7 @@ optional<double> Atom::vdw_radius() const {
 }
 
 optional<double> Atom::covalent_radius() const {
-    auto element = find_element(type_);
+    auto element = type_.atomic_data();
     if (element) {
         return element->covalent_radius;
     } else {
@@ -90,7 +99,7 @@ optional<double> Atom::covalent_radius() const {
 }
 
 optional<uint64_t> Atom::atomic_number() const {
-    auto element = find_element(type_);
+    auto element = type_.atomic_data();
     if (element) {
         return element->number;
     } else {
@@ -178,6 +178,7 @@ void Configuration::read_atomic_data(const std::string& path, const toml::Table&
                 std::move(covalent_radius),
                 std::move(vdw_radius),
             };
+            generation_++;
         }
     }
 }
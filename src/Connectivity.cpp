@@ -94,6 +94,72 @@ size_t Improper::operator[](size_t i) const {
     return data_[i];
 }
 
+Connectivity::Connectivity(const Connectivity& other):
+    biggest_atom_(other.biggest_atom_), bonds_(other.bonds_), bond_orders_(other.bond_orders_)
+{
+    // the cache of `other` might be recalculated by another thread
+    std::lock_guard<std::mutex> lock(other.mutex_);
+    if (other.uptodate_) {
+        angles_ = other.angles_;
+        dihedrals_ = other.dihedrals_;
+        impropers_ = other.impropers_;
+        uptodate_ = true;
+    }
+}
+
+Connectivity& Connectivity::operator=(const Connectivity& other) {
+    if (this != &other) {
+        biggest_atom_ = other.biggest_atom_;
+        bonds_ = other.bonds_;
+        bond_orders_ = other.bond_orders_;
+
+        std::lock_guard<std::mutex> lock(other.mutex_);
+        uptodate_ = other.uptodate_.load();
+        if (uptodate_) {
+            angles_ = other.angles_;
+            dihedrals_ = other.dihedrals_;
+            impropers_ = other.impropers_;
+        }
+    }
+    return *this;
+}
+
+Connectivity::Connectivity(Connectivity&& other) noexcept:
+    biggest_atom_(other.biggest_atom_),
+    bonds_(std::move(other.bonds_)),
+    angles_(std::move(other.angles_)),
+    dihedrals_(std::move(other.dihedrals_)),
+    impropers_(std::move(other.impropers_)),
+    uptodate_(other.uptodate_.load()),
+    bond_orders_(std::move(other.bond_orders_))
+{
+    other.clear();
+}
+
+Connectivity& Connectivity::operator=(Connectivity&& other) noexcept {
+    if (this != &other) {
+        biggest_atom_ = other.biggest_atom_;
+        bonds_ = std::move(other.bonds_);
+        angles_ = std::move(other.angles_);
+        dihedrals_ = std::move(other.dihedrals_);
+        impropers_ = std::move(other.impropers_);
+        uptodate_ = other.uptodate_.load();
+        bond_orders_ = std::move(other.bond_orders_);
+        other.clear();
+    }
+    return *this;
+}
+
+void Connectivity::clear() {
+    bonds_.clear();
+    bond_orders_.clear();
+    angles_.clear();
+    dihedrals_.clear();
+    impropers_.clear();
+    biggest_atom_ = 0;
+    uptodate_ = true;
+}
+
 void Connectivity::recalculate() const {
     angles_.clear();
     dihedrals_.clear();
@@ -148,14 +214,21 @@ void Connectivity::recalculate() const {
             }
         }
     }
-
-    uptodate_ = true;
 }
 
-const sorted_set<Bond>& Connectivity::bonds() const {
-    if (!uptodate_) {
+void Connectivity::update() const {
+    if (uptodate_.load(std::memory_order_acquire)) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!uptodate_.load(std::memory_order_relaxed)) {
         recalculate();
+        uptodate_.store(true, std::memory_order_release);
     }
+}
+
+const sorted_set<Bond>& Connectivity::bonds() const {
     return bonds_;
 }
 
@@ -164,23 +237,17 @@ const std::vector<Bond::BondOrder>& Connectivity::bond_orders() const {
 }
 
 const sorted_set<Angle>& Connectivity::angles() const {
-    if (!uptodate_) {
-        recalculate();
-    }
+    update();
     return angles_;
 }
 
 const sorted_set<Dihedral>& Connectivity::dihedrals() const {
-    if (!uptodate_) {
-        recalculate();
-    }
+    update();
     return dihedrals_;
 }
 
 const sorted_set<Improper>& Connectivity::impropers() const {
-    if (!uptodate_) {
-        recalculate();
-    }
+    update();
     return impropers_;
 }
 
@@ -4,20 +4,48 @@
 #include <algorithm>
 
 #include "chemfiles/files/PlainFile.hpp"
+#include "chemfiles/files/MmapFile.hpp"
 #include "chemfiles/files/GzFile.hpp"
 #include "chemfiles/files/XzFile.hpp"
+#include "chemfiles/files/ZstdFile.hpp"
 #include "chemfiles/ErrorFmt.hpp"
+#include "chemfiles/misc.hpp"
+#include "chemfiles/mutex.hpp"
 #include "chemfiles/unreachable.hpp"
 using namespace chemfiles;
 
-std::unique_ptr<TextFile> TextFile::open(std::string path, File::Mode mode, File::Compression compression) {
+/// Size of the buffers used by compressed files
+static mutex<size_t> COMPRESSED_BUFFER_SIZE = {1024 * 1024};
+
+void chemfiles::set_compressed_buffer_size(size_t size) {
+    auto guard = COMPRESSED_BUFFER_SIZE.lock();
+    *guard = size;
+}
+
+size_t chemfiles::compressed_buffer_size() {
+    auto guard = COMPRESSED_BUFFER_SIZE.lock();
+    return *guard;
+}
+
+std::unique_ptr<TextFile> TextFile::open(std::string path, File::Mode mode, File::Compression compression, size_t buffer_size) {
     switch (compression) {
     case File::DEFAULT:
+        if (mode == File::READ) {
+            try {
+                return std::unique_ptr<TextFile>(new MmapFile(path, mode));
+            } catch (const FileError&) {
+                // The file can not be memory-mapped (missing file, pipe,
+                // file too big for the address space, ...). Use standard IO
+                // instead, which will also give a better error message.
+            }
+        }
         return std::unique_ptr<TextFile>(new PlainFile(std::move(path), mode));
     case File::GZIP:
-        return std::unique_ptr<TextFile>(new GzFile(std::move(path), mode));
+        return std::unique_ptr<TextFile>(new GzFile(std::move(path), mode, buffer_size));
     case File::LZMA:
-        return std::unique_ptr<TextFile>(new XzFile(std::move(path), mode));
+        return std::unique_ptr<TextFile>(new XzFile(std::move(path), mode, buffer_size));
+    case File::ZSTD:
+        return std::unique_ptr<TextFile>(new ZstdFile(std::move(path), mode, buffer_size));
     }
     unreachable();
 }
@@ -30,19 +58,14 @@ TextFile::TextFile(std::string path, File::Mode mode, File::Compression compress
     std::iostream::exceptions(std::fstream::badbit | std::fstream::failbit);
 }
 
-/// Read a single line from `stream` in `string`, handling all possible end of
-/// line markers (`\n`, `\r`, `\r\n`).
-///
 /// Code from http://stackoverflow.com/a/6089413
 void TextFile::get_line(std::string& string) {
     string.clear();
 
     // The characters in the stream are read one-by-one using a std::streambuf.
     // That is faster than reading them one-by-one using the std::istream.
-    // Code that uses streambuf this way must be guarded by a sentry object.
-    // The sentry object performs various tasks,
-    // such as thread synchronization and updating the stream state.
-    std::istream::sentry sentry(*this, true);
+    // There is no need for a std::istream::sentry here, since the callers
+    // check that the stream is in a good state before calling this function.
     std::streambuf* buffer = std::istream::rdbuf();
 
     while(true) {
@@ -67,6 +90,11 @@ void TextFile::get_line(std::string& string) {
     }
 }
 
+string_view TextFile::get_line_view(std::string& buffer) {
+    get_line(buffer);
+    return buffer;
+}
+
 void TextFile::rewind() {
     std::istream::clear();
     std::istream::seekg(0, std::ios::beg);
@@ -76,34 +104,77 @@ bool TextFile::eof() {
     return std::istream::eof();
 }
 
+// The functions reading lines check the state of the stream manually instead
+// of relying on the exceptions from std::iostream. The exception mask is set
+// to throw on `failbit`, so `get_line` never sets it.
+
 std::string TextFile::readline() {
-    // Disable exceptions checking, and manually check bellow
-    auto state = this->exceptions();
-    this->exceptions(std::fstream::goodbit);
-    std::string line;
-    get_line(line);
-    if (this->fail()) {
+    if (!this->good()) {
         throw file_error("could not read a line in {}", this->path());
     }
-    // Re-enable exceptions checking
-    this->exceptions(state);
+    std::string line;
+    get_line(line);
     return line;
 }
 
 std::vector<std::string> TextFile::readlines(size_t n) {
-    // Disable exceptions checking, and manually check bellow
-    auto state = this->exceptions();
-    this->exceptions(std::fstream::goodbit);
-
     auto lines = std::vector<std::string>(n);
     for (size_t i = 0; i < n; i++) {
+        if (!this->good()) {
+            throw file_error("could not read a line in {}", this->path());
+        }
         get_line(lines[i]);
     }
+    return lines;
+}
 
-    if (this->fail()) {
+string_view TextFile::readline_view() {
+    auto line = try_readline_view();
+    if (!line) {
         throw file_error("could not read a line in {}", this->path());
     }
-    // Re-enable exceptions checking
-    this->exceptions(state);
-    return lines;
+    return *line;
+}
+
+optional<string_view> TextFile::try_readline_view() {
+    if (!this->good()) {
+        return nullopt;
+    }
+    if (lines_buffers_.empty()) {
+        lines_buffers_.resize(1);
+    }
+    return get_line_view(lines_buffers_[0]);
+}
+
+const std::vector<string_view>& TextFile::readlines_view(size_t n) {
+    // Keep the buffers around between calls, re-using the memory they
+    // already allocated
+    if (lines_buffers_.size() < n) {
+        lines_buffers_.resize(n);
+    }
+    lines_views_.resize(n);
+    for (size_t i = 0; i < n; i++) {
+        if (!this->good()) {
+            throw file_error("could not read a line in {}", this->path());
+        }
+        lines_views_[i] = get_line_view(lines_buffers_[i]);
+    }
+    return lines_views_;
+}
+
+bool TextFile::skip_lines(size_t n) {
+    if (lines_buffers_.empty()) {
+        lines_buffers_.resize(1);
+    }
+    for (size_t i = 0; i < n; i++) {
+        if (!this->good()) {
+            return false;
+        }
+        get_line_view(lines_buffers_[0]);
+        if (this->eof()) {
+            // `get_line` found the end of the file instead of a line
+            return false;
+        }
+    }
+    return true;
 }
@@ -4,6 +4,7 @@
 #include <typeinfo>
 
 #include "chemfiles/Format.hpp"
+#include "chemfiles/Frame.hpp"
 #include "chemfiles/ErrorFmt.hpp"
 using namespace chemfiles;
 
@@ -21,9 +22,29 @@ void Format::read(Frame& /*unused*/) {
     );
 }
 
+void Format::read_metadata(size_t step, FrameMetadata& metadata) {
+    Frame frame;
+    read_step(step, frame);
+    metadata = FrameMetadata(frame);
+}
+
 void Format::write(const Frame& /*unused*/) {
     throw format_error(
         "'write' is not implemented for this format ({})",
         typeid(*this).name()
     );
 }
+
+bool Format::has_step(size_t step) {
+    return step < nsteps();
+}
+
+void Format::reuse_steps(Format& /*unused*/) {}
+
+bool Format::set_atom_subset(const std::vector<size_t>& /*unused*/) {
+    return false;
+}
+
+bool Format::set_positions_only(bool /*unused*/) {
+    return false;
+}
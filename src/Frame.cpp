@@ -9,10 +9,13 @@ using namespace chemfiles;
 
 Frame::Frame(UnitCell cell): cell_(cell) {}
 
+FrameMetadata::FrameMetadata(const Frame& frame):
+    step(frame.step()), natoms(frame.size()), cell(frame.cell()), properties(frame.properties()) {}
+
 size_t Frame::size() const {
     assert(positions_.size() == topology_.size());
-    if (velocities_) {
-        assert(positions_.size() == velocities_->size());
+    if (has_velocities_) {
+        assert(positions_.size() == velocities_.size());
     }
     return positions_.size();
 }
@@ -20,22 +23,46 @@ size_t Frame::size() const {
 void Frame::resize(size_t size) {
     topology_.resize(size);
     positions_.resize(size);
-    if (velocities_) {
-        velocities_->resize(size);
+    if (has_velocities_) {
+        velocities_.resize(size);
     }
 }
 
 void Frame::reserve(size_t size) {
     topology_.reserve(size);
     positions_.reserve(size);
-    if (velocities_) {
-        velocities_->reserve(size);
+    if (has_velocities_) {
+        velocities_.reserve(size);
     }
 }
 
+void Frame::clear() {
+    step_ = 0;
+    topology_.clear();
+    positions_.clear();
+    // keep the memory used by velocities, in case the next step also
+    // contains velocities
+    velocities_.clear();
+    has_velocities_ = false;
+    cell_ = UnitCell();
+    properties_.clear();
+}
+
+void Frame::reset(const Topology& topology) {
+    step_ = 0;
+    // share the data of `topology` instead of clearing the current one
+    topology_ = topology;
+    positions_.assign(topology_.size(), Vector3D());
+    velocities_.clear();
+    has_velocities_ = false;
+    cell_ = UnitCell();
+    properties_.clear();
+}
+
 void Frame::add_velocities() {
-    if (!velocities_) {
-        velocities_ = std::vector<Vector3D>(size());
+    if (!has_velocities_) {
+        velocities_.assign(size(), Vector3D());
+        has_velocities_ = true;
     }
 }
 
@@ -43,28 +70,24 @@ void Frame::guess_bonds() {
     topology_.clear_bonds();
     // This bond guessing algorithm comes from VMD
     auto cutoff = 0.833;
+    auto vdw_radii = std::vector<double>();
+    vdw_radii.reserve(size());
     for (size_t i = 0; i < size(); i++) {
-        auto rad = topology_[i].vdw_radius().value_or(0);
-        cutoff = std::max(cutoff, rad);
+        auto radius = topology()[i].vdw_radius();
+        if (!radius) {
+            throw error(
+                "Missing Van der Waals radius for '{}'", topology()[i].type()
+            );
+        }
+        vdw_radii.push_back(*radius);
+        cutoff = std::max(cutoff, *radius);
     }
     cutoff = 1.2 * cutoff;
 
     for (size_t i = 0; i < size(); i++) {
-        auto i_radius = topology_[i].vdw_radius();
-        if (!i_radius) {
-            throw error(
-                "Missing Van der Waals radius for '{}'", topology_[i].type()
-            );
-        }
         for (size_t j = i + 1; j < size(); j++) {
-            auto j_radius = topology_[j].vdw_radius();
-            if (!j_radius) {
-                throw error(
-                    "Missing Van der Waals radius for '{}'", topology_[j].type()
-                );
-            }
             auto d = distance(i, j);
-            auto radii = i_radius.value() + j_radius.value();
+            auto radii = vdw_radii[i] + vdw_radii[j];
             if (0.03 < d && d < 0.6 * radii && d < cutoff) {
                 topology_.add_bond(i, j);
             }
@@ -77,10 +100,10 @@ void Frame::guess_bonds() {
     // once
     for (auto& bond : bonds) {
         auto i = bond[0], j = bond[1];
-        if (topology_[i].type() != "H") {
+        if (topology()[i].type() != "H") {
             continue;
         }
-        if (topology_[j].type() != "H") {
+        if (topology()[j].type() != "H") {
             continue;
         }
 
@@ -113,8 +136,8 @@ void Frame::set_topology(Topology topology) {
 void Frame::add_atom(Atom atom, Vector3D position, Vector3D velocity) {
     topology_.add_atom(std::move(atom));
     positions_.push_back(position);
-    if (velocities_) {
-        velocities_->push_back(velocity);
+    if (has_velocities_) {
+        velocities_.push_back(velocity);
     }
     assert(size() == topology_.size());
 }
@@ -129,8 +152,8 @@ void Frame::remove(size_t i) {
     }
     topology_.remove(i);
     positions_.erase(positions_.begin() + static_cast<std::ptrdiff_t>(i));
-    if (velocities_) {
-        velocities_->erase(velocities_->begin() + static_cast<std::ptrdiff_t>(i));
+    if (has_velocities_) {
+        velocities_.erase(velocities_.begin() + static_cast<std::ptrdiff_t>(i));
     }
     assert(size() == topology_.size());
 }
@@ -0,0 +1,159 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <exception>
+#include <algorithm>
+#include <condition_variable>
+
+#include "chemfiles/Trajectory.hpp"
+using namespace chemfiles;
+
+struct PrefetchedFrames::state {
+    state(Trajectory& trajectory_, size_t prefetch_):
+        trajectory(trajectory_), prefetch(std::max<size_t>(prefetch_, 1)) {}
+
+    /// Read frames from the trajectory until the end of the file, an error or
+    /// a call to `stop`. This runs in the background thread.
+    void produce();
+
+    /// Trajectory used to read frames, only used by the background thread
+    Trajectory& trajectory;
+    /// Maximal number of frames in `ready`
+    size_t prefetch;
+
+    /// Mutex protecting all the data below
+    std::mutex mutex;
+    /// Notified when a frame is added to `ready`, or when `finished` changes
+    std::condition_variable frame_ready;
+    /// Notified when a frame is removed from `ready`, or when `stopped` changes
+    std::condition_variable space_available;
+    /// Frames read by the background thread, not yet used by the consumer
+    std::deque<Frame> ready;
+    /// Frames already used by the consumer, with memory we can re-use
+    std::vector<Frame> unused;
+    /// Exception thrown by the background thread
+    std::exception_ptr exception;
+    /// Did the background thread finish reading frames?
+    bool finished = false;
+    /// Did the consumer request the background thread to stop?
+    bool stopped = false;
+
+    /// Background thread reading the frames
+    std::thread thread;
+};
+
+void PrefetchedFrames::state::produce() {
+    while (true) {
+        Frame frame;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            space_available.wait(lock, [this]() {
+                return stopped || ready.size() < prefetch;
+            });
+            if (stopped) {
+                break;
+            }
+            if (!unused.empty()) {
+                frame = std::move(unused.back());
+                unused.pop_back();
+            }
+        }
+
+        try {
+            if (trajectory.done()) {
+                break;
+            }
+            trajectory.read(frame);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(mutex);
+            exception = std::current_exception();
+            break;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        ready.emplace_back(std::move(frame));
+        frame_ready.notify_one();
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    finished = true;
+    frame_ready.notify_one();
+}
+
+PrefetchedFrames::PrefetchedFrames(Trajectory& trajectory, size_t prefetch):
+    state_(new state(trajectory, prefetch))
+{
+    auto* shared = state_.get();
+    shared->thread = std::thread([shared]() { shared->produce(); });
+}
+
+PrefetchedFrames::~PrefetchedFrames() {
+    stop();
+}
+
+PrefetchedFrames::PrefetchedFrames(PrefetchedFrames&&) = default;
+
+PrefetchedFrames& PrefetchedFrames::operator=(PrefetchedFrames&& other) {
+    stop();
+    state_ = std::move(other.state_);
+    current_ = std::move(other.current_);
+    return *this;
+}
+
+void PrefetchedFrames::stop() {
+    if (!state_) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        state_->stopped = true;
+        state_->space_available.notify_one();
+    }
+    if (state_->thread.joinable()) {
+        state_->thread.join();
+    }
+}
+
+bool PrefetchedFrames::next(Frame& frame) {
+    if (!state_) {
+        return false;
+    }
+
+    std::unique_lock<std::mutex> lock(state_->mutex);
+    state_->frame_ready.wait(lock, [this]() {
+        return !state_->ready.empty() || state_->finished;
+    });
+
+    if (!state_->ready.empty()) {
+        // give the memory used by the previous frame to the background thread
+        state_->unused.emplace_back(std::move(frame));
+        frame = std::move(state_->ready.front());
+        state_->ready.pop_front();
+        state_->space_available.notify_one();
+        return true;
+    }
+
+    if (state_->exception) {
+        auto exception = state_->exception;
+        state_->exception = nullptr;
+        std::rethrow_exception(exception);
+    }
+    return false;
+}
+
+PrefetchedFrames::iterator PrefetchedFrames::begin() {
+    auto it = iterator(this);
+    return ++it;
+}
+
+PrefetchedFrames::iterator& PrefetchedFrames::iterator::operator++() {
+    if (frames_ != nullptr && !frames_->next(frames_->current_)) {
+        frames_ = nullptr;
+    }
+    return *this;
+}
@@ -0,0 +1,265 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+
+#include <cassert>
+#include <cstdint>
+
+#include "chemfiles/TextFormat.hpp"
+
+#include "chemfiles/ErrorFmt.hpp"
+#include "chemfiles/Frame.hpp"
+#include "chemfiles/utils.hpp"
+#include "chemfiles/step_index.hpp"
+#include "chemfiles/files/MmapFile.hpp"
+
+using namespace chemfiles;
+
+TextFormat::TextFormat(std::string path, File::Mode mode, File::Compression compression, std::string name):
+    file_(TextFile::open(std::move(path), mode, compression)),
+    name_(std::move(name)), mode_(mode),
+    steps_positions_(std::make_shared<std::vector<std::streampos>>())
+{
+    if (mode == File::WRITE) {
+        // There is nothing to scan in a new file
+        scan_done_ = true;
+    }
+}
+
+TextFormat::~TextFormat() noexcept = default;
+
+void TextFormat::read_step(size_t step, Frame& frame) {
+    if (!index_until(step)) {
+        throw format_error(
+            "can not read step {} in '{}': the file only contains {} steps",
+            step, file_->path(), steps_positions_->size()
+        );
+    }
+    file_->seekg((*steps_positions_)[step]);
+    read_next(frame);
+}
+
+void TextFormat::read(Frame& frame) {
+    read_next(frame);
+}
+
+void TextFormat::read_metadata(size_t step, FrameMetadata& metadata) {
+    if (!index_until(step)) {
+        throw format_error(
+            "can not read step {} in '{}': the file only contains {} steps",
+            step, file_->path(), steps_positions_->size()
+        );
+    }
+    file_->seekg((*steps_positions_)[step]);
+    read_next_metadata(metadata);
+}
+
+void TextFormat::read_next_metadata(FrameMetadata& metadata) {
+    Frame frame;
+    read_next(frame);
+    metadata = FrameMetadata(frame);
+}
+
+void TextFormat::write(const Frame& frame) {
+    // find the existing steps before adding new ones
+    index_until(SIZE_MAX);
+    write_next(frame);
+    file_->step_boundary();
+    unique_positions().push_back(file_->tellg());
+}
+
+void TextFormat::write_next(const Frame& /*unused*/) {
+    throw format_error("'write' is not implemented for the {} format", name_);
+}
+
+size_t TextFormat::nsteps() {
+    // find all the steps in the file
+    index_until(SIZE_MAX);
+    return steps_positions_->size();
+}
+
+bool TextFormat::has_step(size_t step) {
+    return index_until(step);
+}
+
+bool TextFormat::index_until(size_t step) {
+    if (!index_loaded_) {
+        index_loaded_ = true;
+        if (mode_ == File::READ) {
+            scanned_size_ = file_size(file_->path()).value_or(uint64_t(0));
+            auto positions = read_step_index(file_->path(), name_);
+            if (positions) {
+                unique_positions() = std::move(*positions);
+                scan_done_ = true;
+            }
+        }
+    }
+
+    if (step < steps_positions_->size()) {
+        return true;
+    }
+
+    if (scan_done_ && mode_ == File::READ) {
+        // the file might still be written to, look for new steps if it grew
+        // since we started scanning it
+        auto size = file_size(file_->path());
+        if (size && *size > scanned_size_) {
+            scanned_size_ = *size;
+            resume_scan();
+        }
+    }
+
+    if (!scan_done_) {
+        scan_until(step);
+    }
+    return step < steps_positions_->size();
+}
+
+void TextFormat::scan_until(size_t step) {
+    if (mode_ != File::READ) {
+        // Appending to a file: the existing steps are found before writing
+        // anything, there is no position to restore
+        if (step == SIZE_MAX) {
+            scan_remaining();
+        }
+        while (!scan_done_ && steps_positions_->size() <= step) {
+            scan_next();
+        }
+        return;
+    }
+
+    // Scanning uses the same file as reading (sharing the state of
+    // compressed files), restore the reading position afterward
+    auto& file = *file_;
+    auto state = file.rdstate();
+    file.clear();
+    auto read_position = file.tellg();
+    auto restore = [&]() {
+        file.clear();
+        file.seekg(read_position);
+        file.clear(state);
+    };
+
+    try {
+        file.seekg(scan_position_);
+        if (step == SIZE_MAX) {
+            // all the remaining steps are needed, try to find them all at once
+            scan_remaining();
+        }
+        while (!scan_done_ && steps_positions_->size() <= step) {
+            if (!scan_next()) {
+                break;
+            }
+        }
+    } catch (...) {
+        restore();
+        throw;
+    }
+    restore();
+}
+
+void TextFormat::scan_remaining() {
+    auto mmap = dynamic_cast<MmapFile*>(file_.get());
+    if (mmap == nullptr || !*mmap || mmap->eof()) {
+        return;
+    }
+
+    auto start = static_cast<size_t>(std::streamoff(mmap->tellg()));
+    auto steps = scan_steps(mmap->contents(), start);
+    auto& positions = unique_positions();
+    positions.insert(positions.end(), steps.positions.begin(), steps.positions.end());
+    mmap->seekg(static_cast<std::streamoff>(steps.end));
+    scan_position_ = static_cast<std::streamoff>(steps.end);
+}
+
+scanned_steps TextFormat::scan_steps(string_view /*unused*/, size_t start) {
+    return {{}, start};
+}
+
+bool TextFormat::scan_next() {
+    auto& file = *file_;
+    if (!file.eof()) {
+        if (!file) {
+            throw format_error("IO error while reading '{}' as {}", file_->path(), name_);
+        }
+        auto start = file.tellg();
+        optional<std::streampos> position;
+        try {
+            position = forward(file);
+        } catch (const Error&) {
+            auto truncated = mode_ == File::READ && file.eof();
+            // go back to the start of the step, to get the same error if
+            // the user tries to access this step again
+            file.clear();
+            file.seekg(start);
+            if (truncated) {
+                // The last step is incomplete, the file might still be
+                // written to. Consider that there are no more steps for now,
+                // and scan this step again the next time.
+                scan_position_ = start;
+                return false;
+            }
+            throw;
+        }
+        if (position) {
+            unique_positions().push_back(*position);
+        }
+    }
+
+    // Check for the end of the file right away, instead of trying to seek
+    // there to continue scanning later
+    if (file.eof() || file.peek() == std::char_traits<char>::eof()) {
+        scan_done_ = true;
+        if (mode_ == File::READ) {
+            write_step_index(file_->path(), name_, *steps_positions_);
+        } else {
+            file.rewind();
+        }
+    } else {
+        scan_position_ = file.tellg();
+    }
+    return true;
+}
+
+void TextFormat::resume_scan() {
+    // the last step might have been incomplete, or we might not know where
+    // it ends if the steps were loaded from a step index file. Scan it again.
+    auto& positions = unique_positions();
+    if (positions.empty()) {
+        scan_position_ = 0;
+    } else {
+        scan_position_ = positions.back();
+        positions.pop_back();
+    }
+    scan_done_ = false;
+}
+
+void TextFormat::reuse_steps(Format& other) {
+    auto text_format = dynamic_cast<TextFormat*>(&other);
+    if (text_format == nullptr || mode_ != File::READ || text_format->mode_ != File::READ) {
+        return;
+    }
+
+    file_->share_index(*text_format->file_);
+
+    if (!text_format->index_loaded_) {
+        // the other format did not look for steps yet
+        return;
+    }
+
+    index_loaded_ = true;
+    steps_positions_ = text_format->steps_positions_;
+    positions_shared_ = true;
+    text_format->positions_shared_ = true;
+    // continue scanning for steps where the other format stopped
+    scan_done_ = text_format->scan_done_;
+    scan_position_ = text_format->scan_position_;
+    scanned_size_ = text_format->scanned_size_;
+}
+
+std::vector<std::streampos>& TextFormat::unique_positions() {
+    if (positions_shared_) {
+        steps_positions_ = std::make_shared<std::vector<std::streampos>>(*steps_positions_);
+        positions_shared_ = false;
+    }
+    return *steps_positions_;
+}
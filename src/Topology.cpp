@@ -6,8 +6,77 @@
 
 using namespace chemfiles;
 
+const std::shared_ptr<Topology::data>& Topology::empty_data() {
+    static const auto EMPTY = std::make_shared<Topology::data>();
+    return EMPTY;
+}
+
+Topology::Topology(): data_(empty_data()), shared_(true) {}
+
+Topology::Topology(const Topology& other): data_(other.share()), shared_(true) {}
+
+Topology& Topology::operator=(const Topology& other) {
+    if (this != &other) {
+        data_ = other.share();
+        shared_ = true;
+        references_given_ = false;
+    }
+    return *this;
+}
+
+Topology::Topology(Topology&& other) noexcept:
+    data_(std::move(other.data_)),
+    shared_(other.shared_.load()),
+    references_given_(other.references_given_)
+{
+    other.data_ = empty_data();
+    other.shared_ = true;
+    other.references_given_ = false;
+}
+
+Topology& Topology::operator=(Topology&& other) noexcept {
+    if (this != &other) {
+        data_ = std::move(other.data_);
+        shared_ = other.shared_.load();
+        references_given_ = other.references_given_;
+        other.data_ = empty_data();
+        other.shared_ = true;
+        other.references_given_ = false;
+    }
+    return *this;
+}
+
+std::shared_ptr<Topology::data> Topology::share() const {
+    if (references_given_) {
+        // the user can still modify the atoms of this topology
+        return std::make_shared<data>(*data_);
+    }
+    shared_.store(true, std::memory_order_relaxed);
+    return data_;
+}
+
+Topology::data& Topology::mutable_data() {
+    // Checking `data_.use_count()` instead would race with other threads
+    // releasing their copy of the data
+    if (shared_.load(std::memory_order_relaxed)) {
+        data_ = std::make_shared<data>(*data_);
+        shared_ = false;
+    }
+    return *data_;
+}
+
+std::vector<Atom>& Topology::mutable_atoms() {
+    auto& atoms = mutable_data().atoms;
+    references_given_ = true;
+    return atoms;
+}
+
 void Topology::resize(size_t size) {
-    for (auto& bond: connect_.bonds()) {
+    if (size == this->size()) {
+        // nothing to do, and the data can stay shared
+        return;
+    }
+    for (auto& bond: data_->connect.bonds()) {
         if (bond[0] >= size || bond[1] >= size) {
             throw error(
                 "can not resize the topology to contains {} atoms as there "
@@ -16,15 +85,33 @@ void Topology::resize(size_t size) {
             );
         }
     }
-    atoms_.resize(size, Atom());
+    mutable_data().atoms.resize(size, Atom());
 }
 
 void Topology::add_atom(Atom atom) {
-    atoms_.emplace_back(std::move(atom));
+    mutable_data().atoms.emplace_back(std::move(atom));
 }
 
 void Topology::reserve(size_t size) {
-    atoms_.reserve(size);
+    mutable_data().atoms.reserve(size);
+}
+
+void Topology::clear() {
+    if (!shared_.load(std::memory_order_relaxed)) {
+        // keep the allocated memory
+        data_->atoms.clear();
+        data_->connect.clear();
+        data_->residues.clear();
+        data_->residue_mapping.clear();
+    } else if (data_ != empty_data()) {
+        // the data is used by other topologies, start from new data with
+        // the same capacity
+        auto capacity = data_->atoms.capacity();
+        data_ = std::make_shared<data>();
+        data_->atoms.reserve(capacity);
+        shared_ = false;
+    }
+    references_given_ = false;
 }
 
 void Topology::add_bond(size_t atom_i, size_t atom_j, Bond::BondOrder bond_order) {
@@ -35,7 +122,7 @@ void Topology::add_bond(size_t atom_i, size_t atom_j, Bond::BondOrder bond_order
             size(), atom_i, atom_j
         );
     }
-    connect_.add_bond(atom_i, atom_j, bond_order);
+    mutable_data().connect.add_bond(atom_i, atom_j, bond_order);
 }
 
 void Topology::remove_bond(size_t atom_i, size_t atom_j) {
@@ -46,7 +133,7 @@ void Topology::remove_bond(size_t atom_i, size_t atom_j) {
             size(), atom_i, atom_j
         );
     }
-    connect_.remove_bond(atom_i, atom_j);
+    mutable_data().connect.remove_bond(atom_i, atom_j);
 }
 
 Bond::BondOrder Topology::bond_order(size_t atom_i, size_t atom_j) const {
@@ -58,7 +145,7 @@ Bond::BondOrder Topology::bond_order(size_t atom_i, size_t atom_j) const {
         );
     }
 
-    return connect_.bond_order(atom_i, atom_j);
+    return data_->connect.bond_order(atom_i, atom_j);
 }
 
 void Topology::remove(size_t i) {
@@ -69,52 +156,54 @@ void Topology::remove(size_t i) {
             size(), i
         );
     }
-    atoms_.erase(atoms_.begin() + static_cast<std::ptrdiff_t>(i));
+    auto& data = mutable_data();
+    data.atoms.erase(data.atoms.begin() + static_cast<std::ptrdiff_t>(i));
     // Remove all bonds with the removed atom
-    auto bonds = connect_.bonds();
+    auto bonds = data.connect.bonds();
     for (auto& bond : bonds) {
         if (bond[0] == i || bond[1] == i) {
-            connect_.remove_bond(bond[0], bond[1]);
+            data.connect.remove_bond(bond[0], bond[1]);
         }
     }
     // Shift all bonds indexes
-    connect_.atom_removed(i);
+    data.connect.atom_removed(i);
 }
 
 const std::vector<Bond>& Topology::bonds() const {
-    return connect_.bonds().as_vec();
+    return data_->connect.bonds().as_vec();
 }
 
 const std::vector<Bond::BondOrder>& Topology::bond_orders() const {
-    return connect_.bond_orders();
+    return data_->connect.bond_orders();
 }
 
 const std::vector<Angle>& Topology::angles() const {
-    return connect_.angles().as_vec();
+    return data_->connect.angles().as_vec();
 }
 
 const std::vector<Dihedral>& Topology::dihedrals() const {
-    return connect_.dihedrals().as_vec();
+    return data_->connect.dihedrals().as_vec();
 }
 
 const std::vector<Improper>& Topology::impropers() const {
-    return connect_.impropers().as_vec();
+    return data_->connect.impropers().as_vec();
 }
 
 void Topology::add_residue(Residue residue) {
     for (auto i: residue) {
-        auto it = residue_mapping_.find(i);
-        if (it != residue_mapping_.end()) {
+        auto it = data_->residue_mapping.find(i);
+        if (it != data_->residue_mapping.end()) {
             throw error(
                 "can not add this residue: atom {} is already in another residue",
                 i
             );
         }
     }
-    auto resid = residues_.size();
-    residues_.emplace_back(std::move(residue));
-    for (auto i: residues_.back()) {
-        residue_mapping_.insert({i, resid});
+    auto& data = mutable_data();
+    auto resid = data.residues.size();
+    data.residues.emplace_back(std::move(residue));
+    for (auto i: data.residues.back()) {
+        data.residue_mapping.insert({i, resid});
     }
 }
 
@@ -122,7 +211,7 @@ bool Topology::are_linked(const Residue& first, const Residue& second) const {
     if (first == second) {
         return true;
     }
-    auto bonds = connect_.bonds();
+    auto bonds = data_->connect.bonds();
     for (auto i: first) {
         for (auto j: second) {
             if (bonds.find({i, j}) != bonds.end()) {
@@ -134,11 +223,11 @@ bool Topology::are_linked(const Residue& first, const Residue& second) const {
 }
 
 optional<const Residue&> Topology::residue_for_atom(size_t index) const {
-    auto it = residue_mapping_.find(index);
-    if (it == residue_mapping_.end()) {
+    auto it = data_->residue_mapping.find(index);
+    if (it == data_->residue_mapping.end()) {
         // This atom is not in a residue
         return nullopt;
     } else {
-        return residues_[it->second];
+        return data_->residues[it->second];
     }
 }
@@ -1,13 +1,21 @@
 // Chemfiles, a modern library for chemistry file reading and writing
 // Copyright (C) Guillaume Fraux and contributors -- BSD license
 
+#include <fstream>
+#include <algorithm>
+
 #include "chemfiles/Trajectory.hpp"
 #include "chemfiles/File.hpp"
 #include "chemfiles/Format.hpp"
+#include "chemfiles/TextFormat.hpp"
 #include "chemfiles/ErrorFmt.hpp"
 #include "chemfiles/utils.hpp"
 #include "chemfiles/Configuration.hpp"
 #include "chemfiles/FormatFactory.hpp"
+#include "chemfiles/threads.hpp"
+#include "chemfiles/Selection.hpp"
+#include "chemfiles/atom_subset.hpp"
+#include "chemfiles/formats/Concatenated.hpp"
 
 using namespace chemfiles;
 
@@ -28,6 +36,8 @@ file_open_info file_open_info::parse(const std::string& path, const std::string&
             info.compression = File::GZIP;
         } else if (compression == "XZ") {
             info.compression = File::LZMA;
+        } else if (compression == "ZST") {
+            info.compression = File::ZSTD;
         } else {
             throw file_error("unknown compression method '{}'", compression);
         }
@@ -47,6 +57,9 @@ file_open_info file_open_info::parse(const std::string& path, const std::string&
             } else if (info.extension == ".xz") {
                 new_extension = true;
                 info.compression = File::LZMA;
+            } else if (info.extension == ".zst") {
+                new_extension = true;
+                info.compression = File::ZSTD;
             }
 
             if (new_extension) {
@@ -77,10 +90,10 @@ static File::Mode char_to_file_mode(char mode) {
     }
 }
 
-Trajectory::Trajectory(std::string path, char mode, const std::string& format)
-    : path_(std::move(path)), mode_(mode), step_(0), nsteps_(0), format_(nullptr) {
-
-    auto info = file_open_info::parse(path_, format);
+/// Open the file at `path` with the given `mode`, using the `format` string
+/// given to the trajectory constructor to find the format and compression.
+static std::unique_ptr<Format> open_format(const std::string& path, File::Mode mode, const std::string& format) {
+    auto info = file_open_info::parse(path, format);
     format_creator_t format_creator;
     if (info.format != "") {
         format_creator = FormatFactory::get().name(info.format);
@@ -89,26 +102,69 @@ Trajectory::Trajectory(std::string path, char mode, const std::string& format)
     } else {
         throw file_error(
             "file at '{}' does not have an extension, provide a format name to read it",
-            path_
+            path
         );
     }
 
-    format_ = format_creator(path_, char_to_file_mode(mode), info.compression);
+    return format_creator(path, mode, info.compression);
+}
+
+Trajectory::Trajectory(std::string path, char mode, const std::string& format)
+    : path_(std::move(path)), mode_(mode), step_(0), nsteps_(0), format_(nullptr) {
+
+    format_ = open_format(path_, char_to_file_mode(mode), format);
+
+    auto reopen_path = path_;
+    reopen_ = [reopen_path, format]() {
+        return open_format(reopen_path, File::READ, format);
+    };
 
-    if (mode == 'r' || mode == 'a') {
+    // When reading, the number of steps is only computed if needed, so
+    // that formats can find the steps in the file lazily
+    if (mode == 'a') {
         nsteps_ = format_->nsteps();
     }
 }
 
+Trajectory::Trajectory(std::string path, std::unique_ptr<Format> format, std::function<std::unique_ptr<Format>()> reopen)
+    : path_(std::move(path)), mode_('r'), reopen_(std::move(reopen)), step_(0), nsteps_(0), format_(std::move(format)) {}
+
+Trajectory Trajectory::concatenate(const std::vector<std::string>& paths, const std::string& format, bool skip_duplicates) {
+    auto all_paths = std::vector<std::string>();
+    for (auto& pattern: paths) {
+        auto expanded = expand_wildcards(pattern);
+        if (expanded.empty()) {
+            throw file_error("could not find any file matching '{}'", pattern);
+        }
+        for (auto& path: expanded) {
+            if (!std::ifstream(path)) {
+                throw file_error("could not open the file at '{}'", path);
+            }
+            all_paths.emplace_back(std::move(path));
+        }
+    }
+    if (all_paths.empty()) {
+        throw file_error("can not create a concatenated trajectory without any file");
+    }
+
+    auto opener = [format](const std::string& path) {
+        return open_format(path, File::READ, format);
+    };
+    auto reopen = [all_paths, opener, skip_duplicates]() -> std::unique_ptr<Format> {
+        return std::unique_ptr<Format>(new ConcatenatedFormat(all_paths, opener, skip_duplicates));
+    };
+    return Trajectory(all_paths[0], reopen(), reopen);
+}
+
 Trajectory::~Trajectory() = default;
 Trajectory::Trajectory(Trajectory&&) = default;
 Trajectory& Trajectory::operator=(Trajectory&&) = default;
 
 void Trajectory::pre_read(size_t step) {
-    if (step >= nsteps_) {
+    if (!has_step(step)) {
         throw file_error(
             "can not read file '{}' at step {}: maximal step is {}",
-            path_, step, nsteps_ - 1
+            path_, step, nsteps() - 1
         );
     }
     if (!(mode_ == File::READ || mode_ == File::APPEND)) {
@@ -121,18 +177,51 @@ void Trajectory::pre_read(size_t step) {
 void Trajectory::post_read(Frame& frame) {
     frame.set_step(step_);
 
-    if (custom_topology_) {
+    if (!atom_subset_.empty() && !format_subset_) {
+        keep_atoms(frame, atom_subset_);
+    }
+
+    if (subset_topology_) {
+        frame.set_topology(*subset_topology_);
+    } else if (custom_topology_) {
         frame.set_topology(*custom_topology_);
+    } else if (fixed_topology_) {
+        frame.set_topology(*fixed_topology_);
     } else {
         for (auto& atom: frame) {
             atom.set_type(Configuration::rename(atom.type()));
         }
+        // the references used by the format and to rename the atoms are no
+        // longer used, copies of the frame can share the atoms
+        frame.forget_atom_references();
+        if (positions_only_) {
+            fixed_topology_ = frame.topology();
+            update_positions_only();
+        }
     }
     if (custom_cell_) {
         frame.set_cell(*custom_cell_);
     }
 }
 
+void Trajectory::clear_frame(Frame& frame) const {
+    // the format reads the atoms in the subset, or all the atoms when the
+    // subset is taken in `post_read`
+    if (format_positions_only_ && (atom_subset_.empty() || format_subset_)) {
+        if (subset_topology_) {
+            frame.reset(*subset_topology_);
+            return;
+        } else if (custom_topology_) {
+            frame.reset(*custom_topology_);
+            return;
+        } else if (fixed_topology_) {
+            frame.reset(*fixed_topology_);
+            return;
+        }
+    }
+    frame.clear();
+}
+
 void Trajectory::check_opened() const {
     if (!format_) {
         throw file_error("can not use a closed trajectory");
@@ -141,31 +230,261 @@ void Trajectory::check_opened() const {
 
 size_t Trajectory::nsteps() const  {
     check_opened();
+    if (mode_ == File::READ) {
+        return format_->nsteps();
+    }
     return nsteps_;
 }
 
+bool Trajectory::has_step(size_t step) const {
+    if (mode_ == File::READ) {
+        return format_->has_step(step);
+    }
+    return step < nsteps_;
+}
+
 Frame Trajectory::read() {
+    Frame frame;
+    read(frame);
+    return frame;
+}
+
+void Trajectory::read(Frame& frame) {
     check_opened();
     pre_read(step_);
 
-    Frame frame;
+    clear_frame(frame);
     format_->read(frame);
     post_read(frame);
 
     step_++;
-    return frame;
 }
 
 Frame Trajectory::read_step(const size_t step) {
+    Frame frame;
+    read_step(step, frame);
+    return frame;
+}
+
+void Trajectory::read_step(const size_t step, Frame& frame) {
     check_opened();
     pre_read(step);
 
-    Frame frame;
+    clear_frame(frame);
     step_ = step;
     format_->read_step(step_, frame);
 
     post_read(frame);
-    return frame;
+}
+
+std::vector<Frame> Trajectory::read_steps(const std::vector<size_t>& steps) {
+    check_opened();
+    for (auto step: steps) {
+        pre_read(step);
+    }
+
+    auto frames = std::vector<Frame>(steps.size());
+    auto threads = std::min(io_threads(), steps.size());
+    // Only text formats are read in parallel, since other formats use
+    // libraries which might not be thread safe
+    auto text_format = dynamic_cast<TextFormat*>(format_.get());
+    if (threads <= 1 || text_format == nullptr || mode_ != File::READ) {
+        for (size_t i = 0; i < steps.size(); i++) {
+            read_step(steps[i], frames[i]);
+        }
+        return frames;
+    }
+
+    // Each thread reads a contiguous range of the sorted steps, to keep the
+    // reads in each file as sequential as possible
+    auto order = std::vector<size_t>(steps.size());
+    for (size_t i = 0; i < order.size(); i++) {
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [&steps](size_t i, size_t j) {
+        return steps[i] < steps[j];
+    });
+
+    // Clones are created in this thread, since they share data with this
+    // trajectory
+    auto workers = std::vector<Trajectory>();
+    workers.reserve(threads);
+    for (size_t thread = 0; thread < threads; thread++) {
+        workers.emplace_back(clone());
+    }
+
+    parallel_for(threads, threads, [&](size_t thread) {
+        auto begin = thread * order.size() / threads;
+        auto end = (thread + 1) * order.size() / threads;
+
+        auto& worker = workers[thread];
+        for (auto i = begin; i < end; i++) {
+            worker.read_step(steps[order[i]], frames[order[i]]);
+        }
+    });
+
+    return frames;
+}
+
+std::vector<Frame> Trajectory::read_steps(size_t start, size_t stop, size_t stride) {
+    check_opened();
+    if (stride == 0) {
+        throw error("the stride for reading steps can not be 0");
+    }
+
+    if (start >= stop) {
+        return {};
+    }
+    // check the last step before creating the list of steps, which could be
+    // very large if `stop` is larger than the number of steps
+    pre_read(start + (stop - 1 - start) / stride * stride);
+
+    auto steps = std::vector<size_t>();
+    for (auto step = start; step < stop; step += stride) {
+        steps.push_back(step);
+        if (stop - step <= stride) {
+            break;
+        }
+    }
+    return read_steps(steps);
+}
+
+FrameRange Trajectory::read_range(size_t start, size_t stop, size_t stride) {
+    check_opened();
+    if (stride == 0) {
+        throw error("the stride for reading steps can not be 0");
+    }
+    return FrameRange(*this, start, stop, stride);
+}
+
+FrameRange::FrameRange(Trajectory& trajectory, size_t start, size_t stop, size_t stride):
+    trajectory_(&trajectory), next_(start), stop_(stop), stride_(stride) {}
+
+bool FrameRange::read_next() {
+    trajectory_->check_opened();
+    if (next_ >= stop_ || !trajectory_->has_step(next_)) {
+        return false;
+    }
+
+    trajectory_->read_step(next_, current_);
+    if (stop_ - next_ > stride_) {
+        next_ += stride_;
+    } else {
+        next_ = stop_;
+    }
+    return true;
+}
+
+FrameRange::iterator FrameRange::begin() {
+    auto it = iterator(this);
+    return ++it;
+}
+
+FrameRange::iterator& FrameRange::iterator::operator++() {
+    if (range_ != nullptr && !range_->read_next()) {
+        range_ = nullptr;
+    }
+    return *this;
+}
+
+PrefetchedFrames Trajectory::frames(size_t prefetch) {
+    check_opened();
+    if (!(mode_ == File::READ || mode_ == File::APPEND)) {
+        throw file_error(
+            "the file at '{}' was not openened in read or append mode", path_
+        );
+    }
+    return PrefetchedFrames(*this, prefetch);
+}
+
+void Trajectory::check_read_mode(const char* action) const {
+    if (mode_ != File::READ) {
+        throw file_error(
+            "can not {} at '{}': it was not opened in read mode", action, path_
+        );
+    }
+}
+
+std::unique_ptr<Format> Trajectory::reopen_format() const {
+    auto format = reopen_();
+    format->reuse_steps(*format_);
+    return format;
+}
+
+Trajectory Trajectory::clone() const {
+    check_opened();
+    check_read_mode("clone the trajectory");
+
+    auto trajectory = Trajectory(path_, reopen_format(), reopen_);
+    trajectory.custom_topology_ = custom_topology_;
+    trajectory.custom_cell_ = custom_cell_;
+    trajectory.set_atom_subset(atom_subset_);
+    trajectory.positions_only_ = positions_only_;
+    trajectory.fixed_topology_ = fixed_topology_;
+    trajectory.update_positions_only();
+    return trajectory;
+}
+
+FrameMetadata Trajectory::read_metadata(size_t step) {
+    check_opened();
+    check_read_mode("read metadata from the trajectory");
+    if (!has_step(step)) {
+        throw file_error(
+            "can not read metadata from file '{}' at step {}: maximal step is {}",
+            path_, step, nsteps() - 1
+        );
+    }
+
+    if (!metadata_format_) {
+        metadata_format_ = reopen_format();
+    }
+
+    FrameMetadata metadata;
+    metadata_format_->read_metadata(step, metadata);
+    metadata.step = step;
+    if (custom_cell_) {
+        metadata.cell = *custom_cell_;
+    }
+    return metadata;
+}
+
+std::vector<FrameMetadata> Trajectory::scan_metadata() {
+    check_opened();
+    check_read_mode("read metadata from the trajectory");
+
+    auto metadata = std::vector<FrameMetadata>(nsteps());
+    auto threads = std::min(io_threads(), metadata.size());
+    // Only text formats are read in parallel, since other formats use
+    // libraries which might not be thread safe
+    auto text_format = dynamic_cast<TextFormat*>(format_.get());
+    if (threads <= 1 || text_format == nullptr) {
+        for (size_t step = 0; step < metadata.size(); step++) {
+            metadata[step] = read_metadata(step);
+        }
+        return metadata;
+    }
+
+    // All the steps are already known after calling `nsteps`, and shared
+    // with the formats used by the workers
+    auto workers = std::vector<std::unique_ptr<Format>>();
+    workers.reserve(threads);
+    for (size_t thread = 0; thread < threads; thread++) {
+        workers.emplace_back(reopen_format());
+    }
+
+    parallel_for(threads, threads, [&](size_t thread) {
+        auto begin = thread * metadata.size() / threads;
+        auto end = (thread + 1) * metadata.size() / threads;
+        for (auto step = begin; step < end; step++) {
+            workers[thread]->read_metadata(step, metadata[step]);
+            metadata[step].step = step;
+            if (custom_cell_) {
+                metadata[step].cell = *custom_cell_;
+            }
+        }
+    });
+
+    return metadata;
 }
 
 void Trajectory::write(const Frame& frame) {
@@ -195,7 +514,11 @@ void Trajectory::write(const Frame& frame) {
 
 void Trajectory::set_topology(const Topology& topology) {
     check_opened();
+    if (!atom_subset_.empty()) {
+        subset_topology_ = topology_subset(topology, atom_subset_);
+    }
     custom_topology_ = topology;
+    update_positions_only();
 }
 
 void Trajectory::set_topology(const std::string& filename, const std::string& format) {
@@ -212,13 +535,83 @@ void Trajectory::set_cell(const UnitCell& cell) {
     custom_cell_ = cell;
 }
 
+void Trajectory::set_atom_subset(std::vector<size_t> indices) {
+    check_opened();
+    if (mode_ == File::WRITE) {
+        throw file_error(
+            "can not set an atom subset for the file at '{}': it was opened in write mode", path_
+        );
+    }
+
+    std::sort(indices.begin(), indices.end());
+    indices.erase(std::unique(indices.begin(), indices.end()), indices.end());
+
+    optional<Topology> subset_topology = nullopt;
+    if (custom_topology_ && !indices.empty()) {
+        subset_topology = topology_subset(*custom_topology_, indices);
+    }
+
+    format_subset_ = format_->set_atom_subset(indices) && !indices.empty();
+    atom_subset_ = std::move(indices);
+    subset_topology_ = std::move(subset_topology);
+
+    // the topology of the next frame will contain different atoms
+    fixed_topology_ = nullopt;
+    update_positions_only();
+}
+
+void Trajectory::set_positions_only(bool positions_only) {
+    check_opened();
+    positions_only_ = positions_only;
+    fixed_topology_ = nullopt;
+    update_positions_only();
+}
+
+void Trajectory::update_positions_only() {
+    auto topology_known = custom_topology_ || fixed_topology_;
+    format_positions_only_ = format_->set_positions_only(positions_only_ && topology_known);
+}
+
+void Trajectory::set_atom_subset(const Selection& selection) {
+    check_opened();
+    if (mode_ == File::WRITE) {
+        throw file_error(
+            "can not set an atom subset for the file at '{}': it was opened in write mode", path_
+        );
+    }
+
+    // read the first step with a separate format, to keep the current state
+    // of this trajectory
+    auto format = reopen_();
+    if (!format->has_step(0)) {
+        throw file_error(
+            "can not evaluate the selection for atom subset: the file at '{}' does not contain any step", path_
+        );
+    }
+    Frame frame;
+    format->read_step(0, frame);
+    if (custom_topology_) {
+        frame.set_topology(*custom_topology_);
+    } else {
+        for (auto& atom: frame) {
+            atom.set_type(Configuration::rename(atom.type()));
+        }
+    }
+    if (custom_cell_) {
+        frame.set_cell(*custom_cell_);
+    }
+
+    set_atom_subset(selection.list(frame));
+}
+
 bool Trajectory::done() const {
     check_opened();
-    return step_ >= nsteps_;
+    return !has_step(step_);
 }
 
 void Trajectory::close() {
     check_opened();
     // delete the format and set the pointer to nullptr
     format_.reset();
+    metadata_format_.reset();
 }
@@ -0,0 +1,85 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+
+#include <cassert>
+#include <cstdint>
+#include <algorithm>
+
+#include "chemfiles/atom_subset.hpp"
+#include "chemfiles/Frame.hpp"
+#include "chemfiles/Topology.hpp"
+#include "chemfiles/ErrorFmt.hpp"
+using namespace chemfiles;
+
+static void check_indices(const std::vector<size_t>& indices, size_t natoms) {
+    assert(std::is_sorted(indices.begin(), indices.end()));
+    if (!indices.empty() && indices.back() >= natoms) {
+        throw out_of_bounds(
+            "out of bounds atomic index in atom subset: we have {} atoms, "
+            "but the index is {}", natoms, indices.back()
+        );
+    }
+}
+
+Topology chemfiles::topology_subset(const Topology& topology, const std::vector<size_t>& indices) {
+    check_indices(indices, topology.size());
+
+    // new index of all atoms, SIZE_MAX for atoms outside of the subset
+    auto new_indices = std::vector<size_t>(topology.size(), SIZE_MAX);
+    auto subset = Topology();
+    subset.reserve(indices.size());
+    for (auto i: indices) {
+        new_indices[i] = subset.size();
+        subset.add_atom(topology[i]);
+    }
+
+    auto& bonds = topology.bonds();
+    auto& bond_orders = topology.bond_orders();
+    for (size_t i = 0; i < bonds.size(); i++) {
+        auto first = new_indices[bonds[i][0]];
+        auto second = new_indices[bonds[i][1]];
+        if (first != SIZE_MAX && second != SIZE_MAX) {
+            subset.add_bond(first, second, bond_orders[i]);
+        }
+    }
+
+    for (auto& residue: topology.residues()) {
+        auto id = residue.id();
+        auto new_residue = id ? Residue(residue.name(), *id) : Residue(residue.name());
+        for (auto i: residue) {
+            if (new_indices[i] != SIZE_MAX) {
+                new_residue.add_atom(new_indices[i]);
+            }
+        }
+        if (new_residue.size() == 0) {
+            continue;
+        }
+        for (auto& property: residue.properties()) {
+            new_residue.set(property.first, property.second);
+        }
+        subset.add_residue(std::move(new_residue));
+    }
+
+    return subset;
+}
+
+void chemfiles::keep_atoms(Frame& frame, const std::vector<size_t>& indices) {
+    check_indices(indices, frame.size());
+    auto topology = topology_subset(frame.topology(), indices);
+
+    // indices are sorted, so indices[i] >= i and we can move the data in place
+    auto positions = frame.positions();
+    for (size_t i = 0; i < indices.size(); i++) {
+        positions[i] = positions[indices[i]];
+    }
+    auto velocities = frame.velocities();
+    if (velocities) {
+        for (size_t i = 0; i < indices.size(); i++) {
+            (*velocities)[i] = (*velocities)[indices[i]];
+        }
+    }
+
+    frame.clear_bonds();
+    frame.resize(indices.size());
+    frame.set_topology(std::move(topology));
+}
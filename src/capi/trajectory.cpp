@@ -58,6 +58,22 @@ extern "C" chfl_status chfl_trajectory_read(CHFL_TRAJECTORY* const trajectory, C
     )
 }
 
+extern "C" chfl_status chfl_trajectory_read_into(CHFL_TRAJECTORY* const trajectory, CHFL_FRAME* const frame) {
+    CHECK_POINTER(trajectory);
+    CHECK_POINTER(frame);
+    CHFL_ERROR_CATCH(
+        trajectory->read(*frame);
+    )
+}
+
+extern "C" chfl_status chfl_trajectory_read_step_into(CHFL_TRAJECTORY* const trajectory, uint64_t step, CHFL_FRAME* const frame) {
+    CHECK_POINTER(trajectory);
+    CHECK_POINTER(frame);
+    CHFL_ERROR_CATCH(
+        trajectory->read_step(checked_cast(step), *frame);
+    )
+}
+
 extern "C" chfl_status chfl_trajectory_write(CHFL_TRAJECTORY* const trajectory, const CHFL_FRAME* const frame) {
     CHECK_POINTER(trajectory);
     CHECK_POINTER(frame);
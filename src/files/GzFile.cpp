@@ -1,54 +1,393 @@
 // Chemfiles, a modern library for chemistry file reading and writing
 // Copyright (C) Guillaume Fraux and contributors -- BSD license
 
+#include <cstring>
+#include <cerrno>
+#include <climits>
+#include <algorithm>
+
 #include "chemfiles/files/GzFile.hpp"
 #include "chemfiles/ErrorFmt.hpp"
+#include "chemfiles/warnings.hpp"
+#include "chemfiles/threads.hpp"
+#include "chemfiles/mutex.hpp"
+#include "chemfiles/misc.hpp"
+#include "chemfiles/utils.hpp"
 using namespace chemfiles;
 
+/// Size of the deflate window, i.e. the maximal distance for back-references
+/// in the compressed data.
+static const size_t WINDOW_SIZE = 32768;
+/// Minimal size of the buffers used for reading and writing
+static const size_t MIN_BUFFER_SIZE = 4096;
+/// Default size of the members when compressing in parallel
+static const size_t DEFAULT_MEMBER_SIZE = 1024 * 1024;
+/// Members are ended even without a step boundary once they contain this many
+/// times the requested size, to limit memory use with large steps or files
+/// written without step boundaries.
+static const size_t MAX_MEMBER_SIZE_FACTOR = 4;
+
+static mutex<gz_compression_options> GZ_COMPRESSION = {{1, 7, 0}};
+
+void chemfiles::set_gz_compression(size_t threads, unsigned level, size_t block_size) {
+    if (level > 9) {
+        throw error("invalid gzip compression level {}, it should be between 0 and 9", level);
+    }
+    auto guard = GZ_COMPRESSION.lock();
+    *guard = {threads, static_cast<int>(level), block_size};
+}
+
+gz_compression_options chemfiles::gz_compression() {
+    auto guard = GZ_COMPRESSION.lock();
+    return *guard;
+}
 
-gzstreambuf::gzstreambuf(size_t buffer_size): buffer_(buffer_size) {
-    auto end = &buffer_.back() + 1;
-    setg(end, end, end);
+constexpr uint64_t gzstreambuf::CHECKPOINT_SPAN;
 
-    auto begin = &buffer_.front();
-    setp(begin, end - 1);
+static void check(int status, const z_stream& stream) {
+    if (status == Z_OK || status == Z_STREAM_END || status == Z_BUF_ERROR) {
+        return;
+    }
+
+    auto message = stream.msg != nullptr ? stream.msg : "unknown error";
+    if (status == Z_MEM_ERROR) {
+        throw file_error("gzstreambuf: memory allocation failed ({})", message);
+    } else if (status == Z_DATA_ERROR) {
+        throw file_error("gzstreambuf: compressed file is corrupted ({})", message);
+    } else {
+        throw file_error("gzstreambuf: zlib error (code: {}, {})", status, message);
+    }
+}
+
+gzstreambuf::gzstreambuf(size_t buffer_size):
+    out_buffer_(std::max(buffer_size, MIN_BUFFER_SIZE)),
+    in_buffer_(std::max(buffer_size, MIN_BUFFER_SIZE)),
+    window_(std::max(buffer_size, WINDOW_SIZE)),
+    checkpoints_(std::make_shared<mutex<std::vector<checkpoint>>>())
+{
+    std::memset(&stream_, 0, sizeof(stream_));
+    stream_.zalloc = Z_NULL;
+    stream_.zfree = Z_NULL;
+    stream_.opaque = Z_NULL;
+
+    setg(window_.data(), window_.data(), window_.data());
+    setp(&out_buffer_.front(), &out_buffer_.back());
 }
 
 gzstreambuf::~gzstreambuf() {
-    sync();
-    gzclose(file_);
-    file_ = nullptr;
+    if (reading_) {
+        if (file_ != nullptr) {
+            inflateEnd(&stream_);
+            std::fclose(file_);
+        }
+    } else if (member_writer_) {
+        if (file_ != nullptr) {
+            try {
+                sync();
+                if (!member_data_.empty()) {
+                    finished_members_.emplace_back(std::move(member_data_));
+                }
+                compress_members();
+            } catch (const std::exception& e) {
+                warning("error while finishing gzip file: {}", e.what());
+            }
+            std::fclose(file_);
+        }
+    } else {
+        sync();
+        gzclose(gz_file_);
+    }
 }
 
 void gzstreambuf::open(const std::string& path, const std::string& mode) {
     if (is_open()) {
         throw file_error("can not open a gz file twice with the same gzstreambuf");
     }
-    file_ = gzopen(path.c_str(), mode.c_str());
+
+    if (!mode.empty() && mode[0] == 'r') {
+        reading_ = true;
+        file_ = std::fopen(path.c_str(), "rb");
+        if (file_ == nullptr) {
+            return;
+        }
+
+        stream_.next_in = in_buffer_.data();
+        stream_.avail_in = 0;
+        // 15 + 16 means a 32 KiB window, with gzip header and trailer
+        auto status = inflateInit2(&stream_, 15 + 16);
+        if (status != Z_OK) {
+            std::fclose(file_);
+            file_ = nullptr;
+            check(status, stream_);
+        }
+
+        // Look at the first bytes to find what kind of data this file
+        // contains. Like gzread, files which are not compressed are read
+        // directly, and zlib streams are decompressed as well.
+        replenish_compressed_buffer();
+        auto header = stream_.next_in;
+        if (stream_.avail_in == 0 || (stream_.avail_in >= 2 && header[0] == 0x1f && header[1] == 0x8b)) {
+            input_ = input_kind::gzip;
+        } else if (stream_.avail_in >= 2 && (header[0] & 0x0f) == Z_DEFLATED && (header[0] >> 4) <= 7 && (header[0] * 256 + header[1]) % 31 == 0) {
+            input_ = input_kind::zlib;
+        } else {
+            input_ = input_kind::plain;
+        }
+    } else {
+        reading_ = false;
+        auto options = gz_compression();
+        level_ = options.level;
+        if (options.threads != 1 || options.block_size != 0) {
+            member_writer_ = true;
+            write_threads_ = options.threads == 0 ? io_threads() : options.threads;
+            block_size_ = options.block_size == 0 ? DEFAULT_MEMBER_SIZE : options.block_size;
+            file_ = std::fopen(path.c_str(), "wb");
+            return;
+        }
+
+        gz_file_ = gzopen(path.c_str(), (mode + std::to_string(level_)).c_str());
+        if (gz_file_ != nullptr) {
+            // use the same buffer size inside zlib, instead of the 8 KiB
+            // default. This must be called before any write.
+            auto size = std::min<size_t>(out_buffer_.size(), UINT_MAX / 2);
+            gzbuffer(gz_file_, static_cast<unsigned>(size));
+        }
+    }
+}
+
+bool gzstreambuf::is_open() const {
+    return file_ != nullptr || gz_file_ != nullptr;
 }
 
 gzstreambuf::int_type gzstreambuf::underflow() {
-    if (gptr() && (gptr() < egptr())) {
+    if (!reading_ || file_ == nullptr) {
+        return traits_type::eof();
+    }
+
+    if (gptr() < egptr()) {
         return traits_type::to_int_type(*gptr());
     }
 
-    if (!is_open()) {
-        return traits_type::eof();
+    if (finished_ && !in_member_ && stream_.avail_in == 0) {
+        // We reached the end of the file before, but more gzip members might
+        // have been written to it since then
+        std::clearerr(file_);
+        finished_ = false;
     }
 
-    auto bytes = gzread(file_, &buffer_[0], static_cast<unsigned>(buffer_.size()));
-    if (bytes <= 0) {
-        setg(&buffer_[0], &buffer_[0], &buffer_[0]);
-        return traits_type::eof();
+    while (!finished_) {
+        auto produced = inflate_chunk();
+        if (produced == 0) {
+            continue;
+        }
+
+        auto end = window_.data() + window_used_;
+        auto begin = end - produced;
+        auto discard = static_cast<size_t>(std::min<uint64_t>(discard_amount_, produced));
+        discard_amount_ -= discard;
+
+        setg(begin, begin + discard, end);
+        if (gptr() < egptr()) {
+            return traits_type::to_int_type(*gptr());
+        }
+    }
+
+    return traits_type::eof();
+}
+
+size_t gzstreambuf::inflate_chunk() {
+    if (!in_member_) {
+        start_member();
+        if (finished_) {
+            return 0;
+        }
+    }
+
+    if (stream_.avail_in == 0) {
+        replenish_compressed_buffer();
+        if (stream_.avail_in == 0) {
+            if (input_ == input_kind::plain) {
+                in_member_ = false;
+                finished_ = true;
+                return 0;
+            }
+            throw file_error("gzstreambuf: compressed file is truncated");
+        }
+    }
+
+    if (window_used_ == window_.size()) {
+        window_used_ = 0;
+    }
+    auto available = window_.size() - window_used_;
+
+    if (input_ == input_kind::plain) {
+        auto count = std::min<size_t>(available, stream_.avail_in);
+        std::memcpy(window_.data() + window_used_, stream_.next_in, count);
+        stream_.next_in += count;
+        stream_.avail_in -= static_cast<uInt>(count);
+        window_used_ += count;
+        decoded_position_ += count;
+        // uncompressed data can be read again from any position
+        add_checkpoint(true);
+        return count;
+    }
+
+    stream_.next_out = reinterpret_cast<Bytef*>(window_.data() + window_used_);
+    stream_.avail_out = static_cast<uInt>(available);
+
+    // Z_BLOCK stops at the end of each deflate block, where we can create a
+    // checkpoint
+    auto status = inflate(&stream_, Z_BLOCK);
+    if (status == Z_DATA_ERROR && !raw_ && stream_.total_out == 0 && decoded_position_ != 0) {
+        // Trailing garbage after the last gzip member, ignore it like gzread
+        finished_ = true;
+        return 0;
+    }
+    check(status, stream_);
+
+    auto produced = available - stream_.avail_out;
+    window_used_ += produced;
+    decoded_position_ += produced;
+
+    if (status == Z_STREAM_END) {
+        in_member_ = false;
+    } else if ((stream_.data_type & 128) && !(stream_.data_type & 64)) {
+        // We are at the end of a block, which is not the last block of
+        // this member
+        add_checkpoint(false);
+    }
+
+    return produced;
+}
+
+void gzstreambuf::start_member() {
+    if (input_ == input_kind::zlib && compressed_position_ - stream_.avail_in != 0) {
+        // zlib data contains a single stream, ignore anything after it
+        raw_ = false;
+        finished_ = true;
+        return;
+    }
+
+    if (raw_) {
+        // raw inflate does not consume the trailer of gzip members (CRC32
+        // and uncompressed size), skip it here.
+        size_t skip = 8;
+        while (skip > 0) {
+            if (stream_.avail_in == 0) {
+                replenish_compressed_buffer();
+                if (stream_.avail_in == 0) {
+                    throw file_error("gzstreambuf: compressed file is truncated");
+                }
+            }
+            auto count = std::min<size_t>(skip, stream_.avail_in);
+            stream_.next_in += count;
+            stream_.avail_in -= static_cast<uInt>(count);
+            skip -= count;
+        }
+        raw_ = false;
+    }
+
+    if (stream_.avail_in == 0) {
+        replenish_compressed_buffer();
+        if (stream_.avail_in == 0) {
+            finished_ = true;
+            return;
+        }
+    }
+
+    in_member_ = true;
+    if (input_ == input_kind::gzip) {
+        check(inflateReset2(&stream_, 15 + 16), stream_);
+    } else if (input_ == input_kind::zlib) {
+        // 15 means a 32 KiB window, with zlib header and trailer
+        check(inflateReset2(&stream_, 15), stream_);
+    }
+    add_checkpoint(true);
+}
+
+void gzstreambuf::replenish_compressed_buffer() {
+    auto count = std::fread(in_buffer_.data(), 1, in_buffer_.size(), file_);
+    if (count == 0 && std::ferror(file_)) {
+        throw file_error("gzstreambuf: error while reading compressed file: {}", std::strerror(errno));
+    }
+    stream_.next_in = in_buffer_.data();
+    stream_.avail_in = static_cast<uInt>(count);
+    compressed_position_ += count;
+}
+
+void gzstreambuf::add_checkpoint(bool member_start) {
+    auto checkpoints = checkpoints_->lock();
+    // Other buffers sharing the checkpoints might have added some after the
+    // current position already
+    auto next = std::upper_bound(checkpoints->begin(), checkpoints->end(), decoded_position_,
+        [](uint64_t value, const checkpoint& point) {
+            return value < point.uncompressed;
+        }
+    );
+    if (next != checkpoints->begin() && decoded_position_ < (next - 1)->uncompressed + CHECKPOINT_SPAN) {
+        return;
     }
 
-    setg(&buffer_[0], &buffer_[0], &buffer_[0] + bytes);
+    checkpoint point;
+    point.uncompressed = decoded_position_;
+    point.compressed = compressed_position_ - stream_.avail_in;
+    point.bits = 0;
+    if (!member_start) {
+        point.bits = stream_.data_type & 7;
+        // Copy the last 32 KiB of data from the circular buffer
+        point.window.resize(WINDOW_SIZE);
+        auto size = window_.size();
+        auto first = (window_used_ + size - WINDOW_SIZE) % size;
+        auto tail = std::min(WINDOW_SIZE, size - first);
+        std::memcpy(point.window.data(), window_.data() + first, tail);
+        std::memcpy(point.window.data() + tail, window_.data(), WINDOW_SIZE - tail);
+    }
 
-    return traits_type::to_int_type(*gptr());
+    checkpoints->insert(next, std::move(point));
+}
+
+void gzstreambuf::restore(const checkpoint& point) {
+    auto offset = point.compressed - (point.bits != 0 ? 1 : 0);
+    if (!seek_file(file_, offset)) {
+        throw file_error("gzstreambuf: could not seek in compressed file");
+    }
+
+    compressed_position_ = offset;
+    stream_.next_in = in_buffer_.data();
+    stream_.avail_in = 0;
+    decoded_position_ = point.uncompressed;
+    finished_ = false;
+
+    if (point.window.empty()) {
+        // start of a gzip member, the header will be read again
+        in_member_ = false;
+        raw_ = false;
+        return;
+    }
+
+    // -15 means raw deflate data with a 32 KiB window
+    check(inflateReset2(&stream_, -15), stream_);
+    if (point.bits != 0) {
+        auto byte = std::fgetc(file_);
+        if (byte == EOF) {
+            throw file_error("gzstreambuf: could not read compressed file");
+        }
+        compressed_position_ += 1;
+        check(inflatePrime(&stream_, point.bits, byte >> (8 - point.bits)), stream_);
+    }
+    check(inflateSetDictionary(&stream_, point.window.data(), static_cast<uInt>(WINDOW_SIZE)), stream_);
+
+    // Keep the circular buffer in sync with the dictionary, for the next
+    // checkpoints
+    std::memcpy(window_.data(), point.window.data(), WINDOW_SIZE);
+    window_used_ = WINDOW_SIZE;
+
+    in_member_ = true;
+    raw_ = true;
 }
 
 int gzstreambuf::overflow(int ch) {
-    if (ch != traits_type::eof()) {
+    if (ch != traits_type::eof() && !reading_) {
         *pptr() = traits_type::to_char_type(ch);
         pbump(1);
         if (sync() == 0) {
@@ -60,9 +399,17 @@ int gzstreambuf::overflow(int ch) {
 }
 
 int gzstreambuf::sync() {
+    if (reading_) {
+        return std::streambuf::sync();
+    }
+
+    if (member_writer_) {
+        return sync_members();
+    }
+
     auto bytes = static_cast<int>(pptr() - pbase());
     if (bytes > 0) {
-        if (gzwrite(file_, pbase(), static_cast<unsigned>(bytes)) != bytes) {
+        if (gzwrite(gz_file_, pbase(), static_cast<unsigned>(bytes)) != bytes) {
             return EOF;
         }
         pbump(-bytes);
@@ -71,46 +418,205 @@ int gzstreambuf::sync() {
     return 0;
 }
 
-bool gzstreambuf::is_open() const {
-    return file_ != nullptr;
-}
+gzstreambuf::pos_type gzstreambuf::seekoff(off_type offset, std::ios_base::seekdir way, std::ios_base::openmode which) {
+    if (way == std::ios_base::end) {
+        throw file_error("zlib doesn't support SEEK_END in gzseek().");
+    }
+
+    if (!reading_) {
+        if (sync() == EOF) {
+            return pos_type(off_type(-1));
+        }
+
+        if (member_writer_) {
+            // only tellp is supported when writing members in parallel
+            if (offset == 0 && way == std::ios_base::cur) {
+                // count data already compressed, finished members waiting
+                // for compression, the current member and the put area
+                auto position = written_ + member_data_.size() + static_cast<uint64_t>(pptr() - pbase());
+                for (const auto& member: finished_members_) {
+                    position += member.size();
+                }
+                return pos_type(static_cast<off_type>(position));
+            }
+            return pos_type(off_type(-1));
+        }
+
+        // fast return path for tellp
+        if (offset == 0 && way == std::ios_base::cur) {
+            return pos_type(gztell(gz_file_));
+        }
 
-std::streampos gzstreambuf::seekoff(std::streamoff offset, std::ios_base::seekdir way, std::ios_base::openmode mode) {
-    if (sync() == EOF) {
-        return {EOF};
+        auto position = gzseek(gz_file_, static_cast<z_off_t>(offset), way == std::ios_base::cur ? SEEK_CUR : SEEK_SET);
+        if (position == -1) {
+            throw file_error("internal error in gzseek");
+        }
+        return pos_type(position);
     }
 
+    auto current = static_cast<off_type>(decoded_position_ + discard_amount_) - (egptr() - gptr());
     // fast return path for tellg
     if (offset == 0 && way == std::ios_base::cur) {
-        return gztell(file_) - (egptr() - gptr());
+        return pos_type(current);
     }
 
-    int dir = -1;
     if (way == std::ios_base::cur) {
-        dir = SEEK_CUR;
-    } else if (way == std::ios_base::beg) {
-        dir = SEEK_SET;
-    } else if (way == std::ios_base::end) {
-        throw file_error("zlib doesn't support SEEK_END in gzseek().");
+        offset += current;
     }
+    return seekpos(pos_type(offset), which);
+}
 
-    auto position = gzseek(file_, static_cast<z_off_t>(offset), dir);
-    if (position == -1) {
-        throw file_error("internal error in gzseek");
-    };
+gzstreambuf::pos_type gzstreambuf::seekpos(pos_type position, std::ios_base::openmode which) {
+    if (!reading_) {
+        return seekoff(off_type(position), std::ios_base::beg, which);
+    }
 
-    if (mode & std::ios_base::in) {
-        setg(&buffer_.back() + 1, &buffer_.back() + 1, &buffer_.back() + 1);
-    } else if (mode & std::ios_base::out) {
-        setp(&buffer_.front(), &buffer_.back());
+    if (file_ == nullptr || off_type(position) < 0) {
+        return pos_type(off_type(-1));
     }
+    auto target = static_cast<uint64_t>(off_type(position));
 
+    // Is the target inside the current get area?
+    auto area_begin = decoded_position_ - static_cast<uint64_t>(egptr() - eback());
+    if (discard_amount_ == 0 && target >= area_begin && target <= decoded_position_) {
+        setg(eback(), egptr() - (decoded_position_ - target), egptr());
+        return position;
+    }
+
+    // Find the last checkpoint before the target, and restart from it if
+    // this is better than continuing decompression from the current position
+    auto can_continue = target >= decoded_position_;
+    auto checkpoints = checkpoints_->lock();
+    auto next = std::upper_bound(checkpoints->begin(), checkpoints->end(), target,
+        [](uint64_t value, const checkpoint& point) {
+            return value < point.uncompressed;
+        }
+    );
+    if (next != checkpoints->begin()) {
+        const auto& point = *(next - 1);
+        if (!can_continue || point.uncompressed > decoded_position_) {
+            restore(point);
+        }
+    } else if (!can_continue) {
+        // This should not happen, since the start of the file is always
+        // the first checkpoint
+        throw file_error("gzstreambuf: missing checkpoint at the start of the file");
+    }
+
+    discard_amount_ = target - decoded_position_;
+    setg(window_.data(), window_.data(), window_.data());
     return position;
 }
 
 
-GzFile::GzFile(std::string path, File::Mode mode)
-    : TextFile(std::move(path), mode, File::GZIP, &buffer_), buffer_() {
+void gzstreambuf::step_boundary() {
+    if (reading_ || !member_writer_) {
+        return;
+    }
+    sync_members();
+    if (member_data_.size() >= block_size_) {
+        end_member();
+    }
+}
+
+void gzstreambuf::share_checkpoints(const gzstreambuf& other) {
+    checkpoints_ = other.checkpoints_;
+}
+
+int gzstreambuf::sync_members() {
+    if (file_ == nullptr) {
+        return EOF;
+    }
+
+    member_data_.insert(member_data_.end(), pbase(), pptr());
+    pbump(-static_cast<int>(pptr() - pbase()));
+
+    auto max_size = MAX_MEMBER_SIZE_FACTOR * block_size_;
+    if (member_data_.size() >= max_size) {
+        // split the data in members of `max_size` bytes, keeping the
+        // remaining data in the current member
+        auto data = std::move(member_data_);
+        auto begin = data.begin();
+        while (static_cast<size_t>(data.end() - begin) >= max_size) {
+            member_data_.assign(begin, begin + static_cast<std::ptrdiff_t>(max_size));
+            end_member();
+            begin += static_cast<std::ptrdiff_t>(max_size);
+        }
+        member_data_.assign(begin, data.end());
+    }
+
+    return 0;
+}
+
+void gzstreambuf::end_member() {
+    finished_members_.emplace_back(std::move(member_data_));
+    member_data_.clear();
+    member_data_.reserve(block_size_);
+    if (finished_members_.size() >= write_threads_) {
+        compress_members();
+    }
+}
+
+/// Compress `data` as a full gzip member with the given compression `level`
+static std::vector<unsigned char> compress_member(const std::vector<char>& data, int level) {
+    z_stream stream;
+    std::memset(&stream, 0, sizeof(stream));
+    // 15 + 16 means a 32 KiB window, with gzip header and trailer
+    check(deflateInit2(&stream, level, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY), stream);
+
+    auto output = std::vector<unsigned char>(deflateBound(&stream, static_cast<uLong>(data.size())));
+    size_t in_position = 0;
+    size_t out_position = 0;
+    auto status = Z_OK;
+    while (status != Z_STREAM_END) {
+        if (out_position == output.size()) {
+            output.resize(2 * output.size());
+        }
+
+        // zlib uses unsigned int for sizes, so very large data must be
+        // given in multiple parts
+        auto in_size = std::min<size_t>(data.size() - in_position, UINT_MAX);
+        auto out_size = std::min<size_t>(output.size() - out_position, UINT_MAX);
+        stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data() + in_position));
+        stream.avail_in = static_cast<uInt>(in_size);
+        stream.next_out = output.data() + out_position;
+        stream.avail_out = static_cast<uInt>(out_size);
+
+        auto flush = in_position + in_size == data.size() ? Z_FINISH : Z_NO_FLUSH;
+        status = deflate(&stream, flush);
+        in_position += in_size - stream.avail_in;
+        out_position += out_size - stream.avail_out;
+
+        if (status != Z_OK && status != Z_STREAM_END && status != Z_BUF_ERROR) {
+            deflateEnd(&stream);
+            check(status, stream);
+        }
+    }
+    deflateEnd(&stream);
+
+    output.resize(out_position);
+    return output;
+}
+
+void gzstreambuf::compress_members() {
+    auto count = finished_members_.size();
+    auto compressed = std::vector<std::vector<unsigned char>>(count);
+    parallel_for(count, write_threads_, [&](size_t i) {
+        compressed[i] = compress_member(finished_members_[i], level_);
+    });
+
+    for (size_t i = 0; i < count; i++) {
+        auto size = compressed[i].size();
+        if (std::fwrite(compressed[i].data(), 1, size, file_) != size) {
+            throw file_error("gzstreambuf: could not write compressed data: {}", std::strerror(errno));
+        }
+        written_ += finished_members_[i].size();
+    }
+    finished_members_.clear();
+}
+
+GzFile::GzFile(std::string path, File::Mode mode, size_t buffer_size)
+    : TextFile(std::move(path), mode, File::GZIP, &buffer_), buffer_(buffer_size) {
 
     std::string openmode;
     switch (mode) {
@@ -118,7 +624,7 @@ GzFile::GzFile(std::string path, File::Mode mode)
         openmode = "rb";
         break;
     case File::WRITE:
-        openmode = "wb7";
+        openmode = "wb";
         break;
     case File::APPEND:
         throw file_error("appending (open mode 'a') is not supported with gziped files");
@@ -129,3 +635,14 @@ GzFile::GzFile(std::string path, File::Mode mode)
         throw file_error("could not open the file at {}", this->path());
     }
 }
+
+void GzFile::step_boundary() {
+    buffer_.step_boundary();
+}
+
+void GzFile::share_index(TextFile& other) {
+    auto gz_file = dynamic_cast<GzFile*>(&other);
+    if (gz_file != nullptr) {
+        buffer_.share_checkpoints(gz_file->buffer_);
+    }
+}
@@ -0,0 +1,226 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+
+#include <cstring>
+#include <cerrno>
+#include <cassert>
+#include <cstdint>
+#include <algorithm>
+
+#ifdef CHEMFILES_WINDOWS
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "chemfiles/files/MmapFile.hpp"
+#include "chemfiles/ErrorFmt.hpp"
+using namespace chemfiles;
+
+mmapstreambuf::~mmapstreambuf() {
+    unmap();
+#ifdef CHEMFILES_WINDOWS
+    if (file_ != nullptr) {
+        CloseHandle(file_);
+    }
+#else
+    if (fd_ != -1) {
+        ::close(fd_);
+    }
+#endif
+}
+
+void mmapstreambuf::open(const std::string& path) {
+    if (is_open()) {
+        throw file_error("can not open a file twice with the same mmapstreambuf");
+    }
+    path_ = path;
+
+#ifdef CHEMFILES_WINDOWS
+    // Allow other processes to write to the file while we are reading it
+    auto file = CreateFileA(
+        path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr,
+        OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr
+    );
+    if (file == INVALID_HANDLE_VALUE) {
+        throw file_error("could not open the file at {}", path);
+    }
+    file_ = file;
+#else
+    fd_ = ::open(path.c_str(), O_RDONLY);
+    if (fd_ == -1) {
+        throw file_error("could not open the file at {}: {}", path, std::strerror(errno));
+    }
+
+    struct stat status;
+    if (fstat(fd_, &status) != 0 || !S_ISREG(status.st_mode)) {
+        throw file_error("the file at {} is not a regular file", path);
+    }
+#endif
+
+    map();
+    opened_ = true;
+    setg(data_, data_, data_ + size_);
+}
+
+bool mmapstreambuf::is_open() const {
+    return opened_;
+}
+
+size_t mmapstreambuf::file_size() const {
+    unsigned long long size = 0;
+#ifdef CHEMFILES_WINDOWS
+    LARGE_INTEGER length;
+    if (!GetFileSizeEx(file_, &length)) {
+        throw file_error("could not get the size of the file at {}", path_);
+    }
+    size = static_cast<unsigned long long>(length.QuadPart);
+#else
+    struct stat status;
+    if (fstat(fd_, &status) != 0) {
+        throw file_error("could not get the size of the file at {}: {}", path_, std::strerror(errno));
+    }
+    size = static_cast<unsigned long long>(status.st_size);
+#endif
+    if (size > SIZE_MAX) {
+        throw file_error("the file at {} is too big to be memory-mapped", path_);
+    }
+    return static_cast<size_t>(size);
+}
+
+void mmapstreambuf::map() {
+    assert(data_ == nullptr);
+    auto size = file_size();
+    if (size == 0) {
+        return;
+    }
+
+#ifdef CHEMFILES_WINDOWS
+    mapping_ = CreateFileMappingA(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping_ == nullptr) {
+        throw file_error("could not memory-map the file at {}", path_);
+    }
+    data_ = static_cast<char*>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, size));
+    if (data_ == nullptr) {
+        throw file_error("could not memory-map the file at {}", path_);
+    }
+#else
+    auto data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd_, 0);
+    if (data == MAP_FAILED) {
+        throw file_error("could not memory-map the file at {}: {}", path_, std::strerror(errno));
+    }
+    data_ = static_cast<char*>(data);
+#ifdef POSIX_MADV_SEQUENTIAL
+    posix_madvise(data_, size, POSIX_MADV_SEQUENTIAL);
+#endif
+#endif
+    size_ = size;
+}
+
+void mmapstreambuf::unmap() {
+#ifdef CHEMFILES_WINDOWS
+    if (data_ != nullptr) {
+        UnmapViewOfFile(data_);
+    }
+    if (mapping_ != nullptr) {
+        CloseHandle(mapping_);
+        mapping_ = nullptr;
+    }
+#else
+    if (data_ != nullptr) {
+        munmap(data_, size_);
+    }
+#endif
+    data_ = nullptr;
+    size_ = 0;
+}
+
+void mmapstreambuf::update_size() {
+    if (!opened_ || file_size() == size_) {
+        return;
+    }
+
+    auto position = static_cast<size_t>(gptr() - eback());
+    unmap();
+    setg(nullptr, nullptr, nullptr);
+    map();
+    position = std::min(position, size_);
+    setg(data_, data_ + position, data_ + size_);
+}
+
+mmapstreambuf::pos_type mmapstreambuf::seekoff(off_type offset, std::ios_base::seekdir way, std::ios_base::openmode which) {
+    off_type position = 0;
+    if (way == std::ios_base::beg) {
+        position = offset;
+    } else if (way == std::ios_base::cur) {
+        position = (gptr() - eback()) + offset;
+        if (offset == 0) {
+            // fast return path for tellg, without looking at the file size
+            return pos_type(position);
+        }
+    } else if (way == std::ios_base::end) {
+        update_size();
+        position = static_cast<off_type>(size_) + offset;
+    }
+    return seekpos(pos_type(position), which);
+}
+
+mmapstreambuf::pos_type mmapstreambuf::seekpos(pos_type position, std::ios_base::openmode which) {
+    if (!(which & std::ios_base::in)) {
+        return pos_type(off_type(-1));
+    }
+
+    // The file might have been modified since we mapped it. Pointers inside
+    // the mapping are not expected to stay valid after a seek.
+    update_size();
+
+    auto offset = static_cast<off_type>(position);
+    if (offset < 0 || offset > static_cast<off_type>(size_)) {
+        return pos_type(off_type(-1));
+    }
+    setg(eback(), eback() + offset, egptr());
+    return position;
+}
+
+MmapFile::MmapFile(std::string path, File::Mode mode)
+    : TextFile(std::move(path), mode, File::DEFAULT, &buffer_) {
+    if (mode != File::READ) {
+        throw file_error("memory-mapped files can only be opened in read mode ('r')");
+    }
+    buffer_.open(this->path());
+}
+
+void MmapFile::get_line(std::string& string) {
+    auto line = get_line_view(string);
+    string.assign(line.begin(), line.end());
+}
+
+string_view MmapFile::get_line_view(std::string&) {
+    auto begin = buffer_.current();
+    auto end = buffer_.end();
+    if (begin == end) {
+        this->setstate(std::ios::eofbit);
+        return {};
+    }
+
+    // Find the first end of line, handling old Mac OS line endings (\r only)
+    // and Windows ones (\r\n) in the same pass
+    auto eol = std::find_if(begin, end, [](char c) {
+        return c == '\n' || c == '\r';
+    });
+
+    auto line = string_view(begin, static_cast<size_t>(eol - begin));
+
+    auto consumed = line.size();
+    if (eol != end) {
+        consumed += 1;
+        if (*eol == '\r' && eol + 1 != end && *(eol + 1) == '\n') {
+            consumed += 1;
+        }
+    }
+    buffer_.advance(consumed);
+    return line;
+}
@@ -3,13 +3,48 @@
 
 #include <cstring>
 #include <cassert>
-#include <limits>
+#include <algorithm>
 
 #include "chemfiles/ErrorFmt.hpp"
 #include "chemfiles/warnings.hpp"
+#include "chemfiles/threads.hpp"
+#include "chemfiles/mutex.hpp"
+#include "chemfiles/misc.hpp"
+#include "chemfiles/utils.hpp"
 #include "chemfiles/files/XzFile.hpp"
 using namespace chemfiles;
 
+/// Minimal size of the buffers used for reading and writing
+static const size_t MIN_BUFFER_SIZE = 4096;
+/// Maximal size of the buffer for decompressed data when reading sequentially.
+/// The buffer grows up to this size to make seeking back to the start of
+/// large steps cheap.
+static const uint64_t MAX_OUT_BUFFER_SIZE = 32 * 1024 * 1024;
+/// Maximal amount of decompressed data to produce at once when decompressing
+/// blocks in parallel. Files with larger blocks are decompressed sequentially.
+static const uint64_t MAX_PARALLEL_SIZE = 256 * 1024 * 1024;
+/// Default size of the blocks when compressing in parallel
+static const size_t DEFAULT_BLOCK_SIZE = 4 * 1024 * 1024;
+/// Blocks are ended even without a step boundary once they contain this many
+/// times the requested block size, to limit memory use with large steps or
+/// files written without step boundaries.
+static const size_t MAX_BLOCK_SIZE_FACTOR = 4;
+
+static mutex<xz_compression_options> XZ_COMPRESSION = {{1, 6, 0}};
+
+void chemfiles::set_xz_compression(size_t threads, unsigned preset, size_t block_size) {
+    if (preset > 9) {
+        throw error("invalid xz compression preset {}, it should be between 0 and 9", preset);
+    }
+    auto guard = XZ_COMPRESSION.lock();
+    *guard = {threads, static_cast<uint32_t>(preset), block_size};
+}
+
+xz_compression_options chemfiles::xz_compression() {
+    auto guard = XZ_COMPRESSION.lock();
+    return *guard;
+}
+
 static void check(lzma_ret code) {
     switch (code) {
     case LZMA_OK:
@@ -35,8 +70,8 @@ static void check(lzma_ret code) {
 }
 
 xzstreambuf::xzstreambuf(size_t buffer_size):
-    in_buffer_(buffer_size),
-    out_buffer_(buffer_size)
+    in_buffer_(std::max(buffer_size, MIN_BUFFER_SIZE)),
+    out_buffer_(std::max(buffer_size, MIN_BUFFER_SIZE))
 {
     stream_.next_in = nullptr;
     stream_.avail_in = 0;
@@ -53,7 +88,11 @@ xzstreambuf::xzstreambuf(size_t buffer_size):
 xzstreambuf::~xzstreambuf() {
     if (!reading_) {
         action_ = LZMA_FINISH;
-        sync();
+        try {
+            sync();
+        } catch (const std::exception& e) {
+            warning("error while finishing xz file: {}", e.what());
+        }
     }
 
     if (index_) {
@@ -75,10 +114,18 @@ void xzstreambuf::open(const std::string& path, const std::string& mode) {
         throw file_error("can not open an xz file twice with the same xzstreambuf");
     }
     file_ = fopen(path.c_str(), mode.c_str());
+    if (file_ == nullptr) {
+        return;
+    }
 
     if (mode == "wb") {
         reading_ = false;
-        check(lzma_easy_encoder(&stream_, 6, LZMA_CHECK_CRC64));
+        auto options = xz_compression();
+        if (options.threads == 1 && options.block_size == 0) {
+            check(lzma_easy_encoder(&stream_, options.preset, LZMA_CHECK_CRC64));
+        } else {
+            init_block_writer(options);
+        }
     } else if (mode == "rb") {
         reading_ = true;
         std::array<uint8_t, LZMA_STREAM_HEADER_SIZE> buffer = {{0}};
@@ -88,6 +135,8 @@ void xzstreambuf::open(const std::string& path, const std::string& mode) {
         lzma_stream_flags flags;
         check(lzma_stream_header_decode(&flags, buffer.data()));
         check_ = flags.check;
+
+        init_parallel();
     } else {
         throw file_error("xzstreambuf: unrecognized open mode: '{}'", mode);
     }
@@ -113,6 +162,10 @@ int xzstreambuf::sync() {
         return std::streambuf::sync();
     }
 
+    if (block_writer_) {
+        return sync_blocks();
+    }
+
     auto bytes = pptr() - pbase();
     stream_.next_in = reinterpret_cast<uint8_t*>(pbase());
     stream_.avail_in = static_cast<size_t>(bytes);
@@ -159,10 +212,25 @@ int xzstreambuf::underflow() {
         return traits_type::to_int_type(*gptr());
     }
 
+    if (parallel_) {
+        return underflow_parallel();
+    }
+
+    if (stream_end_) {
+        return traits_type::eof();
+    }
+
     lzma_ret status = LZMA_OK;
     while (gptr() >= egptr() && status == LZMA_OK) {
-        stream_.next_out = reinterpret_cast<uint8_t*>(out_buffer_.data());
-        stream_.avail_out = out_buffer_.size();
+        // Keep the end of the previous data at the start of the buffer, so
+        // that seeking back to the start of the current step stays inside
+        // the get area instead of decompressing the block again
+        auto keep = std::min(static_cast<size_t>(egptr() - eback()), out_buffer_.size() / 4);
+        if (keep != 0) {
+            std::memmove(out_buffer_.data(), egptr() - keep, keep);
+        }
+        stream_.next_out = reinterpret_cast<uint8_t*>(out_buffer_.data() + keep);
+        stream_.avail_out = out_buffer_.size() - keep;
 
         if (at_block_boundary_) {
             std::vector<std::uint8_t> header_buf(LZMA_BLOCK_HEADER_SIZE_MAX);
@@ -177,6 +245,7 @@ int xzstreambuf::underflow() {
             if (header_buf[0] == 0x00) {
                 // Index indicator found
                 status = LZMA_STREAM_END;
+                stream_end_ = true;
             } else {
                 // free previously allocated filters in the block. We can use
                 // `free` directly because no allocator is passed to any lzma
@@ -228,7 +297,7 @@ int xzstreambuf::underflow() {
         }
 
         auto start = out_buffer_.data();
-        setg(start, start, start + (out_buffer_.size() - stream_.avail_out));
+        setg(start, start + keep, start + (out_buffer_.size() - stream_.avail_out));
         decoded_position_ += static_cast<uint64_t>(egptr() - gptr());
 
         if (discard_amount_ > 0) {
@@ -254,7 +323,9 @@ int xzstreambuf::underflow() {
 xzstreambuf::pos_type xzstreambuf::seekoff(std::streambuf::off_type offset,
                                            std::ios_base::seekdir way,
                                            std::ios_base::openmode which) {
-    auto position = pos_type(off_type(decoded_position_) - (egptr() - gptr()));
+    // discard_amount_ is only non-zero right after a seek, when the get area
+    // is empty
+    auto position = pos_type(off_type(decoded_position_ + discard_amount_) - (egptr() - gptr()));
     auto current_position = position;
 
     // Fast return path for tellg
@@ -291,32 +362,84 @@ xzstreambuf::pos_type xzstreambuf::seekpos(std::streambuf::pos_type position,
         return EOF;
     }
 
+    if (parallel_) {
+        return seekpos_parallel(position);
+    }
+
     if (!index_) {
-        if (!init_index()) {
+        // reading the index moves in the file, go back where we were to be
+        // able to continue decompression
+        auto current = tell_file(file_);
+        if (!current || !init_index() || !seek_file(file_, *current)) {
             return EOF;
         }
     }
 
+    auto target = static_cast<uint64_t>(off_type(position));
+    auto uncompressed_size = lzma_index_uncompressed_size(index_);
+    if (target > uncompressed_size) {
+        return EOF;
+    }
+
+    // Is the target inside the current get area?
+    auto area_begin = decoded_position_ - static_cast<uint64_t>(egptr() - eback());
+    if (discard_amount_ == 0 && target >= area_begin && target <= decoded_position_) {
+        setg(eback(), egptr() - (decoded_position_ - target), egptr());
+        return position;
+    }
+
     lzma_index_iter iter;
     lzma_index_iter_init(&iter, index_);
+    if (target > decoded_position_ && target < uncompressed_size) {
+        // Is the target ahead of the current position, in a block we
+        // already started to decompress? Then continue decompression up to
+        // the target instead of starting the block again.
+        if (!lzma_index_iter_locate(&iter, target) && iter.block.uncompressed_file_offset <= decoded_position_) {
+            discard_amount_ = target - decoded_position_;
+            auto end = &out_buffer_.back() + 1;
+            setg(end, end, end);
+            return position;
+        }
+        lzma_index_iter_init(&iter, index_);
+    }
 
-    // Returns true on failure.
-    if (lzma_index_iter_locate(&iter, static_cast<uint64_t>(off_type(position)))) {
-        return EOF;
+    if (target < area_begin) {
+        // We are going back a bit before the data kept in the get area, grow
+        // the buffer to keep enough data to avoid this next time
+        auto needed = static_cast<size_t>(std::min<uint64_t>(4 * (decoded_position_ - target), MAX_OUT_BUFFER_SIZE));
+        if (needed > out_buffer_.size()) {
+            out_buffer_.resize(needed);
+            auto end = &out_buffer_.back() + 1;
+            setg(end, end, end);
+        }
     }
 
-    long seek_amount = 0;
-    if (iter.block.compressed_file_offset > std::numeric_limits<long>::max()) {
-        seek_amount = std::numeric_limits<long>::max();
+    stream_end_ = false;
+    if (target == uncompressed_size) {
+        // Seeking to the end of the file: go right after the last block,
+        // where underflow will find the stream index and stop
+        uint64_t index_offset = LZMA_STREAM_HEADER_SIZE;
+        if (uncompressed_size != 0 && !lzma_index_iter_locate(&iter, uncompressed_size - 1)) {
+            index_offset = iter.block.compressed_file_offset + iter.block.total_size;
+        }
+        if (!seek_file(file_, index_offset)) {
+            return EOF;
+        }
+        decoded_position_ = uncompressed_size;
+        discard_amount_ = 0;
     } else {
-        seek_amount = static_cast<long>(iter.block.compressed_file_offset);
-    }
-    if (fseek(file_, seek_amount, SEEK_SET)) {
-        return EOF;
-    }
+        // Returns true on failure.
+        if (lzma_index_iter_locate(&iter, target)) {
+            return EOF;
+        }
 
-    decoded_position_ = iter.block.uncompressed_file_offset;
-    discard_amount_ = static_cast<uint64_t>(off_type(position)) - decoded_position_;
+        if (!seek_file(file_, iter.block.compressed_file_offset)) {
+            return EOF;
+        }
+
+        decoded_position_ = iter.block.uncompressed_file_offset;
+        discard_amount_ = target - decoded_position_;
+    }
 
     at_block_boundary_ = true;
     stream_.next_in = nullptr;
@@ -360,11 +483,337 @@ bool xzstreambuf::init_index() {
     return res == LZMA_OK;
 }
 
+void xzstreambuf::init_parallel() {
+    if (io_threads() > 1 && init_index()) {
+        auto valid = true;
+        // The index only describes the last stream in the file, check that
+        // there is a single one by comparing the sizes
+        if (std::fseek(file_, 0, SEEK_END) == 0) {
+            auto size = tell_file(file_);
+            valid = size && *size == lzma_index_file_size(index_);
+        } else {
+            valid = false;
+        }
+
+        auto blocks = std::vector<block_info>();
+        lzma_index_iter iter;
+        lzma_index_iter_init(&iter, index_);
+        while (valid && !lzma_index_iter_next(&iter, LZMA_INDEX_ITER_NONEMPTY_BLOCK)) {
+            if (iter.block.uncompressed_size > MAX_PARALLEL_SIZE) {
+                valid = false;
+            }
+            blocks.push_back({
+                iter.block.compressed_file_offset,
+                iter.block.total_size,
+                iter.block.uncompressed_file_offset,
+                iter.block.uncompressed_size,
+            });
+        }
+
+        if (valid && blocks.size() > 1) {
+            parallel_ = true;
+            blocks_ = std::move(blocks);
+        }
+    }
+
+    // Go back to the start of the first block for sequential decompression
+    if (std::fseek(file_, LZMA_STREAM_HEADER_SIZE, SEEK_SET)) {
+        throw file_error("xzstreambuf: could not seek in the file: {}", strerror(errno));
+    }
+}
+
+/// Decompress a single xz `block`, containing `uncompressed_size` bytes once
+/// decompressed
+static std::vector<char> decompress_block(const std::vector<uint8_t>& block, lzma_check check_type, uint64_t uncompressed_size) {
+    std::array<lzma_filter, LZMA_FILTERS_MAX + 1> filters = {{{LZMA_VLI_UNKNOWN, nullptr}}};
+    lzma_block header;
+    header.version = 0;
+    header.check = check_type;
+    header.filters = filters.data();
+    header.header_size = lzma_block_header_size_decode(block[0]);
+    if (block[0] == 0x00 || header.header_size > block.size()) {
+        throw file_error("xzstreambuf: invalid block header in compressed file");
+    }
+    check(lzma_block_header_decode(&header, nullptr, block.data()));
+
+    auto output = std::vector<char>(static_cast<size_t>(uncompressed_size));
+    size_t in_position = header.header_size;
+    size_t out_position = 0;
+    auto status = lzma_block_buffer_decode(
+        &header, nullptr,
+        block.data(), &in_position, block.size(),
+        reinterpret_cast<uint8_t*>(output.data()), &out_position, output.size()
+    );
+
+    for (size_t i = 0; i < LZMA_FILTERS_MAX; ++i) {
+        free(filters[i].options); // NOLINT: working with a C library
+    }
+
+    check(status);
+    if (out_position != output.size()) {
+        throw file_error("xzstreambuf: compressed file is corrupted (wrong block size)");
+    }
+    return output;
+}
+
+void xzstreambuf::decompress_blocks() {
+    auto threads = io_threads();
+    auto first = next_block_;
+
+    // Take as many blocks as there are threads, without using too much memory
+    size_t count = 0;
+    uint64_t total_size = 0;
+    while (first + count < blocks_.size() && count < threads) {
+        auto size = blocks_[first + count].uncompressed_size;
+        if (count != 0 && total_size + size > MAX_PARALLEL_SIZE) {
+            break;
+        }
+        total_size += size;
+        count++;
+    }
+
+    // Read the compressed data. Blocks follow each other in the file.
+    auto offset = blocks_[first].compressed_offset;
+    if (!seek_file(file_, offset)) {
+        throw file_error("xzstreambuf: could not seek in the file: {}", strerror(errno));
+    }
+    auto compressed = std::vector<std::vector<uint8_t>>(count);
+    for (size_t i = 0; i < count; i++) {
+        auto size = static_cast<size_t>(blocks_[first + i].compressed_size);
+        compressed[i].resize(size);
+        if (std::fread(compressed[i].data(), 1, size, file_) != size) {
+            throw file_error("xzstreambuf: could not read compressed data from the file");
+        }
+    }
+
+    decompressed_.clear();
+    decompressed_.resize(count);
+    next_decompressed_ = 0;
+    parallel_for(count, threads, [&](size_t i) {
+        decompressed_[i] = decompress_block(compressed[i], check_, blocks_[first + i].uncompressed_size);
+    });
+    next_block_ = first + count;
+}
+
+int xzstreambuf::underflow_parallel() {
+    while (gptr() >= egptr()) {
+        if (next_decompressed_ == decompressed_.size()) {
+            if (next_block_ == blocks_.size()) {
+                return traits_type::eof();
+            }
+            decompress_blocks();
+        }
+
+        current_block_ = std::move(decompressed_[next_decompressed_]);
+        next_decompressed_++;
+
+        auto size = current_block_.size();
+        decoded_position_ += size;
+        auto discard = static_cast<size_t>(std::min<uint64_t>(discard_amount_, size));
+        discard_amount_ -= discard;
+
+        auto start = current_block_.data();
+        setg(start, start + discard, start + size);
+    }
+
+    return traits_type::to_int_type(*gptr());
+}
+
+xzstreambuf::pos_type xzstreambuf::seekpos_parallel(pos_type position) {
+    auto target = static_cast<uint64_t>(off_type(position));
+    auto& last = blocks_.back();
+    auto uncompressed_size = last.uncompressed_offset + last.uncompressed_size;
+    if (target > uncompressed_size) {
+        return EOF;
+    } else if (target == uncompressed_size) {
+        // Seeking to the end of the file, there is nothing left to decompress
+        decompressed_.clear();
+        next_decompressed_ = 0;
+        next_block_ = blocks_.size();
+        decoded_position_ = target;
+        discard_amount_ = 0;
+        current_block_.clear();
+        setg(nullptr, nullptr, nullptr);
+        return position;
+    }
+
+    // Seeking inside the current block only moves the get area
+    auto current_start = decoded_position_ - static_cast<uint64_t>(egptr() - eback());
+    if (target >= current_start && target < decoded_position_) {
+        setg(eback(), eback() + (target - current_start), egptr());
+        return position;
+    }
+
+    auto block = std::upper_bound(blocks_.begin(), blocks_.end(), target,
+        [](uint64_t value, const block_info& info) {
+            return value < info.uncompressed_offset;
+        }
+    );
+    auto index = static_cast<size_t>(block - blocks_.begin()) - 1;
+
+    // Re-use the blocks already decompressed if possible
+    auto first_decompressed = next_block_ - decompressed_.size();
+    if (index >= first_decompressed + next_decompressed_ && index < next_block_) {
+        next_decompressed_ = index - first_decompressed;
+    } else {
+        decompressed_.clear();
+        next_decompressed_ = 0;
+        next_block_ = index;
+    }
+
+    decoded_position_ = blocks_[index].uncompressed_offset;
+    discard_amount_ = target - decoded_position_;
+    current_block_.clear();
+    setg(nullptr, nullptr, nullptr);
+
+    return position;
+}
+
+void xzstreambuf::init_block_writer(const xz_compression_options& options) {
+    block_writer_ = true;
+    write_threads_ = options.threads == 0 ? io_threads() : options.threads;
+    block_size_ = options.block_size == 0 ? DEFAULT_BLOCK_SIZE : options.block_size;
+    if (lzma_lzma_preset(&lzma_options_, options.preset)) {
+        throw file_error("xzstreambuf: invalid compression preset {}", options.preset);
+    }
+
+    index_ = lzma_index_init(nullptr);
+    if (index_ == nullptr) {
+        throw file_error("xzstreambuf: could not allocate the index");
+    }
+
+    auto flags = lzma_stream_flags();
+    flags.version = 0;
+    flags.check = LZMA_CHECK_CRC64;
+    std::array<uint8_t, LZMA_STREAM_HEADER_SIZE> header = {{0}};
+    check(lzma_stream_header_encode(&flags, header.data()));
+    if (std::fwrite(header.data(), sizeof(uint8_t), header.size(), file_) != header.size()) {
+        throw file_error("xzstreambuf: could not write the stream header: {}", strerror(errno));
+    }
+}
+
+void xzstreambuf::step_boundary() {
+    if (reading_ || !block_writer_) {
+        return;
+    }
+    sync_blocks();
+    if (block_data_.size() >= block_size_) {
+        end_block();
+    }
+}
+
+int xzstreambuf::sync_blocks() {
+    if (finished_) {
+        return 0;
+    }
+
+    block_data_.insert(block_data_.end(), pbase(), pptr());
+    pbump(-static_cast<int>(pptr() - pbase()));
+
+    auto max_size = MAX_BLOCK_SIZE_FACTOR * block_size_;
+    if (block_data_.size() >= max_size) {
+        // split the data in blocks of `max_size` bytes, keeping the remaining
+        // data in the current block
+        auto data = std::move(block_data_);
+        auto begin = data.begin();
+        while (static_cast<size_t>(data.end() - begin) >= max_size) {
+            block_data_.assign(begin, begin + static_cast<std::ptrdiff_t>(max_size));
+            end_block();
+            begin += static_cast<std::ptrdiff_t>(max_size);
+        }
+        block_data_.assign(begin, data.end());
+    }
+
+    if (action_ == LZMA_FINISH) {
+        if (!block_data_.empty()) {
+            finished_blocks_.emplace_back(std::move(block_data_));
+            block_data_.clear();
+        }
+        compress_blocks();
+        finish_blocks();
+    }
+
+    return 0;
+}
+
+void xzstreambuf::end_block() {
+    finished_blocks_.emplace_back(std::move(block_data_));
+    block_data_.clear();
+    block_data_.reserve(block_size_);
+    if (finished_blocks_.size() >= write_threads_) {
+        compress_blocks();
+    }
+}
+
+/// Compress `data` as a single xz block, using the lzma2 filter with the
+/// given `options`. The unpadded size of the block is stored in
+/// `unpadded_size`.
+static std::vector<uint8_t> compress_block(const std::vector<char>& data, lzma_options_lzma options, lzma_vli& unpadded_size) {
+    std::array<lzma_filter, 2> filters = {{
+        {LZMA_FILTER_LZMA2, &options},
+        {LZMA_VLI_UNKNOWN, nullptr},
+    }};
+    auto block = lzma_block();
+    block.version = 0;
+    block.check = LZMA_CHECK_CRC64;
+    block.filters = filters.data();
+
+    auto output = std::vector<uint8_t>(lzma_block_buffer_bound(data.size()));
+    size_t out_position = 0;
+    check(lzma_block_buffer_encode(
+        &block, nullptr,
+        reinterpret_cast<const uint8_t*>(data.data()), data.size(),
+        output.data(), &out_position, output.size()
+    ));
+    output.resize(out_position);
+
+    unpadded_size = lzma_block_unpadded_size(&block);
+    return output;
+}
+
+void xzstreambuf::compress_blocks() {
+    auto count = finished_blocks_.size();
+    auto compressed = std::vector<std::vector<uint8_t>>(count);
+    auto unpadded_sizes = std::vector<lzma_vli>(count);
+    parallel_for(count, write_threads_, [&](size_t i) {
+        compressed[i] = compress_block(finished_blocks_[i], lzma_options_, unpadded_sizes[i]);
+    });
+
+    for (size_t i = 0; i < count; i++) {
+        auto size = compressed[i].size();
+        if (std::fwrite(compressed[i].data(), sizeof(uint8_t), size, file_) != size) {
+            throw file_error("xzstreambuf: could not write compressed data: {}", strerror(errno));
+        }
+        check(lzma_index_append(index_, nullptr, unpadded_sizes[i], finished_blocks_[i].size()));
+    }
+    finished_blocks_.clear();
+}
+
+void xzstreambuf::finish_blocks() {
+    finished_ = true;
+
+    auto index_size = static_cast<size_t>(lzma_index_size(index_));
+    auto buffer = std::vector<uint8_t>(index_size + LZMA_STREAM_HEADER_SIZE);
+    size_t position = 0;
+    check(lzma_index_buffer_encode(index_, buffer.data(), &position, index_size));
+
+    auto flags = lzma_stream_flags();
+    flags.version = 0;
+    flags.check = LZMA_CHECK_CRC64;
+    flags.backward_size = index_size;
+    check(lzma_stream_footer_encode(&flags, buffer.data() + position));
+
+    if (std::fwrite(buffer.data(), sizeof(uint8_t), buffer.size(), file_) != buffer.size()) {
+        throw file_error("xzstreambuf: could not write the stream index: {}", strerror(errno));
+    }
+}
+
 bool xzstreambuf::is_open() const {
     return file_ != nullptr && !::ferror(file_);
 }
 
-XzFile::XzFile(std::string path, File::Mode mode): TextFile(std::move(path), mode, File::LZMA, &buffer_), buffer_() {
+XzFile::XzFile(std::string path, File::Mode mode, size_t buffer_size):
+    TextFile(std::move(path), mode, File::LZMA, &buffer_), buffer_(buffer_size) {
     if (mode == File::READ) {
         buffer_.open(this->path(), "rb");
     } else if (mode == File::WRITE) {
@@ -377,3 +826,7 @@ XzFile::XzFile(std::string path, File::Mode mode): TextFile(std::move(path), mod
         throw file_error("could not open the file at {}", this->path());
     }
 }
+
+void XzFile::step_boundary() {
+    buffer_.step_boundary();
+}
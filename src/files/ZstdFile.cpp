@@ -0,0 +1,368 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+
+#include <cstring>
+#include <cerrno>
+#include <algorithm>
+
+#include "chemfiles/ErrorFmt.hpp"
+#include "chemfiles/warnings.hpp"
+#include "chemfiles/mutex.hpp"
+#include "chemfiles/misc.hpp"
+#include "chemfiles/files/ZstdFile.hpp"
+using namespace chemfiles;
+
+/// Minimal size of the buffers used for reading and writing
+static const size_t MIN_BUFFER_SIZE = 4096;
+/// Default size of the frames when writing
+static const size_t DEFAULT_FRAME_SIZE = 1024 * 1024;
+/// Frames are ended even without a step boundary once they contain this many
+/// times the requested size, to keep seeking fast with large steps or files
+/// written without step boundaries.
+static const size_t MAX_FRAME_SIZE_FACTOR = 4;
+
+static mutex<zstd_compression_options> ZSTD_COMPRESSION = {{3, 0}};
+
+void chemfiles::set_zstd_compression(unsigned level, size_t frame_size) {
+    auto max_level = static_cast<unsigned>(ZSTD_maxCLevel());
+    if (level < 1 || level > max_level) {
+        throw error("invalid zstd compression level {}, it should be between 1 and {}", level, max_level);
+    }
+    auto guard = ZSTD_COMPRESSION.lock();
+    *guard = {static_cast<int>(level), frame_size};
+}
+
+zstd_compression_options chemfiles::zstd_compression() {
+    auto guard = ZSTD_COMPRESSION.lock();
+    return *guard;
+}
+
+static size_t check(size_t code) {
+    if (ZSTD_isError(code)) {
+        throw file_error("zstdstreambuf: {}", ZSTD_getErrorName(code));
+    }
+    return code;
+}
+
+zstdstreambuf::zstdstreambuf(size_t buffer_size):
+    in_buffer_(std::max(buffer_size, MIN_BUFFER_SIZE)),
+    out_buffer_(std::max(buffer_size, MIN_BUFFER_SIZE))
+{
+    auto end = out_buffer_.data() + out_buffer_.size();
+    setg(end, end, end);
+    setp(&in_buffer_.front(), &in_buffer_.back());
+}
+
+zstdstreambuf::~zstdstreambuf() {
+    if (!reading_ && file_ != nullptr) {
+        try {
+            sync();
+            flush_compressed([this](ZSTD_outBuffer* output) {
+                return ZSTD_seekable_endStream(cstream_, output);
+            });
+        } catch (const std::exception& e) {
+            warning("error while finishing zstd file: {}", e.what());
+        }
+    }
+
+    ZSTD_seekable_freeCStream(cstream_);
+    ZSTD_seekable_free(seekable_);
+    ZSTD_freeDStream(dstream_);
+    if (file_ != nullptr) {
+        std::fclose(file_);
+    }
+}
+
+void zstdstreambuf::open(const std::string& path, const std::string& mode) {
+    if (is_open()) {
+        throw file_error("can not open a zstd file twice with the same zstdstreambuf");
+    }
+    if (mode != "rb" && mode != "wb") {
+        throw file_error("zstdstreambuf: unrecognized open mode: '{}'", mode);
+    }
+
+    file_ = std::fopen(path.c_str(), mode.c_str());
+    if (file_ == nullptr) {
+        return;
+    }
+
+    if (mode == "rb") {
+        reading_ = true;
+        seekable_ = ZSTD_seekable_create();
+        if (seekable_ == nullptr) {
+            throw file_error("zstdstreambuf: memory allocation failed");
+        }
+
+        if (ZSTD_isError(ZSTD_seekable_initFile(seekable_, file_))) {
+            // This file does not contain a seek table, use standard
+            // streaming decompression instead
+            ZSTD_seekable_free(seekable_);
+            seekable_ = nullptr;
+
+            dstream_ = ZSTD_createDStream();
+            if (dstream_ == nullptr) {
+                throw file_error("zstdstreambuf: memory allocation failed");
+            }
+            restart_stream();
+        } else {
+            auto frames = ZSTD_seekable_getNumFrames(seekable_);
+            if (frames != 0) {
+                uncompressed_size_ = ZSTD_seekable_getFrameDecompressedOffset(seekable_, frames - 1) +
+                                     ZSTD_seekable_getFrameDecompressedSize(seekable_, frames - 1);
+            }
+        }
+    } else {
+        reading_ = false;
+        auto options = zstd_compression();
+        frame_size_ = options.frame_size == 0 ? DEFAULT_FRAME_SIZE : options.frame_size;
+        max_frame_size_ = std::min<size_t>(
+            MAX_FRAME_SIZE_FACTOR * frame_size_, ZSTD_SEEKABLE_MAX_FRAME_DECOMPRESSED_SIZE
+        );
+        frame_size_ = std::min(frame_size_, max_frame_size_);
+
+        cstream_ = ZSTD_seekable_createCStream();
+        if (cstream_ == nullptr) {
+            throw file_error("zstdstreambuf: memory allocation failed");
+        }
+        check(ZSTD_seekable_initCStream(
+            cstream_, options.level, 1, static_cast<unsigned>(max_frame_size_)
+        ));
+    }
+}
+
+bool zstdstreambuf::is_open() const {
+    return file_ != nullptr;
+}
+
+void zstdstreambuf::restart_stream() {
+    if (std::fseek(file_, 0, SEEK_SET)) {
+        throw file_error("zstdstreambuf: could not seek in the file: {}", std::strerror(errno));
+    }
+    check(ZSTD_initDStream(dstream_));
+    input_ = {in_buffer_.data(), 0, 0};
+    stream_status_ = 0;
+    finished_ = false;
+    decoded_position_ = 0;
+}
+
+int zstdstreambuf::underflow() {
+    if (!reading_ || file_ == nullptr) {
+        return traits_type::eof();
+    }
+
+    if (gptr() < egptr()) {
+        return traits_type::to_int_type(*gptr());
+    }
+
+    while (true) {
+        size_t produced = 0;
+        if (seekable_ != nullptr) {
+            produced = decompress_seekable();
+            if (produced == 0) {
+                return traits_type::eof();
+            }
+        } else {
+            if (finished_) {
+                return traits_type::eof();
+            }
+            produced = decompress_stream();
+        }
+
+        decoded_position_ += produced;
+        auto discard = static_cast<size_t>(std::min<uint64_t>(discard_amount_, produced));
+        discard_amount_ -= discard;
+
+        auto begin = out_buffer_.data();
+        setg(begin, begin + discard, begin + produced);
+        if (gptr() < egptr()) {
+            return traits_type::to_int_type(*gptr());
+        }
+    }
+}
+
+size_t zstdstreambuf::decompress_seekable() {
+    if (decoded_position_ >= uncompressed_size_) {
+        return 0;
+    }
+
+    auto size = static_cast<size_t>(std::min<uint64_t>(
+        out_buffer_.size(), uncompressed_size_ - decoded_position_
+    ));
+    return check(ZSTD_seekable_decompress(seekable_, out_buffer_.data(), size, decoded_position_));
+}
+
+size_t zstdstreambuf::decompress_stream() {
+    if (input_.pos == input_.size && !std::feof(file_)) {
+        auto read = std::fread(in_buffer_.data(), 1, in_buffer_.size(), file_);
+        if (std::ferror(file_)) {
+            throw file_error("zstdstreambuf: error while reading the file: {}", std::strerror(errno));
+        }
+        input_ = {in_buffer_.data(), read, 0};
+    }
+
+    auto input_done = input_.pos == input_.size && std::feof(file_);
+    if (input_done && stream_status_ == 0) {
+        // all the frames are complete. Calling the decoder again would only
+        // give us the header size of the next frame
+        finished_ = true;
+        return 0;
+    }
+
+    ZSTD_outBuffer output = {out_buffer_.data(), out_buffer_.size(), 0};
+    stream_status_ = check(ZSTD_decompressStream(dstream_, &output, &input_));
+
+    if (input_done && output.pos == 0) {
+        // the decoder is still waiting for data in the current frame
+        throw file_error("zstdstreambuf: compressed file is truncated");
+    }
+
+    return output.pos;
+}
+
+int zstdstreambuf::overflow(int ch) {
+    if (ch != traits_type::eof() && !reading_) {
+        *pptr() = traits_type::to_char_type(ch);
+        pbump(1);
+        if (sync() == 0) {
+            return ch;
+        }
+    }
+
+    return traits_type::eof();
+}
+
+int zstdstreambuf::sync() {
+    if (reading_) {
+        return std::streambuf::sync();
+    }
+
+    if (file_ == nullptr) {
+        return -1;
+    }
+
+    auto bytes = static_cast<size_t>(pptr() - pbase());
+    ZSTD_inBuffer input = {pbase(), bytes, 0};
+    while (input.pos < input.size) {
+        ZSTD_outBuffer output = {out_buffer_.data(), out_buffer_.size(), 0};
+        // this returns the remaining space in the current frame
+        auto remaining = check(ZSTD_seekable_compressStream(cstream_, &output, &input));
+        frame_bytes_ = max_frame_size_ - std::min(remaining, max_frame_size_);
+        write_compressed(output.pos);
+    }
+
+    written_ += bytes;
+    pbump(-static_cast<int>(bytes));
+    return 0;
+}
+
+void zstdstreambuf::step_boundary() {
+    if (reading_ || file_ == nullptr) {
+        return;
+    }
+
+    sync();
+    if (frame_bytes_ >= frame_size_) {
+        flush_compressed([this](ZSTD_outBuffer* output) {
+            return ZSTD_seekable_endFrame(cstream_, output);
+        });
+        frame_bytes_ = 0;
+    }
+}
+
+template <typename Function>
+void zstdstreambuf::flush_compressed(Function function) {
+    size_t remaining = 0;
+    do {
+        ZSTD_outBuffer output = {out_buffer_.data(), out_buffer_.size(), 0};
+        remaining = check(function(&output));
+        write_compressed(output.pos);
+    } while (remaining != 0);
+}
+
+void zstdstreambuf::write_compressed(size_t size) {
+    if (std::fwrite(out_buffer_.data(), 1, size, file_) != size) {
+        throw file_error("zstdstreambuf: could not write compressed data: {}", std::strerror(errno));
+    }
+}
+
+zstdstreambuf::pos_type zstdstreambuf::seekoff(off_type offset, std::ios_base::seekdir way, std::ios_base::openmode which) {
+    if (!reading_) {
+        if (sync() != 0) {
+            return pos_type(off_type(-1));
+        }
+
+        // only tellp is supported when writing
+        if (offset == 0 && way == std::ios_base::cur) {
+            return pos_type(off_type(written_));
+        }
+        return pos_type(off_type(-1));
+    }
+
+    auto current = static_cast<off_type>(decoded_position_ + discard_amount_) - (egptr() - gptr());
+    // fast return path for tellg
+    if (offset == 0 && way == std::ios_base::cur) {
+        return pos_type(current);
+    }
+
+    if (way == std::ios_base::cur) {
+        offset += current;
+    } else if (way == std::ios_base::end) {
+        if (seekable_ == nullptr) {
+            // the uncompressed size is unknown without seek table
+            return pos_type(off_type(-1));
+        }
+        offset += static_cast<off_type>(uncompressed_size_);
+    }
+    return seekpos(pos_type(offset), which);
+}
+
+zstdstreambuf::pos_type zstdstreambuf::seekpos(pos_type position, std::ios_base::openmode /*unused*/) {
+    if (!reading_ || file_ == nullptr || off_type(position) < 0) {
+        return pos_type(off_type(-1));
+    }
+    auto target = static_cast<uint64_t>(off_type(position));
+
+    // Is the target inside the current get area?
+    auto area_begin = decoded_position_ - static_cast<uint64_t>(egptr() - eback());
+    if (discard_amount_ == 0 && target >= area_begin && target <= decoded_position_) {
+        setg(eback(), egptr() - (decoded_position_ - target), egptr());
+        return position;
+    }
+
+    if (seekable_ != nullptr) {
+        // the seekable decompressor finds the right frame by itself
+        if (target > uncompressed_size_) {
+            return pos_type(off_type(-1));
+        }
+        decoded_position_ = target;
+    } else {
+        if (target < decoded_position_) {
+            restart_stream();
+        }
+        discard_amount_ = target - decoded_position_;
+    }
+
+    auto end = out_buffer_.data() + out_buffer_.size();
+    setg(end, end, end);
+    return position;
+}
+
+ZstdFile::ZstdFile(std::string path, File::Mode mode, size_t buffer_size):
+    TextFile(std::move(path), mode, File::ZSTD, &buffer_), buffer_(buffer_size)
+{
+    if (mode == File::READ) {
+        buffer_.open(this->path(), "rb");
+    } else if (mode == File::WRITE) {
+        buffer_.open(this->path(), "wb");
+    } else if (mode == File::APPEND) {
+        throw file_error("appending (open mode 'a') is not supported with zstd files");
+    }
+
+    if (!buffer_.is_open()) {
+        throw file_error("could not open the file at {}", this->path());
+    }
+}
+
+void ZstdFile::step_boundary() {
+    buffer_.step_boundary();
+}
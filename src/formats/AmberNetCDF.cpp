@@ -8,6 +8,11 @@
 #include "chemfiles/warnings.hpp"
 using namespace chemfiles;
 
+/// Maximal number of separated hyperslabs used to read an atom subset. Subsets
+/// with more runs of contiguous atoms are read with a single hyperslab going
+/// from the first to the last atom in the subset.
+static const size_t MAX_HYPERSLABS = 64;
+
 template<> FormatInfo chemfiles::format_information<AmberNetCDFFormat>() {
     return FormatInfo("Amber NetCDF").with_extension(".nc").description(
         "Amber convention for binary NetCDF molecular trajectories"
@@ -68,12 +73,36 @@ size_t AmberNetCDFFormat::nsteps() {
     return static_cast<size_t>(file_.dimension("frame"));
 }
 
+bool AmberNetCDFFormat::set_atom_subset(const std::vector<size_t>& indices) {
+    atom_subset_ = indices;
+    subset_runs_.clear();
+    for (auto i: atom_subset_) {
+        if (!subset_runs_.empty() && subset_runs_.back().first + subset_runs_.back().second == i) {
+            subset_runs_.back().second += 1;
+        } else {
+            subset_runs_.emplace_back(i, 1);
+        }
+    }
+    return true;
+}
+
 void AmberNetCDFFormat::read_step(const size_t step, Frame& frame) {
     // Set the internal step_ before further reading
     step_ = step;
-    frame.set_cell(read_cell());
+    frame.set_cell(read_cell(step_));
 
-    frame.resize(file_.dimension("atom"));
+    auto natoms = file_.dimension("atom");
+    if (!atom_subset_.empty()) {
+        if (atom_subset_.back() >= natoms) {
+            throw out_of_bounds(
+                "out of bounds atomic index in atom subset: we have {} atoms, "
+                "but the index is {}", natoms, atom_subset_.back()
+            );
+        }
+        natoms = atom_subset_.size();
+    }
+
+    frame.resize(natoms);
     read_array(frame.positions(), "coordinates");
     if (file_.variable_exists("velocities")) {
         frame.add_velocities();
@@ -86,7 +115,17 @@ void AmberNetCDFFormat::read(Frame& frame) {
     step_++;
 }
 
-UnitCell AmberNetCDFFormat::read_cell() {
+void AmberNetCDFFormat::read_metadata(size_t step, FrameMetadata& metadata) {
+    metadata.natoms = file_.dimension("atom");
+    metadata.cell = read_cell(step);
+    if (file_.variable_exists("time")) {
+        auto time = file_.variable<nc::NcFloat>("time").get({step}, {1});
+        assert(time.size() == 1);
+        metadata.time = static_cast<double>(time[0]);
+    }
+}
+
+UnitCell AmberNetCDFFormat::read_cell(size_t step) {
     if (!file_.variable_exists("cell_lengths") ||
         !file_.variable_exists("cell_angles")) {
         return {}; // No UnitCell information
@@ -100,7 +139,7 @@ UnitCell AmberNetCDFFormat::read_cell() {
     auto length_var = file_.variable<nc::NcFloat>("cell_lengths");
     auto angles_var = file_.variable<nc::NcFloat>("cell_angles");
 
-    std::vector<size_t> start{step_, 0};
+    std::vector<size_t> start{step, 0};
     std::vector<size_t> count{1, 3};
 
     auto length = length_var.get(start, count);
@@ -121,17 +160,40 @@ UnitCell AmberNetCDFFormat::read_cell() {
 
 void AmberNetCDFFormat::read_array(span<Vector3D> array, const std::string& name) {
     auto array_var = file_.variable<nc::NcFloat>(name);
-    auto natoms = file_.dimension("atom");
-    assert(array.size() == natoms);
 
-    std::vector<size_t> start{step_, 0, 0};
-    std::vector<size_t> count{1, natoms, 3};
-    auto data = array_var.get(start, count);
+    auto copy = [&array](const std::vector<float>& data, size_t first, size_t count, size_t offset) {
+        for (size_t i = 0; i < count; i++) {
+            array[first + i][0] = static_cast<double>(data[3 * (offset + i) + 0]);
+            array[first + i][1] = static_cast<double>(data[3 * (offset + i) + 1]);
+            array[first + i][2] = static_cast<double>(data[3 * (offset + i) + 2]);
+        }
+    };
 
-    for (size_t i = 0; i < natoms; i++) {
-        array[i][0] = static_cast<double>(data[3 * i + 0]);
-        array[i][1] = static_cast<double>(data[3 * i + 1]);
-        array[i][2] = static_cast<double>(data[3 * i + 2]);
+    if (atom_subset_.empty()) {
+        auto natoms = file_.dimension("atom");
+        assert(array.size() == natoms);
+
+        std::vector<size_t> start{step_, 0, 0};
+        std::vector<size_t> count{1, natoms, 3};
+        copy(array_var.get(start, count), 0, natoms, 0);
+    } else if (subset_runs_.size() <= MAX_HYPERSLABS) {
+        assert(array.size() == atom_subset_.size());
+        size_t current = 0;
+        for (auto& run: subset_runs_) {
+            std::vector<size_t> start{step_, run.first, 0};
+            std::vector<size_t> count{1, run.second, 3};
+            copy(array_var.get(start, count), current, run.second, 0);
+            current += run.second;
+        }
+    } else {
+        assert(array.size() == atom_subset_.size());
+        auto first = atom_subset_.front();
+        std::vector<size_t> start{step_, first, 0};
+        std::vector<size_t> count{1, atom_subset_.back() - first + 1, 3};
+        auto data = array_var.get(start, count);
+        for (size_t i = 0; i < atom_subset_.size(); i++) {
+            copy(data, i, 1, atom_subset_[i] - first);
+        }
     }
 }
 
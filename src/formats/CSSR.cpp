@@ -19,6 +19,14 @@ static bool is_digit(char c) {
            c == '5' || c == '6' || c == '7' || c == '8' || c == '9';
 }
 
+/// Remove the first `count` characters of `line`
+static string_view skip_columns(string_view line, size_t count) {
+    if (line.size() < count) {
+        throw format_error("line '{}' is too short for CSSR format", line);
+    }
+    return line.substr(count);
+}
+
 
 template<> FormatInfo chemfiles::format_information<CSSRFormat>() {
     return FormatInfo("CSSR").with_extension(".cssr").description(
@@ -48,33 +56,32 @@ void CSSRFormat::read_step(const size_t step, Frame& frame) {
 void CSSRFormat::read(Frame& frame) {
     // Read unit cell
     double a = 0, b = 0, c = 0;
-    scan(file_->readline(), "%*38c%lf %lf %lf", &a, &b, &c);
+    scan(skip_columns(file_->readline_view(), 38), a, b, c);
     double alpha = 0, beta = 0, gamma = 0;
-    scan(file_->readline(), "%*21c%lf %lf %lf", &alpha, &beta, &gamma);
+    scan(skip_columns(file_->readline_view(), 21), alpha, beta, gamma);
     frame.set_cell(UnitCell(a, b, c, alpha, beta, gamma));
 
     size_t natoms = 0;
     int coordinate_style = -1;
-    scan(file_->readline(), "%zu %d", &natoms, &coordinate_style);
+    scan(file_->readline_view(), natoms, coordinate_style);
     bool use_fractional = (coordinate_style == 0);
 
     // Title line
-    file_->readline();
+    file_->readline_view();
 
     frame.resize(0);
     frame.reserve(natoms);
 
     std::vector<std::vector<size_t>> connectivity(natoms);
-    for (const auto& line: file_->readlines(natoms)) {
+    for (auto line: file_->readlines_view(natoms)) {
         unsigned atom_id = 0;
-        char name[5] = {0};
+        std::string name;
         double x = 0, y = 0, z = 0;
         unsigned bonds[8] = {0};
         double charge = 0;
 
-        scan(line, "%u %4s %lf %lf %lf %u %u %u %u %u %u %u %u %lf",
-            &atom_id, &name[0], &x, &y, &z, &bonds[0], &bonds[1], &bonds[2],
-            &bonds[3], &bonds[4], &bonds[5], &bonds[6], &bonds[7], &charge
+        scan(line, atom_id, name, x, y, z, bonds[0], bonds[1], bonds[2],
+            bonds[3], bonds[4], bonds[5], bonds[6], bonds[7], charge
         );
 
         auto position = Vector3D(x, y, z);
@@ -83,7 +90,7 @@ void CSSRFormat::read(Frame& frame) {
         }
 
         // Atomic names can be created as <type><id>: O121 H22
-        auto type = std::string(name);
+        auto type = name;
         size_t type_length = 0;
         for (auto ch: type) {
             if (is_digit(ch)) {
@@ -0,0 +1,190 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+
+#include <cassert>
+#include <algorithm>
+
+#include "chemfiles/formats/Concatenated.hpp"
+#include "chemfiles/TextFormat.hpp"
+#include "chemfiles/Frame.hpp"
+#include "chemfiles/ErrorFmt.hpp"
+#include "chemfiles/threads.hpp"
+#include "chemfiles/atom_subset.hpp"
+using namespace chemfiles;
+
+ConcatenatedFormat::ConcatenatedFormat(std::vector<std::string> paths, opener_t opener, bool skip_first):
+    paths_(std::move(paths)), opener_(std::move(opener)), skip_first_(skip_first),
+    nsteps_(paths_.size()), offsets_({0})
+{
+    if (paths_.empty()) {
+        throw file_error("can not create a concatenated trajectory without any file");
+    }
+}
+
+Format& ConcatenatedFormat::open(size_t i) {
+    assert(i < paths_.size());
+    if (current_file_ != i) {
+        // close the previous file before opening the next one
+        current_.reset();
+        current_file_ = SIZE_MAX;
+        current_ = opener_(paths_[i]);
+        current_file_ = i;
+        current_subset_ = !atom_subset_.empty() && current_->set_atom_subset(atom_subset_);
+        current_positions_only_ = current_->set_positions_only(positions_only_);
+    }
+    return *current_;
+}
+
+size_t ConcatenatedFormat::count(size_t i) {
+    if (!nsteps_[i]) {
+        nsteps_[i] = open(i).nsteps();
+    }
+    auto nsteps = *nsteps_[i];
+    auto first = first_step(i);
+    return nsteps > first ? nsteps - first : 0;
+}
+
+optional<ConcatenatedFormat::location> ConcatenatedFormat::locate(size_t step) {
+    // start with the last file with a known offset before this step
+    auto it = std::upper_bound(offsets_.begin(), offsets_.end(), step);
+    assert(it != offsets_.begin());
+    auto i = static_cast<size_t>(it - offsets_.begin()) - 1;
+
+    while (i < paths_.size()) {
+        auto local = step - offsets_[i] + first_step(i);
+        if (nsteps_[i]) {
+            if (local < *nsteps_[i]) {
+                return location{i, local};
+            }
+        } else if (open(i).has_step(local)) {
+            return location{i, local};
+        }
+
+        if (i + 1 == offsets_.size()) {
+            offsets_.push_back(offsets_[i] + count(i));
+        }
+        i++;
+    }
+    return nullopt;
+}
+
+void ConcatenatedFormat::count_all() {
+    auto missing = std::vector<size_t>();
+    for (size_t i = 0; i < paths_.size(); i++) {
+        if (!nsteps_[i]) {
+            missing.push_back(i);
+        }
+    }
+
+    // Text formats can find the steps in multiple files in parallel. Other
+    // formats use libraries which might not be thread safe, so all the files
+    // are opened in this thread, and only the text formats are used by other
+    // threads. The files are opened in batches, to limit the number of files
+    // opened at the same time.
+    auto threads = std::min(io_threads(), missing.size());
+    if (threads > 1) {
+        auto batch_size = 4 * threads;
+        for (size_t start = 0; start < missing.size(); start += batch_size) {
+            auto end = std::min(start + batch_size, missing.size());
+            auto files = std::vector<size_t>();
+            auto formats = std::vector<std::unique_ptr<Format>>();
+            for (size_t k = start; k < end; k++) {
+                auto i = missing[k];
+                if (i == current_file_) {
+                    nsteps_[i] = current_->nsteps();
+                    continue;
+                }
+
+                auto format = opener_(paths_[i]);
+                if (dynamic_cast<TextFormat*>(format.get()) != nullptr) {
+                    files.push_back(i);
+                    formats.emplace_back(std::move(format));
+                } else {
+                    nsteps_[i] = format->nsteps();
+                }
+            }
+
+            auto counts = std::vector<size_t>(formats.size());
+            parallel_for(formats.size(), threads, [&](size_t k) {
+                counts[k] = formats[k]->nsteps();
+            });
+            for (size_t k = 0; k < files.size(); k++) {
+                nsteps_[files[k]] = counts[k];
+            }
+        }
+    }
+
+    while (offsets_.size() <= paths_.size()) {
+        auto i = offsets_.size() - 1;
+        offsets_.push_back(offsets_[i] + count(i));
+    }
+}
+
+size_t ConcatenatedFormat::nsteps() {
+    count_all();
+    return offsets_.back();
+}
+
+bool ConcatenatedFormat::has_step(size_t step) {
+    return static_cast<bool>(locate(step));
+}
+
+void ConcatenatedFormat::read_step(size_t step, Frame& frame) {
+    auto location = locate(step);
+    if (!location) {
+        throw format_error(
+            "can not read step {}: the concatenated files only contain {} steps",
+            step, nsteps()
+        );
+    }
+    auto& format = open(location->file);
+    if (positions_only_ && !current_positions_only_) {
+        // the frame might already contain the topology, but this format
+        // reads the full frames
+        frame.clear();
+    }
+    format.read_step(location->step, frame);
+    if (!atom_subset_.empty() && !current_subset_) {
+        // the files can use different formats, so we extract the atoms here
+        // for the formats not able to do it themselves
+        keep_atoms(frame, atom_subset_);
+    }
+    next_ = step + 1;
+}
+
+void ConcatenatedFormat::read(Frame& frame) {
+    read_step(next_, frame);
+}
+
+void ConcatenatedFormat::reuse_steps(Format& other) {
+    auto concatenated = dynamic_cast<ConcatenatedFormat*>(&other);
+    if (concatenated == nullptr || concatenated->paths_ != paths_) {
+        return;
+    }
+
+    nsteps_ = concatenated->nsteps_;
+    offsets_ = concatenated->offsets_;
+    if (concatenated->current_) {
+        open(concatenated->current_file_).reuse_steps(*concatenated->current_);
+    }
+}
+
+bool ConcatenatedFormat::set_atom_subset(const std::vector<size_t>& indices) {
+    atom_subset_ = indices;
+    current_subset_ = false;
+    if (current_) {
+        current_subset_ = current_->set_atom_subset(atom_subset_) && !atom_subset_.empty();
+    }
+    return true;
+}
+
+bool ConcatenatedFormat::set_positions_only(bool positions_only) {
+    positions_only_ = positions_only;
+    current_positions_only_ = false;
+    if (current_) {
+        current_positions_only_ = current_->set_positions_only(positions_only_);
+    }
+    // formats not able to skip the topology still produce valid frames, as
+    // long as the frames given to them are cleared first (see `read_step`)
+    return positions_only;
+}
@@ -24,109 +24,20 @@ template<> FormatInfo chemfiles::format_information<GROFormat>() {
 /// we can represen them. In case of error, use the given `context` in the error
 /// message
 static void check_values_size(const Vector3D& values, unsigned width, const std::string& context);
-/// Fast-forward the file for one step, returning `false` if the file does
-/// not contain one more step.
-static bool forward(TextFile& file);
 
 GROFormat::GROFormat(std::string path, File::Mode mode, File::Compression compression)
-    : file_(TextFile::open(std::move(path), mode, compression))
-{
-    while (!file_->eof()) {
-        auto position = file_->tellg();
-        if (!file_ || position == std::streampos(-1)) {
-            throw format_error("IO error while reading '{}' as GRO", path);
-        }
-        if (forward(*file_)) {
-            steps_positions_.push_back(position);
-        }
-    }
-    file_->rewind();
-}
+    : TextFormat(std::move(path), mode, compression, "GRO") {}
 
-size_t GROFormat::nsteps() {
-    return steps_positions_.size();
-}
-
-void GROFormat::read_step(const size_t step, Frame& frame) {
-    assert(step < steps_positions_.size());
-    file_->seekg(steps_positions_[step]);
-    read(frame);
-}
-
-void GROFormat::read(Frame& frame) {
-    size_t natoms = 0;
-    try {
-        frame.set("name", (file_->readline())); // GRO comment line;
-        natoms = parse<size_t>(file_->readline());
-    } catch (const Error& e) {
-        throw format_error("can not read next step as GRO: {}", e.what());
-    }
-
-    residues_.clear();
-    frame.add_velocities();
-    frame.reserve(natoms);
-    frame.resize(0);
-
-    for (const auto& line: file_->readlines(natoms)) {
-
-        if (line.length() < 44) {
-            throw format_error(
-                "GRO Atom line is too small: '{}'", line
-            );
-        }
-
-        size_t resid = SIZE_MAX;
-        try {
-            resid = parse<size_t>(line.substr(0, 5));
-        } catch (const Error&) {
-            // Invalid residue, we'll skip it
-        }
-        auto resname = trim(line.substr(5, 5));
-        auto name = trim(line.substr(10, 5));
-
-        // GRO files store atoms in NM, we need to convert to Angstroms
-        auto x = parse<double>(line.substr(20, 8)) * 10;
-        auto y = parse<double>(line.substr(28, 8)) * 10;
-        auto z = parse<double>(line.substr(36, 8)) * 10;
-
-        if (line.length() >= 68) {
-            auto vx = parse<double>(line.substr(44, 8)) * 10;
-            auto vy = parse<double>(line.substr(52, 8)) * 10;
-            auto vz = parse<double>(line.substr(60, 8)) * 10;
-
-            frame.add_atom(Atom(name),
-                Vector3D(x, y, z),
-                Vector3D(vx, vy, vz)
-            );
-        } else {
-            frame.add_atom(Atom(name),
-                Vector3D(x, y, z)
-            );
-        }
-
-        if (resid != SIZE_MAX) {
-            if (residues_.find(resid) == residues_.end()) {
-                Residue residue(resname, resid);
-                residue.add_atom(frame.size() - 1);
-
-                residues_.insert({resid, residue});
-            } else {
-                // Just add this atom to the residue
-                residues_.at(resid).add_atom(frame.size() - 1);
-            }
-        }
-    }
-
-    std::string box = file_->readline();
-    auto box_values = split(box, ' ');
+/// Read the unit cell from the box line of a GRO file
+static optional<UnitCell> read_box(string_view line) {
+    auto box_values = split(line, ' ');
 
     if (box_values.size() == 3) {
         auto a = parse<double>(box_values[0]) * 10;
         auto b = parse<double>(box_values[1]) * 10;
         auto c = parse<double>(box_values[2]) * 10;
 
-        auto cell = UnitCell(a, b, c);
-        frame.set_cell(cell);
+        return UnitCell(a, b, c);
     } else if (box_values.size() == 9) {
         auto v1_x = parse<double>(box_values[0]) * 10;
         auto v2_y = parse<double>(box_values[1]) * 10;
@@ -147,9 +58,91 @@ void GROFormat::read(Frame& frame) {
             0.00, v2_y, v3_y,
             0.00, 0.00, v3_z);
 
-        auto cell = UnitCell(H);
+        return UnitCell(H);
+    }
+    return nullopt;
+}
 
-        frame.set_cell(cell);
+/// Read the position and velocity of an atom in a GRO atom `line`. The
+/// velocity is set to zero if the line does not contain it.
+static void read_coordinates(string_view line, Vector3D& position, Vector3D& velocity) {
+    if (line.length() < 44) {
+        throw format_error(
+            "GRO Atom line is too small: '{}'", line
+        );
+    }
+
+    // GRO files store atoms in NM, we need to convert to Angstroms
+    position = Vector3D(
+        parse<double>(line.substr(20, 8)) * 10,
+        parse<double>(line.substr(28, 8)) * 10,
+        parse<double>(line.substr(36, 8)) * 10
+    );
+
+    if (line.length() >= 68) {
+        velocity = Vector3D(
+            parse<double>(line.substr(44, 8)) * 10,
+            parse<double>(line.substr(52, 8)) * 10,
+            parse<double>(line.substr(60, 8)) * 10
+        );
+    } else {
+        velocity = Vector3D();
+    }
+}
+
+void GROFormat::read_next(Frame& frame) {
+    size_t natoms = 0;
+    try {
+        frame.set("name", file_->readline_view().to_string()); // GRO comment line;
+        natoms = parse<size_t>(file_->readline_view());
+    } catch (const Error& e) {
+        throw format_error("can not read next step as GRO: {}", e.what());
+    }
+
+    residues_.clear();
+    frame.add_velocities();
+    if (positions_only_) {
+        frame.resize(natoms);
+        auto positions = frame.positions();
+        auto velocities = *frame.velocities();
+        size_t i = 0;
+        for (auto line: file_->readlines_view(natoms)) {
+            read_coordinates(line, positions[i], velocities[i]);
+            i++;
+        }
+    } else {
+        frame.reserve(natoms);
+        frame.resize(0);
+
+        for (auto line: file_->readlines_view(natoms)) {
+            Vector3D position;
+            Vector3D velocity;
+            read_coordinates(line, position, velocity);
+
+            // Invalid residues are skipped
+            auto resid = try_parse<size_t>(line.substr(0, 5)).value_or(SIZE_MAX);
+            auto resname = trim(line.substr(5, 5));
+            auto name = trim(line.substr(10, 5));
+
+            frame.add_atom(Atom(name.to_string()), position, velocity);
+
+            if (resid != SIZE_MAX) {
+                if (residues_.find(resid) == residues_.end()) {
+                    Residue residue(resname.to_string(), resid);
+                    residue.add_atom(frame.size() - 1);
+
+                    residues_.insert({resid, residue});
+                } else {
+                    // Just add this atom to the residue
+                    residues_.at(resid).add_atom(frame.size() - 1);
+                }
+            }
+        }
+    }
+
+    auto cell = read_box(file_->readline_view());
+    if (cell) {
+        frame.set_cell(*cell);
     }
 
     for (auto& residue: residues_) {
@@ -157,6 +150,29 @@ void GROFormat::read(Frame& frame) {
     }
 }
 
+void GROFormat::read_next_metadata(FrameMetadata& metadata) {
+    try {
+        metadata.properties.set("name", file_->readline_view().to_string());
+        metadata.natoms = parse<size_t>(file_->readline_view());
+    } catch (const Error& e) {
+        throw format_error("can not read next step as GRO: {}", e.what());
+    }
+
+    if (!file_->skip_lines(metadata.natoms)) {
+        throw format_error("not enough lines in '{}' for GRO format", file_->path());
+    }
+
+    auto cell = read_box(file_->readline_view());
+    if (cell) {
+        metadata.cell = *cell;
+    }
+}
+
+bool GROFormat::set_positions_only(bool positions_only) {
+    positions_only_ = positions_only;
+    return positions_only;
+}
+
 static std::string to_gro_index(uint64_t i) {
     if (i >= 99999) {
         warning("Too many atoms for GRO format, removing atomic id");
@@ -166,7 +182,7 @@ static std::string to_gro_index(uint64_t i) {
     }
 }
 
-void GROFormat::write(const Frame& frame) {
+void GROFormat::write_next(const Frame& frame) {
     fmt::print(*file_, "{}\n", frame.get<Property::STRING>("name").value_or("GRO File produced by chemfiles"));
     fmt::print(*file_, "{: >5d}\n", frame.size());
 
@@ -254,8 +270,6 @@ void GROFormat::write(const Frame& frame) {
             matrix[0][0], matrix[1][1], matrix[2][2], matrix[0][1], matrix[0][2], matrix[1][2]
         );
     }
-
-    steps_positions_.push_back(file_->tellg());
 }
 
 void check_values_size(const Vector3D& values, unsigned width, const std::string& context) {
@@ -269,29 +283,33 @@ void check_values_size(const Vector3D& values, unsigned width, const std::string
     }
 }
 
-bool forward(TextFile& file) {
-    if (!file) {return false;}
+optional<std::streampos> GROFormat::forward(TextFile& file) {
+    if (!file) {return nullopt;}
 
-    size_t natoms = 0;
-    try {
-        // Skip the comment line
-        file.readline();
-        natoms = parse<size_t>(file.readline());
-    } catch (const FileError&) {
+    auto position = file.tellg();
+
+    // Skip the comment line
+    auto line = file.skip_lines(1) ? file.try_readline_view() : nullopt;
+    if (!line) {
         // No more line left in the file
-        return false;
-    } catch (const Error&) {
+        return nullopt;
+    }
+
+    auto natoms = try_parse<size_t>(*line);
+    if (!natoms) {
         // We could not read an integer, so give up here
-        return false;
+        return nullopt;
     }
 
-    try {
-        file.readlines(natoms + 1);
-    } catch (const FileError&) {
+    if (!file.skip_lines(*natoms + 1)) {
         // We could not read the lines from the file
         throw format_error(
             "not enough lines in '{}' for GRO format", file.path()
         );
     }
-    return true;
+    return position;
+}
+
+scanned_steps GROFormat::scan_steps(string_view data, size_t start) {
+    return scan_steps_parallel(data, start, 1, 3);
 }
@@ -11,6 +11,7 @@
 
 #include "chemfiles/files/GzFile.hpp"
 #include "chemfiles/files/XzFile.hpp"
+#include "chemfiles/files/ZstdFile.hpp"
 
 using namespace chemfiles;
 
@@ -34,6 +35,12 @@ MMTFFormat::MMTFFormat(std::string path, File::Mode mode, File::Compression comp
             std::stringstream buffer;
             buffer << &xz_buff;
             mmtf::decodeFromBuffer(structure_, buffer.str().data(), buffer.str().size());
+        } else if (compression == File::ZSTD) {
+            zstdstreambuf zstd_buff;
+            zstd_buff.open(path, "rb");
+            std::stringstream buffer;
+            buffer << &zstd_buff;
+            mmtf::decodeFromBuffer(structure_, buffer.str().data(), buffer.str().size());
         } else { // Just in case the user specified MMTF without a proper extension
             mmtf::decodeFromFile(structure_, path);
         }
@@ -22,44 +22,18 @@ template<> FormatInfo chemfiles::format_information<MOL2Format>() {
 }
 
 /// Fast-forward the file until the tag is found.
-static std::streampos read_until(TextFile& file, const std::string& tag);
-/// Fast-forward the file for one step, returning a valid positionif the file does
-/// contain one more step or -1 if it does not.
-static std::streampos forward(TextFile& file);
-
+static optional<std::streampos> read_until(TextFile& file, const std::string& tag);
 MOL2Format::MOL2Format(std::string path, File::Mode mode, File::Compression compression)
-  : file_(TextFile::open(std::move(path), mode, compression)) {
-    while (!file_->eof()) {
-        auto position = forward(*file_);
-        if (position == std::streampos(-1)) {
-            break;
-        }
-        if (!file_) {
-            throw format_error("IO error while reading '{}' as MOL2", path);
-        }
-        steps_positions_.push_back(position);
-    }
-    file_->rewind();
-}
-
-size_t MOL2Format::nsteps() {
-    return steps_positions_.size();
-}
+    : TextFormat(std::move(path), mode, compression, "MOL2") {}
 
-void MOL2Format::read_step(const size_t step, Frame& frame) {
-    assert(step < steps_positions_.size());
-    file_->seekg(steps_positions_[step]);
-    read(frame);
-}
-
-void MOL2Format::read(Frame& frame) {
-    auto line = trim(file_->readline());
+void MOL2Format::read_next(Frame& frame) {
+    auto line = trim(file_->readline_view());
     if (line != "@<TRIPOS>MOLECULE") {
         throw format_error("Wrong starting line for a molecule in MOL2 formart: '{}'", line);
     }
 
-    frame.set("name", trim(file_->readline()) );
-    line = file_->readline();
+    frame.set("name", trim(file_->readline_view()).to_string());
+    line = file_->readline_view();
 
     const auto counts = split(line, ' ');
 
@@ -75,26 +49,24 @@ void MOL2Format::read(Frame& frame) {
     frame.reserve(natoms);
 
     // Skip a line
-    file_->readline();
+    file_->readline_view();
 
     // If charges are specified, we need to expect an addition term for each atom
-    bool charges = (trim(file_->readline()) != "NO_CHARGES");
+    bool charges = (trim(file_->readline_view()) != "NO_CHARGES");
 
     while (!file_->eof()) {
         const auto& curr_pos = file_->tellg();
-        line = trim(file_->readline());
+        line = trim(file_->readline_view());
 
         if (line == "@<TRIPOS>ATOM") {
             read_atoms(frame, natoms, charges);
         } else if (line == "@<TRIPOS>BOND") {
             read_bonds(frame, nbonds);
         } else if (line == "@<TRIPOS>CRYSIN") {
-            auto cryst = file_->readline();
+            auto cryst = file_->readline_view();
 
             double a, b, c, alpha, beta, gamma;
-            scan(cryst, " %lf %lf %lf %lf %lf %lf",
-                &a, &b, &c, &alpha, &beta, &gamma
-            );
+            scan(cryst, a, b, c, alpha, beta, gamma);
 
             frame.set_cell(UnitCell(a, b, c, alpha, beta, gamma));
         } else if (line == "@<TRIPOS>MOLECULE") {
@@ -110,28 +82,22 @@ void MOL2Format::read(Frame& frame) {
 }
 
 void MOL2Format::read_atoms(Frame& frame, size_t natoms, bool charges) {
-    auto lines = file_->readlines(natoms);
-
-    for (const auto& line : lines) {
+    for (auto line: file_->readlines_view(natoms)) {
         unsigned long id, resid;
-        char atom_name[32], sybyl_type[32], res_name[32];
+        std::string atom_name, sybyl_type, res_name;
         double x, y, z;
         double charge = 0;
 
         if (charges) {
-            scan(line, " %lu %31s %lf %lf %lf %31s %lu %31s %lf",
-                &id, &atom_name[0], &x, &y, &z, &sybyl_type[0], &resid, &res_name[0], &charge
-            );
+            scan(line, id, atom_name, x, y, z, sybyl_type, resid, res_name, charge);
         } else {
-            scan(line, " %lu %31s %lf %lf %lf %31s %lu %31s",
-                &id, &atom_name[0], &x, &y, &z, &sybyl_type[0], &resid, &res_name[0]
-            );
+            scan(line, id, atom_name, x, y, z, sybyl_type, resid, res_name);
         }
 
         std::string atom_type;
         bool is_sybyl;
 
-        if (std::string(sybyl_type).find('.') != std::string::npos || find_in_periodic_table(sybyl_type)) {
+        if (sybyl_type.find('.') != std::string::npos || find_in_periodic_table(sybyl_type)) {
             auto my_split = split(sybyl_type, '.');
             atom_type = my_split[0];
             is_sybyl = true;
@@ -169,13 +135,11 @@ void MOL2Format::read_atoms(Frame& frame, size_t natoms, bool charges) {
 }
 
 void MOL2Format::read_bonds(Frame& frame, size_t nbonds) {
-    auto lines = file_->readlines(nbonds);
-
-    for (const auto& line : lines) {
+    for (auto line: file_->readlines_view(nbonds)) {
         unsigned long id, id_1, id_2;
-        char bond_order[32] = {0};
+        string_view bond_order;
 
-        scan(line, " %lu %lu %lu %31s", &id, &id_1, &id_2, &bond_order[0]);
+        scan(line, id, id_1, id_2, bond_order);
 
         // MOL2 is 1 index-based, not 0
         --id_1;
@@ -188,19 +152,17 @@ void MOL2Format::read_bonds(Frame& frame, size_t nbonds) {
         }
 
         Bond::BondOrder bo;
-        std::string bond_order_str(bond_order);
-
-        if (bond_order_str == "1") {
+        if (bond_order == "1") {
             bo = Bond::SINGLE;
-        } else if (bond_order_str == "2") {
+        } else if (bond_order == "2") {
             bo = Bond::DOUBLE;
-        } else if (bond_order_str == "3") {
+        } else if (bond_order == "3") {
             bo = Bond::TRIPLE;
-        } else if (bond_order_str == "ar") {
+        } else if (bond_order == "ar") {
             bo = Bond::AROMATIC;
-        } else if (bond_order_str == "am") {
+        } else if (bond_order == "am") {
             bo = Bond::AMIDE;
-        } else if (bond_order_str == "du") { // du is a dummy bond
+        } else if (bond_order == "du") { // du is a dummy bond
             bo = Bond::UNKNOWN;
         } else {
             bo = Bond::UNKNOWN;
@@ -210,50 +172,61 @@ void MOL2Format::read_bonds(Frame& frame, size_t nbonds) {
     }
 }
 
-std::streampos read_until(TextFile& file, const std::string& tag) {
+optional<std::streampos> read_until(TextFile& file, const std::string& tag) {
     while (!file.eof()) {
         std::streampos pos = file.tellg();
-        if (file.readline().substr(0, tag.length()) == tag) {
+        auto line = file.try_readline_view();
+        if (!line) {
+            break;
+        }
+        if (line->substr(0, tag.length()) == tag) {
             return pos;
         }
     }
-
-    throw file_error("File ended before tag '{}' was found", tag);
+    // File ended before the tag was found
+    return nullopt;
 }
 
-std::streampos forward(TextFile& file) {
+optional<std::streampos> MOL2Format::forward(TextFile& file) {
     if (!file) {
-        return {-1};
+        return nullopt;
+    }
+
+    auto position = read_until(file, "@<TRIPOS>MOLECULE");
+    if (!position) {
+        return nullopt;
     }
-    while (!file.eof()) {
-        try {
-            std::streampos pos = read_until(file, "@<TRIPOS>MOLECULE");
-            file.readline(); // Skip a line
-            auto line = file.readline();
-
-            const auto counts = split(line, ' ');
-            auto natoms = parse<size_t>(counts[0]);
-            size_t nbonds = 0;
-            if (counts.size() >= 2) {
-                nbonds = parse<size_t>(counts[1]);
-            }
 
-            read_until(file, "@<TRIPOS>ATOM");
-            file.readlines(natoms);
+    // Skip a line
+    auto line = file.skip_lines(1) ? file.try_readline_view() : nullopt;
+    if (!line) {
+        return nullopt;
+    }
 
-            read_until(file, "@<TRIPOS>BOND");
-            file.readlines(nbonds);
+    const auto counts = split(*line, ' ');
+    if (counts.empty()) {
+        return nullopt;
+    }
+    auto natoms = try_parse<size_t>(counts[0]);
+    auto nbonds = optional<size_t>(0);
+    if (counts.size() >= 2) {
+        nbonds = try_parse<size_t>(counts[1]);
+    }
+    if (!natoms || !nbonds) {
+        return nullopt;
+    }
 
-            return pos;
-        } catch (const Error&) {
-            return {-1};
-        }
+    if (!read_until(file, "@<TRIPOS>ATOM") || !file.skip_lines(*natoms)) {
+        return nullopt;
+    }
+    if (!read_until(file, "@<TRIPOS>BOND") || !file.skip_lines(*nbonds)) {
+        return nullopt;
     }
 
-    return {-1};
+    return position;
 }
 
-void MOL2Format::write(const Frame& frame) {
+void MOL2Format::write_next(const Frame& frame) {
     fmt::print(*file_, "@<TRIPOS>MOLECULE\n");
     fmt::print(*file_, "{}\n", frame.get<Property::STRING>("name").value_or(""));
 
@@ -164,16 +164,54 @@ template <MolfileFormat F> void Molfile<F>::read(Frame& frame) {
         frame.set_topology(*topology_);
     }
     molfile_to_frame(timestep, frame);
-
-    frames_.emplace_back(std::move(frame.clone()));
+    step_++;
 }
 
 template <MolfileFormat F> void Molfile<F>::read_step(size_t step, Frame& frame) {
-    while (step >= frames_.size()) {
-        Frame new_frame;
-        this->read(new_frame);
+    if (step < step_) {
+        reopen();
+    }
+    skip_steps(step - step_);
+    this->read(frame);
+}
+
+template <MolfileFormat F> void Molfile<F>::skip_steps(size_t count) {
+    if (count == 0) {
+        return;
+    }
+
+    if (plugin_handle_->read_next_timestep) {
+        // a NULL timestep tells the plugin to skip over the step, seeking in
+        // the file when the format allows it
+        for (size_t i = 0; i < count; i++) {
+            if (read_next_timestep(nullptr) != MOLFILE_SUCCESS) {
+                throw format_error(
+                    "error while reading the file at '{}' with {} plugin",
+                    path_, plugin_data_.format()
+                );
+            }
+            step_++;
+        }
+    } else {
+        // plugins with only read_timestep do not support a NULL timestep
+        Frame frame;
+        for (size_t i = 0; i < count; i++) {
+            this->read(frame);
+        }
+    }
+}
+
+template <MolfileFormat F> void Molfile<F>::reopen() {
+    plugin_handle_->close_file_read(data_);
+    int natoms = 0;
+    data_ = plugin_handle_->open_file_read(path_.c_str(), plugin_handle_->name, &natoms);
+    if (!data_) {
+        throw format_error(
+            "could not open the file at '{}' with {} plugin", path_, plugin_data_.format()
+        );
     }
-    frame = frames_.at(step).clone();
+    read_topology();
+    step_ = 0;
 }
 
 template <MolfileFormat F> size_t Molfile<F>::nsteps() {
@@ -183,23 +221,28 @@ template <MolfileFormat F> size_t Molfile<F>::nsteps() {
         // a sinle step from all the QM format plugins.
         return 1;
     }
-    size_t n = 0;
-    int status = MOLFILE_SUCCESS;
-    while (true) {
-        status = read_next_timestep(nullptr);
-        if (status == MOLFILE_SUCCESS) {
+
+    if (!nsteps_) {
+        auto current = step_;
+        size_t n = step_;
+        while (read_next_timestep(nullptr) == MOLFILE_SUCCESS) {
             n++;
-        } else {
-            break;
         }
+        nsteps_ = n;
+
+        // We need to close and re-open the file, and go back to the
+        // current step
+        reopen();
+        skip_steps(current);
     }
-    // We need to close and re-open the file
-    plugin_handle_->close_file_read(data_);
-    int tmp = 0;
-    data_ = plugin_handle_->open_file_read(path_.c_str(), plugin_handle_->name, &tmp);
-    read_topology();
+    return *nsteps_;
+}
 
-    return n;
+template <MolfileFormat F> void Molfile<F>::reuse_steps(Format& other) {
+    auto molfile = dynamic_cast<Molfile<F>*>(&other);
+    if (molfile != nullptr && !nsteps_) {
+        nsteps_ = molfile->nsteps_;
+    }
 }
 
 template <MolfileFormat F>
@@ -1,6 +1,8 @@
 // Chemfiles, a modern library for chemistry file reading and writing
 // Copyright (C) Guillaume Fraux and contributors -- BSD license
 
+#include <algorithm>
+
 #include <fmt/format.h>
 #include <fmt/ostream.h>
 
@@ -26,10 +28,6 @@ template<> FormatInfo chemfiles::format_information<PDBFormat>() {
 /// we can represen them. In case of error, use the given `context` in the error
 /// message
 static void check_values_size(const Vector3D& values, unsigned width, const std::string& context);
-/// Fast-forward the file for one step, returning `false` if the file does
-/// not contain one more step.
-static bool forward(TextFile& file);
-
 // PDB record handled by chemfiles. Any record not in this enum are not yet
 // implemented.
 enum class Record {
@@ -60,103 +58,79 @@ enum class Record {
 };
 
 // Get the record type for a line.
-static Record get_record(const std::string& line);
+static Record get_record(string_view line);
+// Read the position of an atom from an ATOM or HETATM record
+static Vector3D read_position(string_view line);
+// Read HEADER record in `properties`, which can be a Frame or a property_map
+template <typename Properties>
+static void read_HEADER(Properties& properties, string_view line);
+// Read TITLE record in `properties`, which can be a Frame or a property_map
+template <typename Properties>
+static void read_TITLE(Properties& properties, string_view line);
 
 PDBFormat::PDBFormat(std::string path, File::Mode mode, File::Compression compression)
-  : file_(TextFile::open(std::move(path), mode, compression)), models_(0) {
-    while (!file_->eof()) {
-        auto position = file_->tellg();
-        if (!file_ || position == std::streampos(-1)) {
-            throw format_error("IO error while reading '{}' as PDB", path);
-        }
-        if (forward(*file_)) {
-            steps_positions_.push_back(position);
-        }
-    }
-    file_->rewind();
+    : TextFormat(std::move(path), mode, compression, "PDB"), models_(0) {}
 
-    // Needed in case there's no end records
-    if (steps_positions_.empty()) {
-        steps_positions_.push_back(file_->tellg());
+void PDBFormat::read_next(Frame& frame) {
+    if (!positions_only_) {
+        // when reading only positions, keep the topology already in the
+        // frame, it is resized at the end
+        frame.resize(0);
     }
-}
-
-size_t PDBFormat::nsteps() {
-    return steps_positions_.size();
-}
-
-void PDBFormat::read_step(const size_t step, Frame& frame) {
-    assert(step < steps_positions_.size());
-    file_->seekg(steps_positions_[step]);
-    read(frame);
-}
-
-void PDBFormat::read(Frame& frame) {
-    frame.resize(0);
     residues_.clear();
     atom_offsets_.clear();
+    positions_.clear();
 
-    std::streampos position;
     bool got_end = false;
     while (!got_end && !file_->eof()) {
-        auto line = file_->readline();
+        auto line = file_->readline_view();
         auto record = get_record(line);
         switch (record) {
         case Record::HEADER:
-            if (line.size() < 66) {continue;}
-            frame.set("classification", trim(line.substr(10, 40)));
-            frame.set("deposition_date", trim(line.substr(50, 9)));
-            frame.set("pdb_idcode", trim(line.substr(62, 4)));
+            read_HEADER(frame, line);
             continue;
         case Record::TITLE:
-            if (line.size() < 11) {continue;}
-            frame.set("name", trim(
-                      frame.get<Property::STRING>("name").value_or("") +
-                      line.substr(10, 70)));
+            read_TITLE(frame, line);
             continue;
         case Record::CRYST1:
-            read_CRYST1(frame, line);
+            frame.set_cell(read_CRYST1(line));
             continue;
         case Record::ATOM:
-            read_ATOM(frame, line, false);
-            continue;
         case Record::HETATM:
-            read_ATOM(frame, line, true);
+            if (positions_only_) {
+                positions_.push_back(read_position(line));
+            } else {
+                read_ATOM(frame, line, record == Record::HETATM);
+            }
             continue;
         case Record::CONECT:
+            if (positions_only_) {continue;}
             read_CONECT(frame, line);
             continue;
         case Record::MODEL:
             models_++;
             continue;
         case Record::ENDMDL:
-            // Check if the next record is an `END` record
-            if (!file_->eof()) {
-                position = file_->tellg();
-                line = file_->readline();
-                file_->seekg(position);
-                if (get_record(line) == Record::END) {
-                    // If this is the case, wait for this next record
-                    continue;
-                }
-            }
-            // Else we have read a frame
-            got_end = true;
+            got_end = end_of_model();
             continue;
         case Record::HELIX:
+            if (positions_only_) {continue;}
             read_HELIX(line);
             continue;
         case Record::SHEET:
+            if (positions_only_) {continue;}
             read_secondary(line, 21, 32, "extended");
             continue;
         case Record::TURN:
+            if (positions_only_) {continue;}
             read_secondary(line, 19, 30, "turn");
             continue;
         case Record::TER:
-            if (line.size() >= 12) {
-                try {
-                    atom_offsets_.push_back(parse<size_t>(line.substr(6, 5)));
-                } catch (const Error&) {
+            if (!positions_only_ && line.size() >= 12) {
+                auto offset = try_parse<size_t>(line.substr(6, 5));
+                if (offset) {
+                    atom_offsets_.push_back(*offset);
+                } else {
                     warning("TER record not numeric: {}", line);
                 }
             }
@@ -179,6 +153,12 @@ void PDBFormat::read(Frame& frame) {
         warning("Missing END record in PDB file");
     }
 
+    if (positions_only_) {
+        frame.resize(positions_.size());
+        std::copy(positions_.begin(), positions_.end(), frame.positions().begin());
+        return;
+    }
+
     for (const auto& secinfo: secinfo_) {
         auto chain = std::get<0>(secinfo);
         for (auto i = std::get<1>(secinfo); i < std::get<2>(secinfo); ++i) {
@@ -195,11 +175,77 @@ void PDBFormat::read(Frame& frame) {
     link_standard_residue_bonds(frame);
 }
 
-void PDBFormat::read_CRYST1(Frame& frame, const std::string& line) {
+bool PDBFormat::end_of_model() {
+    // Check if the next record is an `END` record
+    if (!file_->eof()) {
+        auto position = file_->tellg();
+        auto line = file_->readline_view();
+        file_->seekg(position);
+        if (get_record(line) == Record::END) {
+            // If this is the case, wait for this next record
+            return false;
+        }
+    }
+    // Else we have read a frame
+    return true;
+}
+
+void PDBFormat::read_next_metadata(FrameMetadata& metadata) {
+    bool got_end = false;
+    while (!got_end && !file_->eof()) {
+        auto line = file_->readline_view();
+        switch (get_record(line)) {
+        case Record::HEADER:
+            read_HEADER(metadata.properties, line);
+            continue;
+        case Record::TITLE:
+            read_TITLE(metadata.properties, line);
+            continue;
+        case Record::CRYST1:
+            metadata.cell = read_CRYST1(line);
+            continue;
+        case Record::ATOM:
+        case Record::HETATM:
+            metadata.natoms++;
+            continue;
+        case Record::MODEL:
+            models_++;
+            continue;
+        case Record::ENDMDL:
+            got_end = end_of_model();
+            continue;
+        case Record::END:
+            got_end = true;
+            continue;
+        default:
+            continue;
+        }
+    }
+}
+
+template <typename Properties>
+void read_HEADER(Properties& properties, string_view line) {
+    if (line.size() < 66) {return;}
+    properties.set("classification", trim(line.substr(10, 40)).to_string());
+    properties.set("deposition_date", trim(line.substr(50, 9)).to_string());
+    properties.set("pdb_idcode", trim(line.substr(62, 4)).to_string());
+}
+
+template <typename Properties>
+void read_TITLE(Properties& properties, string_view line) {
+    if (line.size() < 11) {return;}
+    properties.set("name", trim(
+        properties.template get<Property::STRING>("name").value_or("") +
+        line.substr(10, 70).to_string()
+    ));
+}
+
+UnitCell PDBFormat::read_CRYST1(string_view line) {
     assert(line.substr(0, 6) == "CRYST1");
     if (line.length() < 54) {
         throw format_error("CRYST1 record '{}' is too small", line);
     }
+    UnitCell cell;
     try {
         auto a = parse<double>(line.substr(6, 9));
         auto b = parse<double>(line.substr(15, 9));
@@ -207,9 +253,7 @@ void PDBFormat::read_CRYST1(Frame& frame, const std::string& line) {
         auto alpha = parse<double>(line.substr(33, 7));
         auto beta = parse<double>(line.substr(40, 7));
         auto gamma = parse<double>(line.substr(47, 7));
-        auto cell = UnitCell(a, b, c, alpha, beta, gamma);
-
-        frame.set_cell(cell);
+        cell = UnitCell(a, b, c, alpha, beta, gamma);
     } catch (const Error&) {
         throw format_error("could not read CRYST1 record '{}'", line);
     }
@@ -223,9 +267,10 @@ void PDBFormat::read_CRYST1(Frame& frame, const std::string& line) {
             );
         }
     }
+    return cell;
 }
 
-void PDBFormat::read_HELIX(const std::string& line) {
+void PDBFormat::read_HELIX(string_view line) {
     if (line.length() < 33 + 5) {
         warning("HELIX record too short: '{}'", line);
         return;
@@ -276,7 +321,7 @@ void PDBFormat::read_HELIX(const std::string& line) {
     }
 }
 
-void PDBFormat::read_secondary(const std::string& line, size_t i1, size_t i2,
+void PDBFormat::read_secondary(string_view line, size_t i1, size_t i2,
                                const std::string& sec) {
 
     if (line.length() < i2 + 5) {
@@ -308,7 +353,7 @@ void PDBFormat::read_secondary(const std::string& line, size_t i1, size_t i2,
     secinfo_.emplace_back(std::make_tuple(chain1, resid1, resid2, "extended"));
 }
 
-void PDBFormat::read_ATOM(Frame& frame, const std::string& line,
+void PDBFormat::read_ATOM(Frame& frame, string_view line,
     bool is_hetatm) {
     assert(line.substr(0, 6) == "ATOM  " || line.substr(0, 6) == "HETATM");
 
@@ -319,72 +364,85 @@ void PDBFormat::read_ATOM(Frame& frame, const std::string& line,
     }
 
     if (atom_offsets_.empty()) {
-        try {
-            auto initial_offset = parse<long long>(line.substr(6, 5));
-            // We need to handle negative numbers ourselves: https://ideone.com/RdINqa
-            if (initial_offset <= 0) {
-                warning("{} is too small, assuming id is '1'", initial_offset);
-                atom_offsets_.push_back(0);
-            } else {
-                atom_offsets_.push_back(static_cast<size_t>(initial_offset) - 1);
-            }
-        } catch(const Error&) {
+        auto initial_offset = try_parse<long long>(line.substr(6, 5));
+        if (!initial_offset) {
             warning("{} is not a valid atom id, assuming '1'", line.substr(6, 5));
-			atom_offsets_.push_back(0);
+            atom_offsets_.push_back(0);
+        } else if (*initial_offset <= 0) {
+            // We need to handle negative numbers ourselves: https://ideone.com/RdINqa
+            warning("{} is too small, assuming id is '1'", *initial_offset);
+            atom_offsets_.push_back(0);
+        } else {
+            atom_offsets_.push_back(static_cast<size_t>(*initial_offset) - 1);
         }
     }
 
-    auto atom = Atom(trim(line.substr(12, 4)));
+    auto atom = Atom(trim(line.substr(12, 4)).to_string());
     if (line.length() >= 78) {
-        atom.set_type(trim(line.substr(76, 2)));
+        atom.set_type(trim(line.substr(76, 2)).to_string());
     }
 
     auto altloc = line.substr(16, 1);
     if (altloc != " ") {
-        atom.set("altloc", altloc);
+        atom.set("altloc", altloc.to_string());
+    }
+
+    frame.add_atom(std::move(atom), read_position(line));
+
+    auto atom_id = frame.size() - 1;
+    auto resid = try_parse<size_t>(line.substr(22, 4));
+    if (!resid) {
+        // No residue information
+        return;
+    }
+
+    auto chain = line[21];
+    if (residues_.find({chain, *resid}) == residues_.end()) {
+        auto name = trim(line.substr(17, 3));
+        Residue residue(name.to_string(), *resid);
+        residue.add_atom(atom_id);
+
+        auto inscode = line.substr(26, 1);
+        if (inscode != " ") {
+            atom.set("insertion_code", inscode.to_string());
+        }
+
+        // Set whether or not the residue is standardized
+        residue.set("is_standard_pdb", !is_hetatm);
+        // This will be save as a string... on purpose to match MMTF
+        residue.set("chainid", line.substr(21, 1).to_string());
+        // PDB format makes no distinction between chainid and chainname
+        residue.set("chainname", line.substr(21, 1).to_string());
+        residues_.insert({{chain, *resid}, residue});
+    } else {
+        // Just add this atom to the residue
+        residues_.at({chain, *resid}).add_atom(atom_id);
+    }
+}
+
+Vector3D read_position(string_view line) {
+    if (line.length() < 54) {
+        throw format_error(
+            "{} record is too small: '{}'", line.substr(0, 6), line
+        );
     }
 
     try {
         auto x = parse<double>(trim(line.substr(31, 8)));
         auto y = parse<double>(trim(line.substr(38, 8)));
         auto z = parse<double>(trim(line.substr(46, 8)));
-
-        frame.add_atom(std::move(atom), Vector3D(x, y, z));
+        return Vector3D(x, y, z);
     } catch (const Error&) {
         throw format_error("could not read positions in '{}'", line);
     }
+}
 
-    auto atom_id = frame.size() - 1;
-    try {
-        auto resid = parse<size_t>(line.substr(22, 4));
-        auto chain = line[21];
-        if (residues_.find({chain,resid}) == residues_.end()) {
-            auto name = trim(line.substr(17, 3));
-            Residue residue(std::move(name), resid);
-            residue.add_atom(atom_id);
-
-            auto inscode = line.substr(26, 1);
-            if (inscode != " ") {
-                atom.set("insertion_code", inscode);
-            }
-
-            // Set whether or not the residue is standardized
-            residue.set("is_standard_pdb", !is_hetatm);
-            // This will be save as a string... on purpose to match MMTF
-            residue.set("chainid", line.substr(21, 1));
-            // PDB format makes no distinction between chainid and chainname
-            residue.set("chainname", line.substr(21, 1));
-            residues_.insert({{chain,resid}, residue});
-        } else {
-            // Just add this atom to the residue
-            residues_.at({chain,resid}).add_atom(atom_id);
-        }
-    } catch (const Error&) {
-        // No residue information
-    }
+bool PDBFormat::set_positions_only(bool positions_only) {
+    positions_only_ = positions_only;
+    return positions_only;
 }
 
-void PDBFormat::read_CONECT(Frame& frame, const std::string& line) {
+void PDBFormat::read_CONECT(Frame& frame, string_view line) {
     assert(line.substr(0, 6) == "CONECT");
     auto line_length = trim(line).length();
 
@@ -530,34 +588,40 @@ void PDBFormat::link_standard_residue_bonds(Frame& frame) {
     }
 }
 
-bool forward(TextFile& file) {
-    if (!file) {return false;}
+optional<std::streampos> PDBFormat::forward(TextFile& file) {
+    if (!file) {return nullopt;}
+
+    auto position = file.tellg();
     while (true) {
-        try {
-            auto line = file.readline();
-
-            if (line.substr(0, 6) == "ENDMDL") {
-                auto position = file.tellg();
-                auto next = file.readline();
-                file.seekg(position);
-                if (next.substr(0, 3) == "END") {
-                    // We found another record starting by END in the next line,
-                    // we skip this one and wait for the next one
-                    continue;
-                }
+        auto line = file.try_readline_view();
+        if (!line) {
+            // A file without any END record contains a single step
+            if (position == std::streampos(0)) {
+                return position;
             }
+            return nullopt;
+        }
 
-            if (line.substr(0, 3) == "END") {
-                return true;
+        if (line->substr(0, 6) == "ENDMDL") {
+            auto next_position = file.tellg();
+            // This invalidates `line`
+            auto next = file.try_readline_view();
+            file.seekg(next_position);
+            if (next && next->substr(0, 3) == "END") {
+                // We found another record starting by END in the next line,
+                // we skip this one and wait for the next one
+                continue;
             }
+            return position;
+        }
 
-        } catch (const FileError&) {
-            return false;
+        if (line->substr(0, 3) == "END") {
+            return position;
         }
     }
 }
 
-Record get_record(const std::string& line) {
+Record get_record(string_view line) {
     auto rec = line.substr(0, 6);
     if(rec == "ENDMDL") {
         return Record::ENDMDL;
@@ -611,7 +675,7 @@ static std::string to_pdb_index(uint64_t i) {
     }
 }
 
-void PDBFormat::write(const Frame& frame) {
+void PDBFormat::write_next(const Frame& frame) {
     written_ = true;
     fmt::print(*file_, "MODEL {:>4}\n", models_ + 1);
 
@@ -760,7 +824,6 @@ void PDBFormat::write(const Frame& frame) {
     fmt::print(*file_, "ENDMDL\n");
 
     models_++;
-    steps_positions_.push_back(file_->tellg());
 }
 
 void check_values_size(const Vector3D& values, unsigned width, const std::string& context) {
@@ -23,108 +23,72 @@ template<> FormatInfo chemfiles::format_information<SDFFormat>() {
     );
 }
 
-/// Fast-forward the file for one step, returning `false` if the file does
-/// not contain one more step.
-static bool forward(TextFile& file);
-
 SDFFormat::SDFFormat(std::string path, File::Mode mode, File::Compression compression)
-    : file_(TextFile::open(std::move(path), mode, compression))
-{
-    while (!file_->eof()) {
-        auto position = file_->tellg();
-        if (!file_ || position == std::streampos(-1)) {
-            throw format_error("IO error while reading '{}' as SDF", path);
-        }
-        if (forward(*file_)) {
-            steps_positions_.push_back(position);
-        }
-    }
-    file_->rewind();
-}
+    : TextFormat(std::move(path), mode, compression, "SDF") {}
 
-size_t SDFFormat::nsteps() {
-    return steps_positions_.size();
-}
-
-void SDFFormat::read_step(const size_t step, Frame& frame) {
-    assert(step < steps_positions_.size());
-    file_->seekg(steps_positions_[step]);
-    read(frame);
-}
-
-void SDFFormat::read(Frame& frame) {
-
-    // Make this global as it may contain information we need later
-    std::string counts_line;
+void SDFFormat::read_next(Frame& frame) {
     size_t natoms = 0;
     size_t nbonds = 0;
     try {
-        std::string molecule_name = file_->readline();
-        frame.set("name", molecule_name);
+        frame.set("name", file_->readline_view().to_string());
 
-        file_->readline(); // Program line - skip it
-        file_->readline(); // Comment line - skip it
+        file_->readline_view(); // Program line - skip it
+        file_->readline_view(); // Comment line - skip it
 
-        counts_line = file_->readline();
+        auto counts_line = file_->readline_view();
         natoms = parse<size_t>(counts_line.substr(0, 3));
         nbonds = parse<size_t>(counts_line.substr(3, 3));
     } catch (const std::exception& e) {
         throw format_error("can not read next step as SDF: {}", e.what());
     }
 
-    std::vector<std::string> atom_lines;
-    try {
-        atom_lines = file_->readlines(natoms);
-    } catch (const FileError& e) {
-        throw format_error("can not read file: {}", e.what());
-    }
-
     frame.reserve(natoms);
     frame.resize(0);
 
-    for (const auto& line: atom_lines) {
-        auto x = parse<double>(line.substr(0, 10));
-        auto y = parse<double>(line.substr(10, 10));
-        auto z = parse<double>(line.substr(20, 10));
-        auto name = trim(line.substr(31, 3));
-
-        frame.add_atom(Atom(name), Vector3D(x, y, z));
-    }
-
-    std::vector<std::string> bond_lines;
     try {
-        bond_lines = file_->readlines(nbonds);
+        for (auto line: file_->readlines_view(natoms)) {
+            auto x = parse<double>(line.substr(0, 10));
+            auto y = parse<double>(line.substr(10, 10));
+            auto z = parse<double>(line.substr(20, 10));
+            auto name = trim(line.substr(31, 3));
+
+            frame.add_atom(Atom(name.to_string()), Vector3D(x, y, z));
+        }
     } catch (const FileError& e) {
         throw format_error("can not read file: {}", e.what());
     }
 
-    for (const auto& line: bond_lines) {
-        auto atom1 = parse<size_t>(line.substr(0, 3));
-        auto atom2 = parse<size_t>(line.substr(3, 3));
-        auto bondo = parse<size_t>(line.substr(6, 3));
-
-        Bond::BondOrder bo;
+    try {
+        for (auto line: file_->readlines_view(nbonds)) {
+            auto atom1 = parse<size_t>(line.substr(0, 3));
+            auto atom2 = parse<size_t>(line.substr(3, 3));
+            auto bondo = parse<size_t>(line.substr(6, 3));
+
+            Bond::BondOrder bo;
+
+            switch (bondo) {
+                case 1:
+                    bo = Bond::SINGLE;
+                    break;
+                case 2:
+                    bo = Bond::DOUBLE;
+                    break;
+                case 3:
+                    bo = Bond::TRIPLE;
+                    break;
+                case 4:
+                    bo = Bond::AROMATIC;
+                    break;
+                case 8: // The 8 ispecifically means unspecified
+                default:
+                    bo = Bond::UNKNOWN;
+                    break;
+            }
 
-        switch (bondo) {
-            case 1:
-                bo = Bond::SINGLE;
-                break;
-            case 2:
-                bo = Bond::DOUBLE;
-                break;
-            case 3:
-                bo = Bond::TRIPLE;
-                break;
-            case 4:
-                bo = Bond::AROMATIC;
-                break;
-            case 8: // The 8 ispecifically means unspecified
-            default:
-                bo = Bond::UNKNOWN;
-                break;
+            frame.add_bond(atom1 - 1, atom2 - 1, bo);
         }
-
-        frame.add_bond(atom1 - 1, atom2 - 1, bo);
+    } catch (const FileError& e) {
+        throw format_error("can not read file: {}", e.what());
     }
 
     // Parsing the file is more or less complete now, but atom properties can
@@ -132,8 +96,8 @@ void SDFFormat::read(Frame& frame) {
     // This loop breaks when the property block ends or returns on an error
     while(true) {
         try {
-            const auto& line = file_->readline();
-            if (line == "") {
+            auto line = file_->readline_view();
+            if (line.empty()) {
                 continue;
             } else if (line.substr(0, 4) == "$$$$") {
                 // Ending block, technically wrong - but we can exit safetly
@@ -157,8 +121,8 @@ void SDFFormat::read(Frame& frame) {
 
     while(true) {
         try {
-            const auto& line = file_->readline();
-            if (line == "") {
+            auto line = file_->readline_view();
+            if (line.empty()) {
                 // This breaks a property group - so store now
                 if (property_name == "") {
                     warning("Missing property name!");
@@ -173,13 +137,13 @@ void SDFFormat::read(Frame& frame) {
                 // It is formated like:
                 //> <NAMEGOESHERE>
                 const auto npos = line.find_last_of('>');
-                property_name = line.substr(3, npos - 3);
+                property_name = line.substr(3, npos - 3).to_string();
 
-                property_value = file_->readline();
+                property_value = file_->readline_view().to_string();
             } else {
                 // Continuation of a property value
                 property_value += '\n';
-                property_value += line;
+                property_value.append(line.data(), line.size());
             }
         } catch (const FileError&) {
             warning("Premature end of SDF File during global property reading!");
@@ -189,7 +153,7 @@ void SDFFormat::read(Frame& frame) {
 
 }
 
-void SDFFormat::write(const Frame& frame) {
+void SDFFormat::write_next(const Frame& frame) {
     auto& topology = frame.topology();
     auto& positions = frame.positions();
     assert(frame.size() == topology.size());
@@ -242,38 +206,33 @@ void SDFFormat::write(const Frame& frame) {
     }
 
     fmt::print(*file_, "M END\n$$$$\n");
-    steps_positions_.push_back(file_->tellg());
 }
 
-bool forward(TextFile& file) {
-    if (!file) {return false;}
+optional<std::streampos> SDFFormat::forward(TextFile& file) {
+    if (!file) {return nullopt;}
 
-    size_t natoms = 0;
-    size_t nbonds = 0;
-    try {
-        // Ignore junk lines
-        file.readline();
-        file.readline();
-        file.readline();
-        std::string counts_line = file.readline();
-
-        if (counts_line.length() < 10) {
-            throw format_error("Counts line must have at least 10 digits, it has {}", counts_line.length());
-        }
+    auto position = file.tellg();
 
-        natoms = parse<size_t>(counts_line.substr(0,3));
-        nbonds = parse<size_t>(counts_line.substr(3,3));
-    } catch (const FileError&) {
+    // Ignore junk lines
+    auto counts_line = file.skip_lines(3) ? file.try_readline_view() : nullopt;
+    if (!counts_line) {
         // No more line left in the file
-        return false;
-    } catch (const Error&) {
+        return nullopt;
+    }
+
+    if (counts_line->length() < 10) {
+        // This is not a counts line, so give up here
+        return nullopt;
+    }
+
+    auto natoms = try_parse<size_t>(counts_line->substr(0, 3));
+    auto nbonds = try_parse<size_t>(counts_line->substr(3, 3));
+    if (!natoms || !nbonds) {
         // We could not read an integer, so give up here
-        return false;
+        return nullopt;
     }
 
-    try {
-        file.readlines(natoms + nbonds);
-    } catch (const FileError&) {
+    if (!file.skip_lines(*natoms + *nbonds)) {
         // We could not read the lines from the file
         throw format_error(
             "not enough lines in '{}' for SDF format", file.path()
@@ -282,12 +241,12 @@ bool forward(TextFile& file) {
 
     // Search for ending character, updating the position in the file only
     while (!file.eof()) {
-        if (file.readline() == "$$$$") {
+        if (file.readline_view() == "$$$$") {
             break;
         }
     }
 
     // We have enough data to parse an entire molecule.
     // So, even if the file does not have an ending string - return true.
-    return true;
+    return position;
 }
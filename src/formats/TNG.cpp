@@ -66,7 +66,7 @@ void TNGFormat::read(Frame& frame) {
 
     read_positions(frame);
     read_velocities(frame);
-    read_cell(frame);
+    frame.set_cell(read_cell(step_));
     read_topology(frame);
 
     step_++;
@@ -116,12 +116,25 @@ void TNGFormat::read_velocities(Frame& frame) {
     }
 }
 
-void TNGFormat::read_cell(Frame& frame) {
+void TNGFormat::read_metadata(size_t step, FrameMetadata& metadata) {
+    int64_t natoms = 0;
+    CHECK(tng_num_particles_get(tng_, &natoms));
+    metadata.natoms = static_cast<size_t>(natoms);
+    metadata.cell = read_cell(static_cast<int64_t>(step));
+
+    double time = 0;
+    if (tng_util_time_of_frame_get(tng_, static_cast<int64_t>(step), &time) == TNG_SUCCESS) {
+        // TNG uses seconds, and chemfiles picoseconds
+        metadata.time = time * 1e12;
+    }
+}
+
+UnitCell TNGFormat::read_cell(int64_t step) {
     TngBuffer<float> buffer;
     int64_t unused = 0;
 
     auto status = tng_util_box_shape_read_range(
-        tng_, step_, step_, buffer.ptr(), &unused
+        tng_, step, step, buffer.ptr(), &unused
     );
 
     switch (status) {
@@ -130,8 +143,7 @@ void TNGFormat::read_cell(Frame& frame) {
         break;
     case TNG_FAILURE:
         // No unit cell in this frame
-        frame.set_cell(UnitCell());
-        return;
+        return UnitCell();
     case TNG_CRITICAL:
         throw format_error(
             "fatal error in the TNG library while calling 'tng_util_box_shape_read_range'"
@@ -154,7 +166,7 @@ void TNGFormat::read_cell(Frame& frame) {
     double gamma = angle(a, b);
 
     // Factor 10 because the cell lengthes are in nm in the TNG format
-    frame.set_cell({a.norm() * 10, b.norm() * 10, c.norm() * 10, alpha, beta, gamma});
+    return {a.norm() * 10, b.norm() * 10, c.norm() * 10, alpha, beta, gamma};
 }
 
 void TNGFormat::read_topology(Frame& frame) {
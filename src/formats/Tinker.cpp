@@ -21,92 +21,66 @@ template<> FormatInfo chemfiles::format_information<TinkerFormat>() {
     );
 }
 
-/// Fast-forward the file for one step, returning `false` if the file does
-/// not contain one more step.
-static bool forward(TextFile& file);
-static bool is_unit_cell_line(const std::string& line);
+static bool is_unit_cell_line(string_view line);
 
 TinkerFormat::TinkerFormat(std::string path, File::Mode mode, File::Compression compression)
-    : file_(TextFile::open(std::move(path), mode, compression))
-{
-    while (!file_->eof()) {
-        auto position = file_->tellg();
-        if (!file_ || position == std::streampos(-1)) {
-            throw format_error("IO error while reading '{}' as Tinker XYZ", path);
-        }
-        if (forward(*file_)) {
-            steps_positions_.push_back(position);
-        }
-    }
-    file_->rewind();
-}
-
-size_t TinkerFormat::nsteps() {
-    return steps_positions_.size();
-}
-
-void TinkerFormat::read_step(const size_t step, Frame& frame) {
-    assert(step < steps_positions_.size());
-    file_->seekg(steps_positions_[step]);
-    read(frame);
-}
+    : TextFormat(std::move(path), mode, compression, "Tinker") {}
 
-void TinkerFormat::read(Frame& frame) {
+void TinkerFormat::read_next(Frame& frame) {
     size_t natoms = 0;
     try {
-        auto line = file_->readline();
-        scan(line, "%zu", &natoms);
+        auto line = file_->readline_view();
+        scan(line, natoms);
     } catch (const FileError& e) {
         throw format_error(
             "can not read number of atoms in {}: {}", file_->path(), e.what()
         );
     }
 
-    std::vector<std::string> lines;
+    std::vector<std::vector<size_t>> bonds(natoms);
+    frame.reserve(natoms);
+    frame.resize(0);
+
+    auto read_atom = [&frame, &bonds](size_t i, string_view line) {
+        double x = 0, y = 0, z = 0;
+        int id = 0, atom_type = 0;
+        string_view name;
+        auto count = scan(line, id, name, x, y, z, atom_type);
+
+        frame.add_atom(Atom(name.to_string()), Vector3D(x, y, z));
+        while (count != line.size()) {
+            size_t bonded = 0;
+            count += scan(line.substr(count), bonded);
+            bonds[i].push_back(bonded - 1);
+        }
+    };
+
     try {
-        auto line = file_->readline();
+        size_t first_atom = 0;
+        auto line = file_->readline_view();
         if (is_unit_cell_line(line)) {
             // Read the cell
             double a = 0, b = 0, c = 0;
             double alpha = 0, beta = 0, gamma = 0;
-            scan(line, "%lf %lf %lf %lf %lf %lf", &a, &b, &c, &alpha, &beta, &gamma);
+            scan(line, a, b, c, alpha, beta, gamma);
             frame.set_cell(UnitCell(a, b, c, alpha, beta, gamma));
-
-            // And get the atoms lines
-            lines = file_->readlines(natoms);
         } else {
-            lines = file_->readlines(natoms - 1);
-            lines.insert(lines.begin(), line);
+            // This line is the first atom. Read it before reading the other
+            // lines, which will invalidate the view.
+            read_atom(0, line);
+            first_atom = 1;
         }
 
+        const auto& lines = file_->readlines_view(natoms - first_atom);
+        for (size_t i = first_atom; i < natoms; i++) {
+            read_atom(i, lines[i - first_atom]);
+        }
     } catch (const FileError& e) {
         throw format_error(
             "can not read atomic data in {}: {}", file_->path(), e.what()
         );
     }
 
-    std::vector<std::vector<size_t>> bonds(natoms);
-    frame.reserve(natoms);
-    frame.resize(0);
-    for (size_t i = 0; i < natoms; i++) {
-        double x = 0, y = 0, z = 0;
-        int id = 0, atom_type = 0;
-        char name[32];
-        int count = 0;
-        scan(lines[i], "%d %31s %lf %lf %lf %d %n", &id, &name[0], &x, &y, &z, &atom_type, &count);
-
-        frame.add_atom(Atom(name), Vector3D(x, y, z));
-        while (static_cast<size_t>(count) != lines[i].size()) {
-            size_t bonded = 0;
-            int additional = 0;
-
-            scan(lines[i].substr(static_cast<size_t>(count)), "%zu%n", &bonded, &additional);
-            count += additional;
-
-            bonds[i].push_back(bonded - 1);
-        }
-    }
-
     for (size_t i = 0; i < natoms; i++) {
         for (size_t j: bonds[i]) {
             frame.add_bond(i, j);
@@ -114,7 +88,7 @@ void TinkerFormat::read(Frame& frame) {
     }
 }
 
-void TinkerFormat::write(const Frame& frame) {
+void TinkerFormat::write_next(const Frame& frame) {
     fmt::print(*file_, "{} written by the chemfiles library\n", frame.size());
     fmt::print(*file_, "{} {} {} {} {} {}\n",
         frame.cell().a(), frame.cell().b(), frame.cell().c(),
@@ -157,53 +131,59 @@ void TinkerFormat::write(const Frame& frame) {
         }
         fmt::print(*file_, "\n");
     }
-
-    steps_positions_.push_back(file_->tellg());
 }
 
-bool forward(TextFile& file) {
-    if (!file) {return false;}
+optional<std::streampos> TinkerFormat::forward(TextFile& file) {
+    if (!file) {return nullopt;}
 
-    size_t natoms = 0;
-    try {
-        auto line = file.readline();
-        if (trim(line) == "") {
-            // We just read an empty line, we give up here
-            return false;
-        } else {
-            // Get the number of atoms in the line
-            natoms = parse<size_t>(split(trim(line), ' ')[0]);
-        }
-    } catch (const FileError&) {
+    auto position = file.tellg();
+
+    auto line = file.try_readline_view();
+    if (!line) {
         // No more line left in the file
-        return false;
-    } catch (const Error&) {
+        return nullopt;
+    }
+
+    auto trimmed = trim(*line);
+    if (trimmed.empty()) {
+        // We just read an empty line, we give up here
+        return nullopt;
+    }
+
+    // Get the number of atoms in the line
+    auto natoms = try_parse<size_t>(split(trimmed, ' ')[0]);
+    if (!natoms) {
         // We could not read an integer, so give up here
-        return false;
+        return nullopt;
     }
 
-    try {
-        auto line = file.readline();
-        // Minus one because we just read a line.
-        size_t lines_to_skip = natoms - 1;
+    line = file.try_readline_view();
+    if (!line) {
+        // We could not read the lines from the file
+        throw format_error(
+            "not enough lines in '{}' for Tinker XYZ format", file.path()
+        );
+    }
 
-        // This is how tinker does it to check if there is unit cell information
-        // in the file, so let's follow them here.
-        if (is_unit_cell_line(line)) {
-            lines_to_skip += 1;
-        }
+    // Minus one because we just read a line.
+    size_t lines_to_skip = *natoms - 1;
+
+    // This is how tinker does it to check if there is unit cell information
+    // in the file, so let's follow them here.
+    if (is_unit_cell_line(*line)) {
+        lines_to_skip += 1;
+    }
 
-        file.readlines(lines_to_skip);
-    } catch (const FileError&) {
+    if (!file.skip_lines(lines_to_skip)) {
         // We could not read the lines from the file
         throw format_error(
             "not enough lines in '{}' for Tinker XYZ format", file.path()
         );
     }
-    return true;
+    return position;
 }
 
-bool is_unit_cell_line(const std::string& line) {
+bool is_unit_cell_line(string_view line) {
     static const char* LETTERS = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ";
-    return line.find_first_of(LETTERS) == std::string::npos;
+    return line.find_first_of(LETTERS) == string_view::npos;
 }
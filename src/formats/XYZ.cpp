@@ -22,56 +22,55 @@ template<> FormatInfo chemfiles::format_information<XYZFormat>() {
     );
 }
 
-/// Fast-forward the file for one step, returning `false` if the file does
-/// not contain one more step.
-static bool forward(TextFile& file);
-
 XYZFormat::XYZFormat(std::string path, File::Mode mode, File::Compression compression)
-    : file_(TextFile::open(std::move(path), mode, compression))
-{
-    while (!file_->eof()) {
-        auto position = file_->tellg();
-        if (!file_ || position == std::streampos(-1)) {
-            throw format_error("IO error while reading '{}' as XYZ", path);
-        }
-        if (forward(*file_)) {
-            steps_positions_.push_back(position);
-        }
-    }
-    file_->rewind();
-}
-
-size_t XYZFormat::nsteps() {
-    return steps_positions_.size();
-}
+    : TextFormat(std::move(path), mode, compression, "XYZ") {}
 
-void XYZFormat::read_step(const size_t step, Frame& frame) {
-    assert(step < steps_positions_.size());
-    file_->seekg(steps_positions_[step]);
-    read(frame);
-}
-
-void XYZFormat::read(Frame& frame) {
+void XYZFormat::read_next(Frame& frame) {
     size_t natoms = 0;
     try {
-        natoms = parse<size_t>(file_->readline());
-        file_->readline(); // XYZ comment line;
+        natoms = parse<size_t>(file_->readline_view());
+        file_->readline_view(); // XYZ comment line;
     } catch (const std::exception& e) {
         throw format_error("can not read next step as XYZ: {}", e.what());
     }
 
+    if (positions_only_) {
+        frame.resize(natoms);
+        auto positions = frame.positions();
+        size_t i = 0;
+        for (auto line: file_->readlines_view(natoms)) {
+            string_view name;
+            scan(line, name, positions[i][0], positions[i][1], positions[i][2]);
+            i++;
+        }
+        return;
+    }
+
     frame.reserve(natoms);
     frame.resize(0);
 
-    for (const auto& line: file_->readlines(natoms)) {
+    for (auto line: file_->readlines_view(natoms)) {
         double x = 0, y = 0, z = 0;
-        char name[32] = {0};
-        scan(line, "%31s %lf %lf %lf", &name[0], &x, &y, &z);
-        frame.add_atom(Atom(name), Vector3D(x, y, z));
+        string_view name;
+        scan(line, name, x, y, z);
+        frame.add_atom(Atom(name.to_string()), Vector3D(x, y, z));
     }
 }
 
-void XYZFormat::write(const Frame& frame) {
+void XYZFormat::read_next_metadata(FrameMetadata& metadata) {
+    try {
+        metadata.natoms = parse<size_t>(file_->readline_view());
+    } catch (const std::exception& e) {
+        throw format_error("can not read next step as XYZ: {}", e.what());
+    }
+}
+
+bool XYZFormat::set_positions_only(bool positions_only) {
+    positions_only_ = positions_only;
+    return positions_only;
+}
+
+void XYZFormat::write_next(const Frame& frame) {
     auto& topology = frame.topology();
     auto& positions = frame.positions();
     assert(frame.size() == topology.size());
@@ -87,31 +86,34 @@ void XYZFormat::write(const Frame& frame) {
             name, positions[i][0], positions[i][1], positions[i][2]
         );
     }
-
-    steps_positions_.push_back(file_->tellg());
 }
 
-bool forward(TextFile& file) {
-    if (!file) {return false;}
+optional<std::streampos> XYZFormat::forward(TextFile& file) {
+    if (!file) {return nullopt;}
 
-    size_t natoms = 0;
-    try {
-        natoms = parse<size_t>(file.readline());
-    } catch (const FileError&) {
+    auto position = file.tellg();
+
+    auto line = file.try_readline_view();
+    if (!line) {
         // No more line left in the file
-        return false;
-    } catch (const Error&) {
+        return nullopt;
+    }
+
+    auto natoms = try_parse<size_t>(*line);
+    if (!natoms) {
         // We could not read an integer, so give up here
-        return false;
+        return nullopt;
     }
 
-    try {
-        file.readlines(natoms + 1);
-    } catch (const FileError& e) {
+    if (!file.skip_lines(*natoms + 1)) {
         // We could not read the lines from the file
         throw format_error(
-            "not enough lines for XYZ format: {}", file.path(), e.what()
+            "not enough lines in '{}' for XYZ format", file.path()
         );
     }
-    return true;
+    return position;
+}
+
+scanned_steps XYZFormat::scan_steps(string_view data, size_t start) {
+    return scan_steps_parallel(data, start, 0, 2);
 }
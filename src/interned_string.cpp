@@ -0,0 +1,167 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+
+#include <array>
+#include <unordered_set>
+
+#include "chemfiles/config.hpp"
+#include "chemfiles/interned_string.hpp"
+#include "chemfiles/Configuration.hpp"
+#include "chemfiles/mutex.hpp"
+using namespace chemfiles;
+
+/// Maximal number of different strings in the global pool
+static const size_t MAX_POOLED_STRINGS = 1 << 16;
+/// Number of independent shards in the global pool
+static const size_t POOL_SHARDS = 16;
+/// Number of entries in the per-thread cache of interned strings
+static const size_t THREAD_CACHE_SIZE = 256;
+
+const interned_string::entry* interned_string::intern(std::string value) {
+    static const entry EMPTY("", true);
+    if (value.empty()) {
+        return &EMPTY;
+    }
+
+    auto hash = std::hash<std::string>()(value);
+#if CHFL_HAS_THREAD_LOCAL
+    // The same strings are usually interned many times in a row (all the
+    // atoms with the same name in a frame). Look for them in a per-thread
+    // cache of pooled entries before locking the global pool.
+    static thread_local const entry* CACHE[THREAD_CACHE_SIZE] = {};
+    auto& cached = CACHE[hash % THREAD_CACHE_SIZE];
+    if (cached != nullptr && cached->value == value) {
+        return cached;
+    }
+#endif
+
+    struct entry_hash {
+        size_t operator()(const entry& e) const {
+            return std::hash<std::string>()(e.value);
+        }
+    };
+    struct entry_equal {
+        bool operator()(const entry& lhs, const entry& rhs) const {
+            return lhs.value == rhs.value;
+        }
+    };
+    using pool_t = std::unordered_set<entry, entry_hash, entry_equal>;
+    // the pool is never destroyed, since strings with static storage duration
+    // can still use it during program exit
+    static auto POOL = new std::array<mutex<pool_t>, POOL_SHARDS>();  // NOLINT: intentionally leaked
+
+    auto candidate = entry(std::move(value), true);
+    const entry* pooled = nullptr;
+    {
+        auto pool = (*POOL)[hash % POOL_SHARDS].lock();
+        auto it = pool->find(candidate);
+        if (it != pool->end()) {
+            pooled = &*it;
+        } else if (pool->size() < MAX_POOLED_STRINGS / POOL_SHARDS) {
+            // elements of unordered_set are never moved in memory
+            pooled = &*pool->insert(std::move(candidate)).first;
+        }
+    }
+
+    if (pooled == nullptr) {
+        // the pool is full
+        candidate.pooled = false;
+        return new entry(std::move(candidate));
+    }
+
+#if CHFL_HAS_THREAD_LOCAL
+    cached = pooled;
+#endif
+    return pooled;
+}
+
+interned_string::entry::entry(const entry& other): value(other.value), pooled(other.pooled) {
+    auto cached = other.element.load(std::memory_order_acquire);
+    if (cached != nullptr) {
+        element = new cached_element{cached->element, cached->generation, nullptr};
+    }
+}
+
+interned_string::entry::~entry() {
+    auto cached = element.load(std::memory_order_acquire);
+    while (cached != nullptr) {
+        auto previous = cached->previous;
+        delete cached;
+        cached = previous;
+    }
+}
+
+optional<const AtomicData&> interned_string::atomic_data() const {
+    auto generation = Configuration::generation();
+    auto cached = entry_->element.load(std::memory_order_acquire);
+    if (cached != nullptr && cached->generation == generation) {
+        if (cached->element != nullptr) {
+            return *cached->element;
+        } else {
+            return nullopt;
+        }
+    }
+
+    // Look in the configuration first, and then in the periodic table
+    auto data = Configuration::atom_data(entry_->value);
+    if (!data) {
+        data = find_in_periodic_table(entry_->value);
+    }
+    const AtomicData* element = data ? &data.value() : nullptr;
+
+    // Publish the new value, unless another thread already published a value
+    // for the same or a newer generation
+    auto updated = new cached_element{element, generation, cached};
+    while (!entry_->element.compare_exchange_weak(cached, updated, std::memory_order_acq_rel, std::memory_order_acquire)) {
+        if (cached != nullptr && cached->generation >= generation) {
+            delete updated;
+            break;
+        }
+        updated->previous = cached;
+    }
+
+    if (element != nullptr) {
+        return *element;
+    } else {
+        return nullopt;
+    }
+}
+
+void interned_string::release() {
+    if (!entry_->pooled) {
+        delete entry_;
+    }
+}
+
+interned_string::interned_string(): entry_(intern("")) {}
+
+interned_string::interned_string(std::string value): entry_(intern(std::move(value))) {}
+
+interned_string::~interned_string() {
+    release();
+}
+
+interned_string::interned_string(const interned_string& other):
+    entry_(other.entry_->pooled ? other.entry_ : new entry(*other.entry_)) {}
+
+interned_string& interned_string::operator=(const interned_string& other) {
+    if (this != &other) {
+        auto copy = other.entry_->pooled ? other.entry_ : new entry(*other.entry_);
+        release();
+        entry_ = copy;
+    }
+    return *this;
+}
+
+interned_string::interned_string(interned_string&& other) noexcept: entry_(other.entry_) {
+    other.entry_ = intern("");
+}
+
+interned_string& interned_string::operator=(interned_string&& other) noexcept {
+    if (this != &other) {
+        release();
+        entry_ = other.entry_;
+        other.entry_ = intern("");
+    }
+    return *this;
+}
@@ -0,0 +1,215 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+
+#include <cstdint>
+#include <cstring>
+#include <atomic>
+#include <algorithm>
+
+#include "chemfiles/parallel_scan.hpp"
+#include "chemfiles/threads.hpp"
+
+using namespace chemfiles;
+
+/// Minimal size of the chunks scanned by a single thread
+static const size_t MIN_CHUNK_SIZE = 1024 * 1024;
+/// Maximal number of digits in an atom count. This ensures that the line
+/// count can not overflow when adding atom counts.
+static const size_t MAX_DIGITS = 15;
+
+namespace {
+    /// A line containing a single integer
+    struct integer_line {
+        /// Index of the line, from the start of the chunk or of the scan
+        uint64_t line;
+        /// Offset of the start of the line in the data
+        size_t offset;
+        /// Value of the integer
+        uint64_t value;
+    };
+
+    /// Lines found in a single chunk
+    struct chunk_lines {
+        /// Number of lines starting in this chunk
+        uint64_t count = 0;
+        /// All the lines containing a single integer in this chunk
+        std::vector<integer_line> counts;
+    };
+}
+
+/// Check if the line in `[begin, end)` contains only an integer, possibly
+/// preceded by spaces, and store the integer in `value`. This only accepts
+/// lines that `parse<size_t>` also accepts.
+static bool parse_count(const char* begin, const char* end, uint64_t& value) {
+    while (begin != end && (*begin == ' ' || *begin == '\t')) {
+        begin++;
+    }
+    if (begin == end || static_cast<size_t>(end - begin) > MAX_DIGITS) {
+        return false;
+    }
+
+    value = 0;
+    for (; begin != end; begin++) {
+        if (*begin < '0' || *begin > '9') {
+            return false;
+        }
+        value = 10 * value + static_cast<uint64_t>(*begin - '0');
+    }
+    return true;
+}
+
+/// Find all the lines starting in `[begin, end)`. Lines are allowed to end
+/// after `end`, but not after `data.end()`. This returns `false` if the data
+/// uses line endings (`\r` only) which can not be handled here.
+static bool scan_chunk(string_view data, size_t begin, size_t end, chunk_lines& chunk) {
+    const char* current = data.data() + begin;
+    const char* chunk_end = data.data() + end;
+    const char* data_end = data.data() + data.size();
+
+    // Only look for '\r' in all lines if there is any in this chunk
+    auto has_cr = current < chunk_end && std::memchr(current, '\r', static_cast<size_t>(chunk_end - current)) != nullptr;
+
+    while (current < chunk_end) {
+        auto length = static_cast<size_t>(data_end - current);
+        auto eol = static_cast<const char*>(std::memchr(current, '\n', length));
+        if (eol == nullptr) {
+            eol = data_end;
+        }
+
+        auto line_end = eol;
+        if (line_end != current && *(line_end - 1) == '\r') {
+            line_end--;
+        }
+        if ((has_cr || eol >= chunk_end) && std::memchr(current, '\r', static_cast<size_t>(line_end - current)) != nullptr) {
+            return false;
+        }
+
+        uint64_t value = 0;
+        if (parse_count(current, line_end, value)) {
+            chunk.counts.push_back({chunk.count, static_cast<size_t>(current - data.data()), value});
+        }
+        chunk.count++;
+
+        if (eol == data_end) {
+            break;
+        }
+        current = eol + 1;
+    }
+    return true;
+}
+
+/// Get the offset of the start of the line before the one starting at
+/// `offset`
+static size_t previous_line(string_view data, size_t offset) {
+    // data[offset - 1] is the '\n' ending the previous line
+    auto position = offset - 1;
+    while (position > 0 && data[position - 1] != '\n') {
+        position--;
+    }
+    return position;
+}
+
+/// Get the offset of the start of the line `count` lines after the one
+/// starting at `offset`
+static size_t skip_lines(string_view data, size_t offset, uint64_t count) {
+    for (uint64_t i = 0; i < count && offset < data.size(); i++) {
+        auto eol = static_cast<const char*>(std::memchr(data.data() + offset, '\n', data.size() - offset));
+        if (eol == nullptr) {
+            return data.size();
+        }
+        offset = static_cast<size_t>(eol - data.data()) + 1;
+    }
+    return offset;
+}
+
+scanned_steps chemfiles::scan_steps_parallel(string_view data, size_t start, size_t count_line, size_t extra_lines) {
+    auto result = scanned_steps{{}, start};
+    if (start >= data.size()) {
+        return result;
+    }
+
+    auto size = data.size() - start;
+    auto threads = io_threads();
+    auto n_chunks = std::max<size_t>(1, std::min(4 * threads, size / MIN_CHUNK_SIZE));
+    auto chunk_size = size / n_chunks;
+
+    auto chunks = std::vector<chunk_lines>(n_chunks);
+    std::atomic<bool> supported(true);
+    parallel_for(n_chunks, threads, [&](size_t i) {
+        auto begin = start + i * chunk_size;
+        auto end = (i == n_chunks - 1) ? data.size() : begin + chunk_size;
+        if (i != 0 && data[begin - 1] != '\n') {
+            // the line starting before this chunk belongs to the previous one
+            auto eol = std::memchr(data.data() + begin, '\n', data.size() - begin);
+            if (eol == nullptr) {
+                return;
+            }
+            begin = static_cast<size_t>(static_cast<const char*>(eol) - data.data()) + 1;
+        }
+        if (!scan_chunk(data, begin, end, chunks[i])) {
+            supported = false;
+        }
+    });
+
+    if (!supported) {
+        return result;
+    }
+
+    // Merge the lines from all chunks, numbering them from `start`
+    uint64_t total_lines = 0;
+    auto counts = std::vector<integer_line>();
+    for (auto& chunk: chunks) {
+        for (auto& line: chunk.counts) {
+            counts.push_back({total_lines + line.line, line.offset, line.value});
+        }
+        total_lines += chunk.count;
+        chunk.counts = std::vector<integer_line>();
+    }
+
+    // Follow the atom counts from one step to the next
+    uint64_t step_line = 0;
+    size_t step_offset = start;
+    auto count = counts.begin();
+    while (step_line != total_lines) {
+        auto line = step_line + count_line;
+        while (count != counts.end() && count->line < line) {
+            count++;
+        }
+        if (count == counts.end() || count->line != line) {
+            break;
+        }
+
+        auto next_line = step_line + count->value + extra_lines;
+        if (next_line > total_lines) {
+            // incomplete step
+            break;
+        }
+
+        result.positions.emplace_back(static_cast<std::streamoff>(step_offset));
+
+        if (next_line == total_lines) {
+            step_line = next_line;
+            step_offset = data.size();
+            break;
+        }
+
+        // Find the offset of the next step from the next atom count if
+        // possible, or by skipping over all the lines of this step
+        auto next_count = count;
+        while (next_count != counts.end() && next_count->line < next_line + count_line) {
+            next_count++;
+        }
+        if (next_count != counts.end() && next_count->line == next_line + count_line) {
+            step_offset = next_count->offset;
+            for (size_t i = 0; i < count_line; i++) {
+                step_offset = previous_line(data, step_offset);
+            }
+        } else {
+            step_offset = skip_lines(data, step_offset, next_line - step_line);
+        }
+        step_line = next_line;
+    }
+
+    result.end = step_offset;
+    return result;
+}
@@ -0,0 +1,266 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+
+#include <cmath>
+#include <cerrno>
+#include <climits>
+#include <clocale>
+#include <cstdlib>
+#include <cstring>
+
+#include "chemfiles/parse.hpp"
+
+using namespace chemfiles;
+
+/// Maximal number of significant digits stored in the mantissa of a double.
+/// 10^19 fits in an unsigned 64-bit integer.
+static const int MAX_MANTISSA_DIGITS = 19;
+/// Largest integer such that all smaller integers are exactly representable
+/// as a double
+static const uint64_t MAX_EXACT_INTEGER = uint64_t(1) << 53;
+
+/// Powers of ten which are exactly representable as a double
+static const double EXACT_POWERS_OF_TEN[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13,
+    1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+static const int64_t MAX_EXACT_POWER = 22;
+
+static bool is_digit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+static char to_lower(char c) {
+    if (c >= 'A' && c <= 'Z') {
+        return static_cast<char>(c - 'A' + 'a');
+    }
+    return c;
+}
+
+/// Check if `[first, last)` starts with `expected` (in lower case), ignoring
+/// case
+static bool starts_with(const char* first, const char* last, const char* expected) {
+    auto length = std::strlen(expected);
+    if (static_cast<size_t>(last - first) < length) {
+        return false;
+    }
+    for (size_t i = 0; i < length; i++) {
+        if (to_lower(first[i]) != expected[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/// Parse `inf`, `infinity` or `nan` at the start of `[first, last)`
+static from_chars_result parse_special(const char* begin, const char* first, const char* last, bool negative, double& value) {
+    if (starts_with(first, last, "infinity")) {
+        value = negative ? -HUGE_VAL : HUGE_VAL;
+        return {first + 8, std::errc()};
+    } else if (starts_with(first, last, "inf")) {
+        value = negative ? -HUGE_VAL : HUGE_VAL;
+        return {first + 3, std::errc()};
+    } else if (starts_with(first, last, "nan")) {
+        value = negative ? -std::nan("") : std::nan("");
+        return {first + 3, std::errc()};
+    } else {
+        return {begin, std::errc::invalid_argument};
+    }
+}
+
+/// Convert the number in `[first, last)`, which is known to be a valid
+/// decimal number, using `strtod`. This is slower than the fast path, but
+/// handles all the cases correctly.
+static from_chars_result slow_from_chars(const char* first, const char* last, double& value) {
+    // strtod uses the decimal point from the current C locale, which might
+    // not be '.'. Build a null-terminated copy of the number using the
+    // locale decimal point instead.
+    auto decimal_point = std::localeconv()->decimal_point;
+    auto string = std::string(first, last);
+    auto point = string.find('.');
+    if (point != std::string::npos && std::strcmp(decimal_point, ".") != 0) {
+        string.replace(point, 1, decimal_point);
+    }
+
+    errno = 0;
+    char* end = nullptr;
+    auto result = std::strtod(string.c_str(), &end);
+    if (end != string.c_str() + string.size()) {
+        // this should not happen, the number was already validated
+        return {first, std::errc::invalid_argument};
+    }
+    if (errno == ERANGE && std::isinf(result)) {
+        return {last, std::errc::result_out_of_range};
+    }
+    value = result;
+    return {last, std::errc()};
+}
+
+from_chars_result chemfiles::from_chars(const char* first, const char* last, double& value) {
+    auto current = first;
+    bool negative = false;
+    if (current != last && *current == '-') {
+        negative = true;
+        current++;
+    }
+
+    if (current != last && !is_digit(*current) && *current != '.') {
+        return parse_special(first, current, last, negative, value);
+    }
+
+    // Accumulate up to MAX_MANTISSA_DIGITS significant digits in the mantissa,
+    // the number is then `mantissa * 10^exponent`.
+    uint64_t mantissa = 0;
+    int64_t exponent = 0;
+    int digits = 0;
+    bool truncated = false;
+    auto add_digit = [&](char c) {
+        if (digits < MAX_MANTISSA_DIGITS) {
+            mantissa = 10 * mantissa + static_cast<uint64_t>(c - '0');
+            if (mantissa != 0) {
+                digits++;
+            }
+            return true;
+        } else {
+            if (c != '0') {
+                truncated = true;
+            }
+            return false;
+        }
+    };
+
+    auto integer_start = current;
+    while (current != last && is_digit(*current)) {
+        if (!add_digit(*current)) {
+            exponent++;
+        }
+        current++;
+    }
+    bool has_digits = current != integer_start;
+
+    if (current != last && *current == '.') {
+        current++;
+        auto fraction_start = current;
+        while (current != last && is_digit(*current)) {
+            if (add_digit(*current)) {
+                exponent--;
+            }
+            current++;
+        }
+        has_digits = has_digits || current != fraction_start;
+    }
+
+    if (!has_digits) {
+        return {first, std::errc::invalid_argument};
+    }
+
+    if (current != last && (*current == 'e' || *current == 'E')) {
+        // the exponent is only part of the number if it contains digits
+        auto exponent_current = current + 1;
+        bool negative_exponent = false;
+        if (exponent_current != last && (*exponent_current == '-' || *exponent_current == '+')) {
+            negative_exponent = *exponent_current == '-';
+            exponent_current++;
+        }
+        if (exponent_current != last && is_digit(*exponent_current)) {
+            int64_t explicit_exponent = 0;
+            while (exponent_current != last && is_digit(*exponent_current)) {
+                // larger exponents all give zero or infinity
+                if (explicit_exponent < 100000) {
+                    explicit_exponent = 10 * explicit_exponent + (*exponent_current - '0');
+                }
+                exponent_current++;
+            }
+            exponent += negative_exponent ? -explicit_exponent : explicit_exponent;
+            current = exponent_current;
+        }
+    }
+
+    if (mantissa == 0) {
+        value = negative ? -0.0 : 0.0;
+        return {current, std::errc()};
+    }
+
+    // Fast path: if both the mantissa and the power of ten are exactly
+    // representable as doubles, a single multiplication or division gives the
+    // correctly rounded result.
+    if (!truncated && mantissa <= MAX_EXACT_INTEGER) {
+        if (exponent > MAX_EXACT_POWER && exponent <= MAX_EXACT_POWER + 15) {
+            // move some of the exponent to the mantissa if it stays exact,
+            // for numbers like 1.5e25
+            auto shift = static_cast<uint64_t>(EXACT_POWERS_OF_TEN[exponent - MAX_EXACT_POWER]);
+            if (mantissa <= MAX_EXACT_INTEGER / shift) {
+                mantissa *= shift;
+                exponent = MAX_EXACT_POWER;
+            }
+        }
+
+        if (exponent >= -MAX_EXACT_POWER && exponent <= MAX_EXACT_POWER) {
+            auto result = static_cast<double>(mantissa);
+            if (exponent < 0) {
+                result /= EXACT_POWERS_OF_TEN[-exponent];
+            } else {
+                result *= EXACT_POWERS_OF_TEN[exponent];
+            }
+            value = negative ? -result : result;
+            return {current, std::errc()};
+        }
+    }
+
+    return slow_from_chars(first, current, value);
+}
+
+from_chars_result chemfiles::from_chars(const char* first, const char* last, unsigned long long& value) {
+    auto current = first;
+    unsigned long long result = 0;
+    bool overflow = false;
+    while (current != last && is_digit(*current)) {
+        auto digit = static_cast<unsigned long long>(*current - '0');
+        if (result > (ULLONG_MAX - digit) / 10) {
+            overflow = true;
+        } else {
+            result = 10 * result + digit;
+        }
+        current++;
+    }
+
+    if (current == first) {
+        return {first, std::errc::invalid_argument};
+    } else if (overflow) {
+        return {current, std::errc::result_out_of_range};
+    }
+    value = result;
+    return {current, std::errc()};
+}
+
+from_chars_result chemfiles::from_chars(const char* first, const char* last, long long& value) {
+    auto current = first;
+    bool negative = false;
+    if (current != last && *current == '-') {
+        negative = true;
+        current++;
+    }
+
+    unsigned long long magnitude = 0;
+    auto result = from_chars(current, last, magnitude);
+    if (result.ec == std::errc::invalid_argument) {
+        return {first, std::errc::invalid_argument};
+    } else if (result.ec != std::errc()) {
+        return result;
+    }
+
+    auto max = static_cast<unsigned long long>(LLONG_MAX);
+    if (negative) {
+        if (magnitude > max + 1) {
+            return {result.ptr, std::errc::result_out_of_range};
+        }
+        // convert to the negative value without overflowing for LLONG_MIN
+        value = magnitude == max + 1 ? LLONG_MIN : -static_cast<long long>(magnitude);
+    } else {
+        if (magnitude > max) {
+            return {result.ptr, std::errc::result_out_of_range};
+        }
+        value = static_cast<long long>(magnitude);
+    }
+    return result;
+}
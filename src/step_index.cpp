@@ -0,0 +1,234 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <random>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include "chemfiles/step_index.hpp"
+#include "chemfiles/misc.hpp"
+#include "chemfiles/mutex.hpp"
+
+using namespace chemfiles;
+
+static mutex<bool> STEP_INDEX_FILES = {false};
+
+void chemfiles::set_step_index_files(bool enabled) {
+    auto guard = STEP_INDEX_FILES.lock();
+    *guard = enabled;
+}
+
+static bool step_index_files_enabled() {
+    auto guard = STEP_INDEX_FILES.lock();
+    return *guard;
+}
+
+/// Magic bytes at the start of index files
+static const char MAGIC[8] = {'C', 'H', 'F', 'L', '-', 'I', 'D', 'X'};
+/// Version of the index file layout
+static const uint32_t VERSION = 1;
+/// Number of bytes at the start of the trajectory used to compute the hash
+static const size_t HASHED_BYTES = 64 * 1024;
+
+namespace {
+    /// Data used to check that an index file matches the trajectory
+    struct file_metadata {
+        uint64_t size;
+        int64_t mtime;
+        uint64_t hash;
+    };
+
+    /// Write integers in little-endian order, independently of the host
+    class binary_writer {
+    public:
+        void write(uint64_t value) {
+            for (size_t i = 0; i < 8; i++) {
+                data_.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+            }
+        }
+
+        void write(const std::string& value) {
+            write(static_cast<uint64_t>(value.size()));
+            data_.insert(data_.end(), value.begin(), value.end());
+        }
+
+        const std::string& data() const {
+            return data_;
+        }
+
+    private:
+        std::string data_;
+    };
+
+    /// Read integers in little-endian order, independently of the host
+    class binary_reader {
+    public:
+        binary_reader(const std::string& data, size_t position): data_(data), position_(position) {}
+
+        bool read(uint64_t& value) {
+            if (data_.size() - position_ < 8) {
+                return false;
+            }
+            value = 0;
+            for (size_t i = 0; i < 8; i++) {
+                auto byte = static_cast<unsigned char>(data_[position_ + i]);
+                value |= static_cast<uint64_t>(byte) << (8 * i);
+            }
+            position_ += 8;
+            return true;
+        }
+
+        bool read(std::string& value) {
+            uint64_t size = 0;
+            if (!read(size) || data_.size() - position_ < size) {
+                return false;
+            }
+            value = data_.substr(position_, static_cast<size_t>(size));
+            position_ += static_cast<size_t>(size);
+            return true;
+        }
+
+        size_t remaining() const {
+            return data_.size() - position_;
+        }
+
+    private:
+        const std::string& data_;
+        size_t position_;
+    };
+}
+
+/// FNV-1a hash of the first `HASHED_BYTES` of the file at `path`
+static uint64_t hash_prefix(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    auto buffer = std::vector<char>(HASHED_BYTES);
+    file.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    auto count = static_cast<size_t>(file.gcount());
+
+    uint64_t hash = 0xcbf29ce484222325;
+    for (size_t i = 0; i < count; i++) {
+        hash ^= static_cast<unsigned char>(buffer[i]);
+        hash *= 0x100000001b3;
+    }
+    return hash;
+}
+
+static optional<file_metadata> get_metadata(const std::string& path) {
+#ifdef CHEMFILES_WINDOWS
+    struct _stat64 status;
+    if (_stat64(path.c_str(), &status) != 0) {
+        return nullopt;
+    }
+#else
+    struct stat status;
+    if (stat(path.c_str(), &status) != 0) {
+        return nullopt;
+    }
+#endif
+
+    file_metadata metadata;
+    metadata.size = static_cast<uint64_t>(status.st_size);
+    metadata.mtime = static_cast<int64_t>(status.st_mtime);
+    metadata.hash = hash_prefix(path);
+    return metadata;
+}
+
+std::string chemfiles::step_index_path(const std::string& path) {
+    return path + ".chfl-idx";
+}
+
+optional<std::vector<std::streampos>> chemfiles::read_step_index(const std::string& path, const std::string& format) {
+    if (!step_index_files_enabled()) {
+        return nullopt;
+    }
+
+    std::ifstream file(step_index_path(path), std::ios::binary);
+    if (!file) {
+        return nullopt;
+    }
+    auto content = std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+
+    if (content.size() < sizeof(MAGIC) || std::memcmp(content.data(), MAGIC, sizeof(MAGIC)) != 0) {
+        return nullopt;
+    }
+
+    auto metadata = get_metadata(path);
+    if (!metadata) {
+        return nullopt;
+    }
+
+    auto reader = binary_reader(content, sizeof(MAGIC));
+    uint64_t version = 0, size = 0, mtime = 0, hash = 0, count = 0;
+    std::string index_format;
+    if (!reader.read(version) || version != VERSION ||
+        !reader.read(index_format) || index_format != format ||
+        !reader.read(size) || size != metadata->size ||
+        !reader.read(mtime) || static_cast<int64_t>(mtime) != metadata->mtime ||
+        !reader.read(hash) || hash != metadata->hash ||
+        !reader.read(count) || reader.remaining() != 8 * count) {
+        return nullopt;
+    }
+
+    auto positions = std::vector<std::streampos>();
+    positions.reserve(static_cast<size_t>(count));
+    for (uint64_t i = 0; i < count; i++) {
+        uint64_t position = 0;
+        reader.read(position);
+        positions.emplace_back(static_cast<std::streamoff>(position));
+    }
+    return positions;
+}
+
+void chemfiles::write_step_index(const std::string& path, const std::string& format, const std::vector<std::streampos>& positions) {
+    if (!step_index_files_enabled()) {
+        return;
+    }
+
+    auto metadata = get_metadata(path);
+    if (!metadata) {
+        return;
+    }
+
+    auto writer = binary_writer();
+    writer.write(VERSION);
+    writer.write(format);
+    writer.write(metadata->size);
+    writer.write(static_cast<uint64_t>(metadata->mtime));
+    writer.write(metadata->hash);
+    writer.write(static_cast<uint64_t>(positions.size()));
+    for (auto position: positions) {
+        writer.write(static_cast<uint64_t>(std::streamoff(position)));
+    }
+
+    // Write to a temporary file and then rename it, so that other processes
+    // never see a partially written index file.
+    auto index_path = step_index_path(path);
+    std::random_device random;
+    auto temporary = index_path + "." + std::to_string(random()) + ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::binary);
+        if (!file) {
+            return;
+        }
+        file.write(MAGIC, sizeof(MAGIC));
+        file.write(writer.data().data(), static_cast<std::streamsize>(writer.data().size()));
+        if (!file) {
+            file.close();
+            std::remove(temporary.c_str());
+            return;
+        }
+    }
+
+    if (std::rename(temporary.c_str(), index_path.c_str()) != 0) {
+        // rename can fail if the index already exists on Windows
+        std::remove(index_path.c_str());
+        if (std::rename(temporary.c_str(), index_path.c_str()) != 0) {
+            std::remove(temporary.c_str());
+        }
+    }
+}
@@ -0,0 +1,85 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <exception>
+#include <system_error>
+#include <algorithm>
+
+#include "chemfiles/threads.hpp"
+#include "chemfiles/misc.hpp"
+#include "chemfiles/mutex.hpp"
+
+using namespace chemfiles;
+
+/// Number of threads requested by the user, 0 means the number of cores
+static mutex<size_t> IO_THREADS = {0};
+
+void chemfiles::set_io_threads(size_t threads) {
+    auto guard = IO_THREADS.lock();
+    *guard = threads;
+}
+
+size_t chemfiles::io_threads() {
+    size_t threads = 0;
+    {
+        auto guard = IO_THREADS.lock();
+        threads = *guard;
+    }
+    if (threads == 0) {
+        threads = std::thread::hardware_concurrency();
+    }
+    return std::max<size_t>(threads, 1);
+}
+
+void chemfiles::parallel_for(size_t count, size_t threads, const std::function<void(size_t)>& function) {
+    threads = std::min(std::max<size_t>(threads, 1), count);
+    if (threads <= 1) {
+        for (size_t i = 0; i < count; i++) {
+            function(i);
+        }
+        return;
+    }
+
+    std::atomic<size_t> next(0);
+    auto errors = std::vector<std::exception_ptr>(threads);
+    auto work = [&](size_t thread) {
+        try {
+            while (true) {
+                auto i = next++;
+                if (i >= count) {
+                    return;
+                }
+                function(i);
+            }
+        } catch (...) {
+            errors[thread] = std::current_exception();
+            // stop the other threads as soon as possible
+            next = count;
+        }
+    };
+
+    auto workers = std::vector<std::thread>();
+    workers.reserve(threads - 1);
+    for (size_t thread = 1; thread < threads; thread++) {
+        try {
+            workers.emplace_back(work, thread);
+        } catch (const std::system_error&) {
+            // we can not start more threads, the threads already started and
+            // the calling thread will do all the work
+            break;
+        }
+    }
+    work(0);
+    for (auto& worker: workers) {
+        worker.join();
+    }
+
+    for (auto& error: errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+}
@@ -3,9 +3,15 @@
 
 #include "chemfiles/utils.hpp"
 #include "chemfiles/config.hpp"
+#include "chemfiles/step_index.hpp"
 #include "chemfiles/warnings.hpp"
 
+#include <limits>
 #include <algorithm>
+#include <utility>
+
+#include <sys/types.h>
+#include <sys/stat.h>
 
 #ifdef CHEMFILES_WINDOWS
 #include <windows.h>
@@ -15,6 +21,7 @@
 #else
 #include <unistd.h>
 #include <pwd.h>
+#include <dirent.h>
 #endif
 
 std::string chemfiles::user_name() {
@@ -56,6 +63,47 @@ std::string chemfiles::hostname() {
 #endif
 }
 
+chemfiles::optional<uint64_t> chemfiles::file_size(const std::string& path) {
+#ifdef CHEMFILES_WINDOWS
+    struct _stat64 status;
+    if (_stat64(path.c_str(), &status) != 0) {
+        return chemfiles::nullopt;
+    }
+#else
+    struct stat status;
+    if (stat(path.c_str(), &status) != 0) {
+        return chemfiles::nullopt;
+    }
+#endif
+    return static_cast<uint64_t>(status.st_size);
+}
+
+bool chemfiles::seek_file(std::FILE* file, uint64_t offset) {
+#ifdef CHEMFILES_WINDOWS
+    if (offset > static_cast<uint64_t>(std::numeric_limits<__int64>::max())) {
+        return false;
+    }
+    return _fseeki64(file, static_cast<__int64>(offset), SEEK_SET) == 0;
+#else
+    if (offset > static_cast<uint64_t>(std::numeric_limits<off_t>::max())) {
+        return false;
+    }
+    return fseeko(file, static_cast<off_t>(offset), SEEK_SET) == 0;
+#endif
+}
+
+chemfiles::optional<uint64_t> chemfiles::tell_file(std::FILE* file) {
+#ifdef CHEMFILES_WINDOWS
+    auto position = _ftelli64(file);
+#else
+    auto position = ftello(file);
+#endif
+    if (position < 0) {
+        return chemfiles::nullopt;
+    }
+    return static_cast<uint64_t>(position);
+}
+
 std::string chemfiles::current_directory() {
     // loop util buffer large enough
     for (size_t size = 128;; size *=2) {
@@ -77,3 +125,155 @@ std::string chemfiles::current_directory() {
         return std::string(buffer.begin(), end);
     }
 }
+
+bool chemfiles::wildcard_match(string_view pattern, string_view name) {
+    // Iterative matching, going back to the last `*` on mismatch
+    size_t p = 0;
+    size_t n = 0;
+    size_t star = string_view::npos;
+    size_t star_match = 0;
+    while (n < name.size()) {
+        if (p < pattern.size() && (pattern[p] == '?' || pattern[p] == name[n])) {
+            p++;
+            n++;
+        } else if (p < pattern.size() && pattern[p] == '*') {
+            star = p++;
+            star_match = n;
+        } else if (star != string_view::npos) {
+            p = star + 1;
+            n = ++star_match;
+        } else {
+            return false;
+        }
+    }
+
+    while (p < pattern.size() && pattern[p] == '*') {
+        p++;
+    }
+    return p == pattern.size();
+}
+
+/// Compare `lhs` and `rhs` in natural order, where sequences of digits are
+/// compared by their numeric value: "file-2" comes before "file-10".
+static bool natural_less(const std::string& lhs, const std::string& rhs) {
+    auto is_digit = [](char c) { return c >= '0' && c <= '9'; };
+    size_t i = 0;
+    size_t j = 0;
+    while (i < lhs.size() && j < rhs.size()) {
+        if (is_digit(lhs[i]) && is_digit(rhs[j])) {
+            // skip leading zeros, then compare the number of digits and
+            // finally the digits themselves
+            while (i < lhs.size() && lhs[i] == '0') { i++; }
+            while (j < rhs.size() && rhs[j] == '0') { j++; }
+            auto lhs_end = i;
+            auto rhs_end = j;
+            while (lhs_end < lhs.size() && is_digit(lhs[lhs_end])) { lhs_end++; }
+            while (rhs_end < rhs.size() && is_digit(rhs[rhs_end])) { rhs_end++; }
+
+            if (lhs_end - i != rhs_end - j) {
+                return lhs_end - i < rhs_end - j;
+            }
+            auto compare = lhs.compare(i, lhs_end - i, rhs, j, rhs_end - j);
+            if (compare != 0) {
+                return compare < 0;
+            }
+            i = lhs_end;
+            j = rhs_end;
+        } else {
+            if (lhs[i] != rhs[j]) {
+                return lhs[i] < rhs[j];
+            }
+            i++;
+            j++;
+        }
+    }
+
+    if (i < lhs.size() || j < rhs.size()) {
+        return j < rhs.size();
+    }
+    // equal in natural order (e.g. "a01" and "a1"), use lexicographic order
+    // to get a deterministic result
+    return lhs < rhs;
+}
+
+/// Check if the file `name` found in a directory should be matched against
+/// the wildcard `pattern`. Hidden files are only matched if the pattern starts
+/// with a dot, and step index files (and the temporary files used to write
+/// them) are never matched.
+static bool wildcard_candidate(const std::string& pattern, const std::string& name) {
+    if (name[0] == '.' && pattern[0] != '.') {
+        return false;
+    }
+
+    auto extension = chemfiles::step_index_path("");
+    if (name.size() >= extension.size() && name.compare(name.size() - extension.size(), extension.size(), extension) == 0) {
+        return false;
+    }
+    if (name.find(extension + ".") != std::string::npos) {
+        return false;
+    }
+
+    return true;
+}
+
+static bool is_regular_file(const std::string& path) {
+#ifdef CHEMFILES_WINDOWS
+    struct _stat64 status;
+    if (_stat64(path.c_str(), &status) != 0) {
+        return false;
+    }
+    return (status.st_mode & _S_IFMT) == _S_IFREG;
+#else
+    struct stat status;
+    if (stat(path.c_str(), &status) != 0) {
+        return false;
+    }
+    return S_ISREG(status.st_mode);
+#endif
+}
+
+std::vector<std::string> chemfiles::expand_wildcards(const std::string& pattern) {
+    auto slash = pattern.find_last_of("\\/");
+    auto filename = slash == std::string::npos ? pattern : pattern.substr(slash + 1);
+    if (filename.find_first_of("*?") == std::string::npos) {
+        return {pattern};
+    }
+    auto directory = slash == std::string::npos ? std::string() : pattern.substr(0, slash + 1);
+
+    auto paths = std::vector<std::string>();
+#ifdef CHEMFILES_WINDOWS
+    WIN32_FIND_DATAA data;
+    auto handle = FindFirstFileA((directory + "*").c_str(), &data);
+    if (handle != INVALID_HANDLE_VALUE) {
+        do {
+            auto name = std::string(data.cFileName);
+            if (!wildcard_candidate(filename, name) || !wildcard_match(filename, name)) {
+                continue;
+            }
+            auto path = directory + name;
+            if (is_regular_file(path)) {
+                paths.emplace_back(std::move(path));
+            }
+        } while (FindNextFileA(handle, &data));
+        FindClose(handle);
+    }
+#else
+    auto dir = opendir(directory.empty() ? "." : directory.c_str());
+    if (dir != nullptr) {
+        while (auto entry = readdir(dir)) {
+            auto name = std::string(entry->d_name);
+            if (!wildcard_candidate(filename, name) || !wildcard_match(filename, name)) {
+                continue;
+            }
+            auto path = directory + name;
+            if (is_regular_file(path)) {
+                paths.emplace_back(std::move(path));
+            }
+        }
+        closedir(dir);
+    }
+#endif
+
+    std::sort(paths.begin(), paths.end(), natural_less);
+    return paths;
+}
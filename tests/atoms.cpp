@@ -1,6 +1,7 @@
 // Chemfiles, a modern library for chemistry file reading and writing
 // Copyright (C) Guillaume Fraux and contributors -- BSD license
 
+#include <thread>
 #include <catch.hpp>
 #include "chemfiles.hpp"
 using namespace chemfiles;
@@ -152,4 +153,67 @@ TEST_CASE("Use the Atom type") {
         CHECK_FALSE(atom.get<Property::STRING>("fizz"));
         CHECK_FALSE(atom.get<Property::DOUBLE>("fizz"));
     }
+
+    SECTION("Copies") {
+        auto atom = Atom("C1", "C");
+        CHECK(atom.properties().size() == 0);
+        auto copy = atom;
+        CHECK(copy == atom);
+        // names and types are shared between atoms
+        CHECK(&copy.name() == &atom.name());
+        CHECK(&Atom("C").type() == &atom.type());
+
+        copy.set("foo", "bar");
+        copy.set_name("C2");
+        CHECK(copy != atom);
+        CHECK(atom.name() == "C1");
+        CHECK(atom.properties().size() == 0);
+        CHECK_FALSE(atom.get("foo"));
+
+        atom = copy;
+        CHECK(atom == copy);
+        CHECK(atom.get<Property::STRING>("foo").value() == "bar");
+        copy.set("foo", "buzz");
+        CHECK(atom.get<Property::STRING>("foo").value() == "bar");
+
+        auto moved = std::move(copy);
+        CHECK(moved.name() == "C2");
+        CHECK(moved.get<Property::STRING>("foo").value() == "buzz");
+    }
+
+    SECTION("Many different names") {
+        // only a limited number of names are shared, check that other names
+        // still work
+        auto atoms = std::vector<Atom>();
+        for (size_t i = 0; i < 70000; i++) {
+            atoms.emplace_back("atom-" + std::to_string(i), "");
+        }
+        auto copy = atoms;
+        atoms.clear();
+        CHECK(copy[0].name() == "atom-0");
+        CHECK(copy[69999].name() == "atom-69999");
+        copy[69999] = copy[69998];
+        CHECK(copy[69999].name() == "atom-69998");
+    }
+
+    SECTION("Atoms created in multiple threads") {
+        auto threads = std::vector<std::thread>();
+        auto atoms = std::vector<std::vector<Atom>>(4);
+        for (size_t i = 0; i < atoms.size(); i++) {
+            threads.emplace_back([&atoms, i]() {
+                for (size_t j = 0; j < 1000; j++) {
+                    atoms[i].emplace_back("name-" + std::to_string(j % 10), "Zn");
+                }
+            });
+        }
+        for (auto& thread: threads) {
+            thread.join();
+        }
+        for (auto& list: atoms) {
+            CHECK(list[3].name() == "name-3");
+            CHECK(list[999].name() == "name-9");
+            CHECK(list[0].type() == "Zn");
+            CHECK(list[0].mass() == 65.38);
+        }
+    }
 }
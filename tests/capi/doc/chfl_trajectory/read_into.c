@@ -0,0 +1,25 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+
+#include <chemfiles.h>
+
+int main() {
+    // [example] [no-run]
+    CHFL_TRAJECTORY* trajectory = chfl_trajectory_open("water.xyz", 'r');
+    CHFL_FRAME* frame = chfl_frame();
+
+    uint64_t nsteps = 0;
+    chfl_trajectory_nsteps(trajectory, &nsteps);
+    for (uint64_t i = 0; i < nsteps; i++) {
+        /* The memory used by the frame is re-used for all the steps */
+        chfl_trajectory_read_into(trajectory, frame);
+        /* ... */
+    }
+
+    chfl_trajectory_read_step_into(trajectory, 42, frame);
+
+    chfl_free(frame);
+    chfl_trajectory_close(trajectory);
+    // [example]
+    return 0;
+}
@@ -107,6 +107,42 @@ TEST_CASE("Read trajectory") {
         chfl_trajectory_close(trajectory);
     }
 
+    SECTION("Read into an existing frame") {
+        CHFL_TRAJECTORY* trajectory = chfl_trajectory_open("data/xyz/water.xyz", 'r');
+        CHFL_FRAME* frame = chfl_frame();
+        REQUIRE(trajectory);
+        REQUIRE(frame);
+
+        CHECK_STATUS(chfl_frame_add_velocities(frame));
+        CHECK_STATUS(chfl_trajectory_read_into(trajectory, frame));
+
+        uint64_t natoms = 0;
+        CHECK_STATUS(chfl_frame_atoms_count(frame, &natoms));
+        CHECK(natoms == 297);
+
+        // velocities from the previous content of the frame are removed
+        bool has_velocities = true;
+        CHECK_STATUS(chfl_frame_has_velocities(frame, &has_velocities));
+        CHECK_FALSE(has_velocities);
+
+        CHECK_STATUS(chfl_trajectory_read_step_into(trajectory, 41, frame));
+
+        chfl_vector3d positions_0 = {0.761277, 8.106125, 10.622949};
+        chfl_vector3d* positions = nullptr;
+        CHECK_STATUS(chfl_frame_positions(frame, &positions, &natoms));
+        CHECK(natoms == 297);
+        for (unsigned i=0; i<3; i++) {
+            CHECK(positions[0][i] == positions_0[i]);
+        }
+
+        uint64_t step = 0;
+        CHECK_STATUS(chfl_frame_step(frame, &step));
+        CHECK(step == 41);
+
+        chfl_free(frame);
+        chfl_trajectory_close(trajectory);
+    }
+
     SECTION("Get topology") {
         CHFL_TRAJECTORY* trajectory = chfl_trajectory_open("data/xyz/water.xyz", 'r');
         CHFL_FRAME* frame = chfl_frame();
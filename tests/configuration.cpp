@@ -88,6 +88,31 @@ TEST_CASE("Atomic data") {
     CHECK(zn.covalent_radius().value() == 1.31);
 }
 
+TEST_CASE("Cached atomic data") {
+    auto atom = Atom("Qz");
+    CHECK(atom.vdw_radius() == nullopt);
+    CHECK(atom.full_name() == nullopt);
+
+    // atomic data is looked up again after reading new configuration files
+    auto tmpfile = NamedTempPath(".toml");
+    std::ofstream file(tmpfile);
+    file << "[atoms.Qz]\nvdw_radius = 1.5\nfull_name = 'Quartz'\n" << std::endl;
+    file.close();
+    chemfiles::add_configuration(tmpfile);
+
+    CHECK(atom.vdw_radius().value() == 1.5);
+    CHECK(atom.full_name().value() == "Quartz");
+    CHECK(Atom("Qz").vdw_radius().value() == 1.5);
+
+    file.open(tmpfile, std::ios_base::out | std::ios_base::trunc);
+    file << "[atoms.Qz]\nvdw_radius = 2.5\n" << std::endl;
+    file.close();
+    chemfiles::add_configuration(tmpfile);
+
+    CHECK(atom.vdw_radius().value() == 2.5);
+    CHECK(atom.full_name() == nullopt);
+}
+
 TEST_CASE("Configuration errors") {
     auto tmpfile = NamedTempPath(".toml");
 
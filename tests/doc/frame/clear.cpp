@@ -0,0 +1,24 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+#include <catch.hpp>
+#include <chemfiles.hpp>
+using namespace chemfiles;
+
+#undef assert
+#define assert CHECK
+
+TEST_CASE() {
+    // [example]
+    auto frame = Frame(UnitCell(10));
+    frame.add_atom(Atom("H"), {1.0, 0.0, 0.0});
+    frame.add_atom(Atom("O"), {0.0, 0.0, 0.0});
+    frame.add_bond(0, 1);
+    frame.set("name", "hydroxyl");
+
+    frame.clear();
+    assert(frame.size() == 0);
+    assert(frame.topology().bonds().size() == 0);
+    assert(frame.cell() == UnitCell());
+    assert(!frame.get("name"));
+    // [example]
+}
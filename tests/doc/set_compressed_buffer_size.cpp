@@ -0,0 +1,15 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+#include <catch.hpp>
+#include <chemfiles.hpp>
+using namespace chemfiles;
+
+TEST_CASE() {
+    // [example]
+    // use 4 MiB buffers for the compressed files opened from now on
+    chemfiles::set_compressed_buffer_size(4 * 1024 * 1024);
+
+    // go back to the default size
+    chemfiles::set_compressed_buffer_size(1024 * 1024);
+    // [example]
+}
@@ -0,0 +1,16 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+#include <catch.hpp>
+#include <chemfiles.hpp>
+using namespace chemfiles;
+
+TEST_CASE() {
+    // [example]
+    // compress gzip files with 4 threads, using the fastest level and
+    // members of at least 4 MiB
+    chemfiles::set_gz_compression(4, 1, 4 * 1024 * 1024);
+
+    // go back to the default options
+    chemfiles::set_gz_compression(1, 7, 0);
+    // [example]
+}
@@ -0,0 +1,15 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+#include <catch.hpp>
+#include <chemfiles.hpp>
+using namespace chemfiles;
+
+TEST_CASE() {
+    // [example]
+    // only use two threads to read and write files
+    chemfiles::set_io_threads(2);
+
+    // use all the CPU cores again
+    chemfiles::set_io_threads(0);
+    // [example]
+}
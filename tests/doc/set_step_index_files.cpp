@@ -0,0 +1,18 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+#include <catch.hpp>
+#include <chemfiles.hpp>
+using namespace chemfiles;
+
+TEST_CASE() {
+    // [example]
+    chemfiles::set_step_index_files(true);
+
+    // the position of the steps in the file will be saved in
+    // "trajectory.xyz.chfl-idx", and re-used the next time the
+    // file is opened.
+    // auto trajectory = Trajectory("trajectory.xyz");
+
+    chemfiles::set_step_index_files(false);
+    // [example]
+}
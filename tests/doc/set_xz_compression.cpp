@@ -0,0 +1,16 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+#include <catch.hpp>
+#include <chemfiles.hpp>
+using namespace chemfiles;
+
+TEST_CASE() {
+    // [example]
+    // compress xz files with 4 threads, using the fastest preset and blocks
+    // of at least 16 MiB
+    chemfiles::set_xz_compression(4, 0, 16 * 1024 * 1024);
+
+    // go back to the default options
+    chemfiles::set_xz_compression(1, 6, 0);
+    // [example]
+}
@@ -0,0 +1,15 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+#include <catch.hpp>
+#include <chemfiles.hpp>
+using namespace chemfiles;
+
+TEST_CASE() {
+    // [example]
+    // compress zstd files with level 19 and frames of at least 4 MiB
+    chemfiles::set_zstd_compression(19, 4 * 1024 * 1024);
+
+    // go back to the default options
+    chemfiles::set_zstd_compression(3, 0);
+    // [example]
+}
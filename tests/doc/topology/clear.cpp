@@ -0,0 +1,27 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+#include <catch.hpp>
+#include <chemfiles.hpp>
+using namespace chemfiles;
+
+#undef assert
+#define assert CHECK
+
+TEST_CASE() {
+    // [example]
+    auto topology = Topology();
+    topology.add_atom(Atom("H"));
+    topology.add_atom(Atom("O"));
+    topology.add_bond(0, 1);
+
+    auto residue = Residue("OH");
+    residue.add_atom(0);
+    residue.add_atom(1);
+    topology.add_residue(residue);
+
+    topology.clear();
+    assert(topology.size() == 0);
+    assert(topology.bonds().size() == 0);
+    assert(topology.residues().size() == 0);
+    // [example]
+}
@@ -0,0 +1,35 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+
+#include <thread>
+#include <catch.hpp>
+#include <chemfiles.hpp>
+using namespace chemfiles;
+
+TEST_CASE() {
+    // [no-run]
+    // [example]
+    auto trajectory = Trajectory("water.xyz");
+    auto nsteps = trajectory.nsteps();
+
+    // The clone knows where all the steps are in the file, and can be used
+    // independently of the initial trajectory
+    auto clone = trajectory.clone();
+
+    // Read the first half of the file in a separate thread, and the second
+    // half in the current thread
+    auto thread = std::thread([&]() {
+        for (size_t step = 0; step < nsteps / 2; step++) {
+            auto frame = clone.read_step(step);
+            // ...
+        }
+    });
+
+    for (size_t step = nsteps / 2; step < nsteps; step++) {
+        auto frame = trajectory.read_step(step);
+        // ...
+    }
+
+    thread.join();
+    // [example]
+}
@@ -0,0 +1,20 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+
+#include <iostream>
+#include <catch.hpp>
+#include <chemfiles.hpp>
+using namespace chemfiles;
+
+TEST_CASE() {
+    // [no-run]
+    // [example]
+    // Read all the parts of a restarted simulation as a single trajectory,
+    // skipping the first step of each restart
+    auto trajectory = Trajectory::concatenate({"run-*.xyz"}, "", true);
+
+    auto frame = trajectory.read_step(1500);
+    auto nsteps = trajectory.nsteps();
+    std::cout << "step 1500 of " << nsteps << ": " << frame.size() << " atoms" << std::endl;
+    // [example]
+}
@@ -0,0 +1,21 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+
+#include <iostream>
+#include <catch.hpp>
+#include <chemfiles.hpp>
+using namespace chemfiles;
+
+TEST_CASE() {
+    // [no-run]
+    // [example]
+    auto trajectory = Trajectory("water.nc");
+
+    // Up to 4 frames are read by a background thread while the current
+    // frame is used in the loop
+    for (auto& frame: trajectory.frames(4)) {
+        // Use the frame for awesome science here!
+        std::cout << "step " << frame.step() << ": " << frame.size() << " atoms" << std::endl;
+    }
+    // [example]
+}
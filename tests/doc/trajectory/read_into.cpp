@@ -0,0 +1,24 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+
+#include <catch.hpp>
+#include <chemfiles.hpp>
+using namespace chemfiles;
+
+TEST_CASE() {
+    // [no-run]
+    // [example]
+    auto trajectory = Trajectory("water.nc");
+
+    // The same frame is used for all the steps, re-using the memory
+    // allocated when reading the previous steps
+    auto frame = Frame();
+    while (!trajectory.done()) {
+        trajectory.read(frame);
+        // ...
+    }
+
+    // We can also read a specific step in an existing frame
+    trajectory.read_step(10, frame);
+    // [example]
+}
@@ -0,0 +1,27 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+
+#include <catch.hpp>
+#include <chemfiles.hpp>
+using namespace chemfiles;
+
+TEST_CASE() {
+    // [no-run]
+    // [example]
+    auto trajectory = Trajectory("water.nc");
+
+    auto metadata = trajectory.read_metadata(42);
+    if (metadata.natoms != 0 && metadata.cell.volume() > 1000) {
+        // ...
+    }
+
+    // find the first step after 10 ps
+    for (auto& step: trajectory.scan_metadata()) {
+        if (step.time && *step.time > 10.0) {
+            auto frame = trajectory.read_step(step.step);
+            // ...
+            break;
+        }
+    }
+    // [example]
+}
@@ -0,0 +1,26 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+
+#include <iostream>
+#include <catch.hpp>
+#include <chemfiles.hpp>
+using namespace chemfiles;
+
+TEST_CASE() {
+    // [no-run]
+    // [example]
+    auto trajectory = Trajectory("water.xtc");
+
+    // Read every 100th step from step 1000 to step 5000
+    for (auto& frame: trajectory.read_range(1000, 5000, 100)) {
+        // Use the frame for awesome science here!
+        std::cout << "step " << frame.step() << ": " << frame.size() << " atoms" << std::endl;
+    }
+
+    // Read every 10th step from step 500 to the end of the file
+    for (auto& frame: trajectory.read_range(500, SIZE_MAX, 10)) {
+        // ...
+        std::cout << "step " << frame.step() << std::endl;
+    }
+    // [example]
+}
@@ -0,0 +1,24 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+
+#include <catch.hpp>
+#include <chemfiles.hpp>
+using namespace chemfiles;
+
+#undef assert
+#define assert CHECK
+
+TEST_CASE() {
+    // [no-run]
+    // [example]
+    auto trajectory = Trajectory("water.xyz");
+
+    // Read the given steps, possibly using multiple threads
+    auto frames = trajectory.read_steps({42, 3, 1000});
+    assert(frames[0].step() == 42);
+
+    // Read every 10th step from step 100 to step 200
+    frames = trajectory.read_steps(100, 200, 10);
+    assert(frames.size() == 10);
+    // [example]
+}
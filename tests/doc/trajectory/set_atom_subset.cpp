@@ -0,0 +1,29 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+
+#include <catch.hpp>
+#include <chemfiles.hpp>
+using namespace chemfiles;
+
+TEST_CASE() {
+    // [no-run]
+    // [example]
+    auto trajectory = Trajectory("solvated.nc");
+    trajectory.set_topology("solvated.pdb");
+
+    // only read the protein, and not the solvent
+    trajectory.set_atom_subset(Selection("resname ALA or resname GLY"));
+    auto frame = trajectory.read();
+
+    // only read the first 5000 atoms
+    auto indices = std::vector<size_t>(5000);
+    for (size_t i = 0; i < indices.size(); i++) {
+        indices[i] = i;
+    }
+    trajectory.set_atom_subset(indices);
+    frame = trajectory.read();
+
+    // read all the atoms again
+    trajectory.set_atom_subset(std::vector<size_t>());
+    // [example]
+}
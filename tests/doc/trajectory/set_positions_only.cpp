@@ -0,0 +1,24 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+
+#include <catch.hpp>
+#include <chemfiles.hpp>
+using namespace chemfiles;
+
+TEST_CASE() {
+    // [no-run]
+    // [example]
+    auto trajectory = Trajectory("water.pdb");
+    trajectory.set_positions_only();
+
+    // the first frame is read entirely, including the topology
+    auto frame = trajectory.read();
+
+    // the next frames only read positions and unit cell from the file, and
+    // use the topology of the first frame
+    while (!trajectory.done()) {
+        trajectory.read(frame);
+        // ...
+    }
+    // [example]
+}
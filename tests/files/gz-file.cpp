@@ -3,8 +3,13 @@
 
 #include "catch.hpp"
 #include "helpers.hpp"
+#include "chemfiles/Error.hpp"
+#include "chemfiles/misc.hpp"
 #include "chemfiles/files/GzFile.hpp"
 #include <fstream>
+#include <cstring>
+#include <iterator>
+#include <algorithm>
 using namespace chemfiles;
 
 static void check_file(GzFile& file) {
@@ -46,3 +51,255 @@ TEST_CASE("Write a gz file") {
     CHECK(file.readline() == "Test");
     CHECK(file.readline() == "5467");
 }
+
+TEST_CASE("Seek in a gz file") {
+    auto filename = NamedTempPath(".gz");
+
+    // Generate enough data to get multiple checkpoints
+    auto lines = std::vector<std::string>();
+    {
+        GzFile file(filename, File::WRITE);
+        for (size_t i = 0; i < 200000; i++) {
+            auto line = "line " + std::to_string(i) + " " + std::to_string(i * i % 7919);
+            file << line << "\n";
+            lines.push_back(line);
+        }
+    }
+
+    GzFile file(filename, File::READ);
+    auto positions = std::vector<std::streampos>();
+    for (size_t i = 0; i < lines.size(); i++) {
+        positions.push_back(file.tellg());
+        CHECK(file.readline() == lines[i]);
+    }
+
+    for (size_t index: std::vector<size_t>{150000, 12, 199998, 73000, 0, 73001, 180000, 5}) {
+        file.seekg(positions[index]);
+        CHECK(file.tellg() == positions[index]);
+        CHECK(file.readline() == lines[index]);
+        CHECK(file.readline() == lines[index + 1]);
+    }
+
+    // another file can use the checkpoints found while reading this one
+    GzFile other(filename, File::READ);
+    other.share_index(file);
+    for (auto index: std::vector<size_t>{199998, 73000, 0, 180000}) {
+        other.seekg(positions[index]);
+        CHECK(other.tellg() == positions[index]);
+        CHECK(other.readline() == lines[index]);
+        CHECK(other.readline() == lines[index + 1]);
+    }
+}
+
+TEST_CASE("Buffer sizes in gz files") {
+    auto filename = NamedTempPath(".gz");
+    auto lines = std::vector<std::string>();
+    for (size_t i = 0; i < 20000; i++) {
+        lines.push_back("line " + std::to_string(i));
+    }
+
+    for (size_t buffer_size: std::vector<size_t>{0, 5000, 4 * 1024 * 1024}) {
+        {
+            GzFile file(filename, File::WRITE, buffer_size);
+            for (auto& line: lines) {
+                file << line << "\n";
+            }
+        }
+
+        GzFile file(filename, File::READ, buffer_size);
+        auto positions = std::vector<std::streampos>();
+        for (auto& line: lines) {
+            positions.push_back(file.tellg());
+            CHECK(file.readline() == line);
+        }
+
+        file.seekg(positions[10000]);
+        CHECK(file.readline() == lines[10000]);
+        file.seekg(positions[3]);
+        CHECK(file.readline() == lines[3]);
+    }
+}
+
+TEST_CASE("Read a multi-member gz file") {
+    auto first = NamedTempPath(".gz");
+    auto second = NamedTempPath(".gz");
+    {
+        GzFile file(first, File::WRITE);
+        file << "first member\nline\n";
+    }
+    {
+        GzFile file(second, File::WRITE);
+        file << "second member\n";
+    }
+
+    auto filename = NamedTempPath(".gz");
+    {
+        std::ofstream output(filename, std::ios::binary);
+        std::ifstream input_first(first, std::ios::binary);
+        std::ifstream input_second(second, std::ios::binary);
+        output << input_first.rdbuf() << input_second.rdbuf();
+    }
+
+    GzFile file(filename, File::READ);
+    CHECK(file.readline() == "first member");
+    CHECK(file.readline() == "line");
+    auto position = file.tellg();
+    CHECK(file.readline() == "second member");
+    CHECK(file.readline() == "");
+    CHECK(file.eof());
+
+    file.seekg(position);
+    CHECK(file.readline() == "second member");
+}
+
+TEST_CASE("Read uncompressed and zlib data in gz files") {
+    auto content = std::string();
+    for (size_t i = 0; i < 200000; i++) {
+        content += "line " + std::to_string(i) + "\n";
+    }
+
+    auto check_content = [](GzFile& file) {
+        std::streampos position;
+        for (size_t i = 0; i < 200000; i++) {
+            if (i == 150000) {
+                position = file.tellg();
+            }
+            CHECK(file.readline() == "line " + std::to_string(i));
+        }
+        CHECK(file.readline() == "");
+        CHECK(file.eof());
+
+        file.seekg(position);
+        CHECK(file.readline() == "line 150000");
+        file.rewind();
+        CHECK(file.readline() == "line 0");
+    };
+
+    SECTION("Uncompressed data") {
+        auto filename = NamedTempPath(".gz");
+        {
+            std::ofstream output(filename, std::ios::binary);
+            output << content;
+        }
+
+        GzFile file(filename, File::READ);
+        check_content(file);
+    }
+
+    SECTION("zlib data") {
+        auto compressed = std::vector<Bytef>(compressBound(static_cast<uLong>(content.size())));
+        auto size = static_cast<uLongf>(compressed.size());
+        auto status = compress2(
+            compressed.data(), &size,
+            reinterpret_cast<const Bytef*>(content.data()), static_cast<uLong>(content.size()),
+            Z_DEFAULT_COMPRESSION
+        );
+        REQUIRE(status == Z_OK);
+
+        auto filename = NamedTempPath(".gz");
+        {
+            std::ofstream output(filename, std::ios::binary);
+            output.write(reinterpret_cast<const char*>(compressed.data()), static_cast<std::streamsize>(size));
+        }
+
+        GzFile file(filename, File::READ);
+        check_content(file);
+    }
+}
+
+/// Get the uncompressed offsets of the start of all the members in the gzip
+/// file at `path`
+static std::vector<uint64_t> gz_members_offsets(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    auto content = std::vector<unsigned char>(
+        (std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>()
+    );
+
+    auto offsets = std::vector<uint64_t>();
+    auto output = std::vector<unsigned char>(4096);
+    size_t position = 0;
+    uint64_t uncompressed = 0;
+    while (position < content.size()) {
+        offsets.push_back(uncompressed);
+
+        z_stream stream;
+        std::memset(&stream, 0, sizeof(stream));
+        REQUIRE(inflateInit2(&stream, 15 + 16) == Z_OK);
+        stream.next_in = content.data() + position;
+        stream.avail_in = static_cast<uInt>(content.size() - position);
+        auto status = Z_OK;
+        while (status != Z_STREAM_END) {
+            stream.next_out = output.data();
+            stream.avail_out = static_cast<uInt>(output.size());
+            status = inflate(&stream, Z_NO_FLUSH);
+            REQUIRE((status == Z_OK || status == Z_STREAM_END));
+            uncompressed += output.size() - stream.avail_out;
+        }
+        position = content.size() - stream.avail_in;
+        inflateEnd(&stream);
+    }
+    return offsets;
+}
+
+TEST_CASE("Write gz files with multiple members") {
+    auto filename = NamedTempPath(".gz");
+    auto lines = std::vector<std::string>();
+    auto steps_starts = std::vector<uint64_t>();
+    uint64_t position = 0;
+    for (size_t i = 0; i < 20000; i++) {
+        lines.push_back("line " + std::to_string(i));
+        if (i % 100 == 0) {
+            steps_starts.push_back(position);
+        }
+        position += lines.back().size() + 1;
+    }
+
+    for (size_t threads: std::vector<size_t>{1, 4}) {
+        set_gz_compression(threads, 6, 10000);
+        {
+            GzFile file(filename, File::WRITE);
+            for (size_t i = 0; i < lines.size(); i++) {
+                file << lines[i] << "\n";
+                if (i % 100 == 99) {
+                    file.step_boundary();
+                    // tellp accounts for data not yet compressed
+                    auto expected = i + 1 < lines.size() ? steps_starts[(i + 1) / 100] : position;
+                    CHECK(static_cast<uint64_t>(static_cast<std::streamoff>(file.tellp())) == expected);
+                }
+            }
+        }
+
+        // all members start on a step boundary
+        auto offsets = gz_members_offsets(filename);
+        CHECK(offsets.size() > 10);
+        for (auto offset: offsets) {
+            CHECK(std::binary_search(steps_starts.begin(), steps_starts.end(), offset));
+        }
+
+        GzFile file(filename, File::READ);
+        for (auto& line: lines) {
+            CHECK(file.readline() == line);
+        }
+        file.seekg(static_cast<std::streamoff>(steps_starts[150]));
+        CHECK(file.readline() == lines[15000]);
+    }
+
+    // without step boundaries, members are ended when they grow too large
+    set_gz_compression(2, 6, 10000);
+    {
+        GzFile file(filename, File::WRITE);
+        for (auto& line: lines) {
+            file << line << "\n";
+        }
+    }
+    CHECK(gz_members_offsets(filename).size() > 3);
+    {
+        GzFile file(filename, File::READ);
+        for (auto& line: lines) {
+            CHECK(file.readline() == line);
+        }
+    }
+
+    CHECK_THROWS_AS(set_gz_compression(1, 10), Error);
+    set_gz_compression(1);
+}
@@ -0,0 +1,165 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+
+#include <fstream>
+
+#include "catch.hpp"
+#include "helpers.hpp"
+#include "chemfiles/files/MmapFile.hpp"
+#include "chemfiles/Error.hpp"
+using namespace chemfiles;
+
+static void write_file(const std::string& path, const std::string& content) {
+    std::ofstream file(path, std::ios_base::binary);
+    file << content;
+}
+
+TEST_CASE("Read a memory-mapped file") {
+    auto tmpfile = NamedTempPath(".dat");
+    write_file(tmpfile, "3\ncomment line\nHe 0 1 2\nHe 3 4 5\nHe 6 7 8\n");
+
+    MmapFile file(tmpfile, File::READ);
+    CHECK(file.readline() == "3");
+
+    auto lines = file.readlines(2);
+    REQUIRE(lines.size() == 2);
+    CHECK(lines[0] == "comment line");
+    CHECK(lines[1] == "He 0 1 2");
+
+    auto position = file.tellg();
+    CHECK(file.readline() == "He 3 4 5");
+    CHECK(file.readline() == "He 6 7 8");
+    CHECK_FALSE(file.eof());
+    CHECK(file.readline() == "");
+    CHECK(file.eof());
+    CHECK_THROWS_AS(file.readline(), FileError);
+
+    file.rewind();
+    CHECK(file.readline() == "3");
+    file.seekg(position);
+    CHECK(file.readline() == "He 3 4 5");
+}
+
+TEST_CASE("Read lines as views in memory-mapped files") {
+    auto tmpfile = NamedTempPath(".dat");
+    write_file(tmpfile, "first\nsecond\r\nthird\nfourth");
+
+    MmapFile file(tmpfile, File::READ);
+    auto first = file.readline_view();
+    CHECK(first == "first");
+
+    const auto& lines = file.readlines_view(2);
+    REQUIRE(lines.size() == 2);
+    CHECK(lines[0] == "second");
+    CHECK(lines[1] == "third");
+    // Views point directly inside the memory map, and stay valid
+    CHECK(first == "first");
+
+    CHECK(file.readline_view() == "fourth");
+    CHECK(file.readline_view() == "");
+    CHECK(file.eof());
+    CHECK_THROWS_AS(file.readline_view(), FileError);
+}
+
+TEST_CASE("Read lines without exceptions in memory-mapped files") {
+    auto tmpfile = NamedTempPath(".dat");
+    write_file(tmpfile, "first\nsecond\nthird");
+
+    MmapFile file(tmpfile, File::READ);
+    CHECK(file.skip_lines(2));
+    auto line = file.try_readline_view();
+    REQUIRE(line);
+    CHECK(*line == "third");
+    CHECK(file.try_readline_view());
+    CHECK(file.eof());
+    CHECK_FALSE(file.try_readline_view());
+
+    file.rewind();
+    CHECK_FALSE(file.skip_lines(5));
+}
+
+TEST_CASE("Various line endings in memory-mapped files") {
+    auto tmpfile = NamedTempPath(".dat");
+    write_file(tmpfile, "line one\nline two\rline three\r\n\r\nno eol");
+
+    MmapFile file(tmpfile, File::READ);
+    CHECK(file.readline() == "line one");
+    CHECK(file.readline() == "line two");
+    CHECK(file.readline() == "line three");
+    CHECK(file.readline() == "");
+    CHECK(file.readline() == "no eol");
+    CHECK_FALSE(file.eof());
+    CHECK(file.readline() == "");
+    CHECK(file.eof());
+}
+
+TEST_CASE("Old Mac OS line endings in memory-mapped files") {
+    auto tmpfile = NamedTempPath(".dat");
+    auto content = std::string();
+    for (size_t i = 0; i < 10000; i++) {
+        content += "He 0 1 2\r";
+    }
+    content += "last";
+    write_file(tmpfile, content);
+
+    MmapFile file(tmpfile, File::READ);
+    for (size_t i = 0; i < 10000; i++) {
+        CHECK(file.readline_view() == "He 0 1 2");
+    }
+    CHECK(file.readline_view() == "last");
+    CHECK_FALSE(file.eof());
+    CHECK(file.readline_view() == "");
+    CHECK(file.eof());
+}
+
+TEST_CASE("Memory-mapped files changing size") {
+    auto tmpfile = NamedTempPath(".dat");
+    write_file(tmpfile, "first\nsecond\n");
+
+    MmapFile file(tmpfile, File::READ);
+    CHECK(file.readline() == "first");
+    CHECK(file.readline() == "second");
+    auto position = file.tellg();
+    CHECK(file.readline() == "");
+    CHECK(file.eof());
+
+    {
+        std::ofstream append(tmpfile, std::ios_base::binary | std::ios_base::app);
+        append << "third\nfourth\n";
+    }
+
+    // seeking maps the file again, including the new data
+    file.seekg(position);
+    CHECK(file.readline() == "third");
+    CHECK(file.readline() == "fourth");
+
+    write_file(tmpfile, "one\n");
+    file.rewind();
+    CHECK(file.readline() == "one");
+    CHECK(file.readline() == "");
+    CHECK(file.eof());
+}
+
+TEST_CASE("Errors with memory-mapped files") {
+    auto tmpfile = NamedTempPath(".dat");
+    write_file(tmpfile, "");
+
+    MmapFile empty(tmpfile, File::READ);
+    CHECK(empty.readline() == "");
+    CHECK(empty.eof());
+
+    CHECK_THROWS_AS(MmapFile(tmpfile, File::WRITE), FileError);
+    CHECK_THROWS_AS(MmapFile("not/a/file", File::READ), FileError);
+}
+
+TEST_CASE("Default text files use memory maps") {
+    auto tmpfile = NamedTempPath(".dat");
+    write_file(tmpfile, "first\nsecond\n");
+
+    auto file = TextFile::open(tmpfile, File::READ, File::DEFAULT);
+    CHECK(dynamic_cast<MmapFile*>(file.get()) != nullptr);
+    CHECK(file->readline() == "first");
+    CHECK(file->readline() == "second");
+
+    CHECK_THROWS_AS(TextFile::open("not/a/file", File::READ, File::DEFAULT), FileError);
+}
@@ -4,6 +4,7 @@
 #include "catch.hpp"
 #include "helpers.hpp"
 #include "chemfiles/files/PlainFile.hpp"
+#include "chemfiles/Error.hpp"
 using namespace chemfiles;
 
 TEST_CASE("Read a text file") {
@@ -38,6 +39,55 @@ TEST_CASE("Various line endinds") {
     CHECK(basic_file.readline() == "no eol");
 }
 
+TEST_CASE("Read lines as views") {
+    auto tmpfile = NamedTempPath(".dat");
+
+    std::ofstream file(tmpfile, std::ios_base::binary);
+    file << "first\nsecond\rthird\r\nfourth\nfifth";
+    file.close();
+
+    PlainFile basic_file(tmpfile, File::READ);
+    CHECK(basic_file.readline_view() == "first");
+
+    const auto& lines = basic_file.readlines_view(3);
+    REQUIRE(lines.size() == 3);
+    CHECK(lines[0] == "second");
+    CHECK(lines[1] == "third");
+    CHECK(lines[2] == "fourth");
+
+    CHECK(basic_file.readline_view() == "fifth");
+    CHECK(basic_file.readline_view() == "");
+    CHECK(basic_file.eof());
+    CHECK_THROWS_AS(basic_file.readline_view(), FileError);
+}
+
+TEST_CASE("Read lines without exceptions") {
+    auto tmpfile = NamedTempPath(".dat");
+
+    std::ofstream file(tmpfile, std::ios_base::binary);
+    file << "first\nsecond\nthird\nfourth\n";
+    file.close();
+
+    PlainFile basic_file(tmpfile, File::READ);
+    auto line = basic_file.try_readline_view();
+    REQUIRE(line);
+    CHECK(*line == "first");
+
+    CHECK(basic_file.skip_lines(2));
+    CHECK(basic_file.readline_view() == "fourth");
+    CHECK(basic_file.skip_lines(0));
+
+    line = basic_file.try_readline_view();
+    REQUIRE(line);
+    CHECK(*line == "");
+    CHECK_FALSE(basic_file.try_readline_view());
+    CHECK_FALSE(basic_file.skip_lines(1));
+
+    basic_file.rewind();
+    CHECK_FALSE(basic_file.skip_lines(6));
+    CHECK(basic_file.eof());
+}
+
 
 TEST_CASE("Write a text file") {
     auto filename = NamedTempPath(".dat");
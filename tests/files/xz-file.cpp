@@ -3,8 +3,11 @@
 
 #include "catch.hpp"
 #include "helpers.hpp"
+#include "chemfiles/Error.hpp"
+#include "chemfiles/misc.hpp"
 #include "chemfiles/files/XzFile.hpp"
 #include <fstream>
+#include <algorithm>
 using namespace chemfiles;
 
 TEST_CASE("Read a text file") {
@@ -54,3 +57,200 @@ TEST_CASE("Write an xz file") {
     };
     CHECK(content == expected);
 }
+
+TEST_CASE("Buffer sizes in xz files") {
+    auto filename = NamedTempPath(".xz");
+    auto lines = std::vector<std::string>();
+    auto positions = std::vector<std::streamoff>();
+    std::streamoff position = 0;
+    for (size_t i = 0; i < 20000; i++) {
+        lines.push_back("line " + std::to_string(i));
+        positions.push_back(position);
+        position += static_cast<std::streamoff>(lines.back().size() + 1);
+    }
+
+    for (size_t buffer_size: std::vector<size_t>{0, 5000, 4 * 1024 * 1024}) {
+        {
+            XzFile file(filename, File::WRITE, buffer_size);
+            for (auto& line: lines) {
+                file << line << "\n";
+            }
+        }
+
+        XzFile file(filename, File::READ, buffer_size);
+        for (size_t i = 0; i < lines.size(); i++) {
+            CHECK(file.readline() == lines[i]);
+            if (i % 1000 == 999 && i + 1 < lines.size()) {
+                // going back to a previous line, and forward again
+                file.seekg(positions[i - 500]);
+                CHECK(file.readline() == lines[i - 500]);
+                file.seekg(positions[i + 1]);
+            }
+        }
+
+        for (size_t i: std::vector<size_t>{19990, 19995, 3, 15000, 15001, 12}) {
+            file.seekg(positions[i]);
+            CHECK(file.tellg() == positions[i]);
+            CHECK(file.readline() == lines[i]);
+        }
+    }
+}
+
+/// Compress `content` in a xz file at `path`, starting a new block every
+/// `block_size` bytes
+static void write_xz_blocks(const std::string& path, const std::string& content, size_t block_size) {
+    lzma_stream stream = LZMA_STREAM_INIT;
+    REQUIRE(lzma_easy_encoder(&stream, 6, LZMA_CHECK_CRC32) == LZMA_OK);
+
+    auto output = std::vector<uint8_t>(content.size() + 4096);
+    stream.next_out = output.data();
+    stream.avail_out = output.size();
+
+    size_t start = 0;
+    while (start < content.size()) {
+        auto size = std::min(block_size, content.size() - start);
+        stream.next_in = reinterpret_cast<const uint8_t*>(content.data() + start);
+        stream.avail_in = size;
+        lzma_ret status = LZMA_OK;
+        while (status != LZMA_STREAM_END) {
+            status = lzma_code(&stream, LZMA_FULL_FLUSH);
+            REQUIRE((status == LZMA_OK || status == LZMA_STREAM_END));
+        }
+        start += size;
+    }
+    lzma_ret status = LZMA_OK;
+    while (status != LZMA_STREAM_END) {
+        status = lzma_code(&stream, LZMA_FINISH);
+        REQUIRE((status == LZMA_OK || status == LZMA_STREAM_END));
+    }
+
+    std::ofstream file(path, std::ios::binary);
+    file.write(reinterpret_cast<char*>(output.data()), static_cast<std::streamsize>(output.size() - stream.avail_out));
+    lzma_end(&stream);
+}
+
+TEST_CASE("Read xz files with multiple blocks") {
+    auto filename = NamedTempPath(".xz");
+    auto lines = std::vector<std::string>();
+    auto content = std::string();
+    for (size_t i = 0; i < 20000; i++) {
+        lines.push_back("line " + std::to_string(i));
+        content += lines.back() + "\n";
+    }
+    write_xz_blocks(filename, content, 7000);
+
+    for (size_t threads: std::vector<size_t>{1, 4}) {
+        set_io_threads(threads);
+
+        XzFile file(filename, File::READ);
+        for (auto& line: lines) {
+            CHECK(file.readline() == line);
+        }
+
+        // seek inside a block, and across blocks
+        for (size_t i: std::vector<size_t>{15000, 15001, 3, 19999, 4000, 4001}) {
+            auto position = content.find(lines[i] + "\n");
+            file.seekg(static_cast<std::streamoff>(position));
+            CHECK(file.tellg() == static_cast<std::streamoff>(position));
+            CHECK(file.readline() == lines[i]);
+        }
+
+        // seek to the end of the file
+        file.seekg(static_cast<std::streamoff>(content.size()));
+        CHECK(file.tellg() == static_cast<std::streamoff>(content.size()));
+        CHECK(file.readline() == "");
+        CHECK(file.eof());
+
+        file.rewind();
+        for (auto& line: lines) {
+            CHECK(file.readline() == line);
+        }
+    }
+    set_io_threads(0);
+}
+
+/// Get the uncompressed offsets of all the blocks in the xz file at `path`
+static std::vector<uint64_t> xz_blocks_offsets(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    file.seekg(0, std::ios::end);
+    auto size = static_cast<size_t>(file.tellg());
+    file.seekg(0, std::ios::beg);
+    auto content = std::vector<uint8_t>(size);
+    file.read(reinterpret_cast<char*>(content.data()), static_cast<std::streamsize>(size));
+
+    lzma_stream_flags flags;
+    REQUIRE(lzma_stream_footer_decode(&flags, content.data() + size - LZMA_STREAM_HEADER_SIZE) == LZMA_OK);
+    auto index_start = size - LZMA_STREAM_HEADER_SIZE - static_cast<size_t>(flags.backward_size);
+
+    lzma_index* index = nullptr;
+    uint64_t memlimit = UINT64_MAX;
+    size_t position = index_start;
+    REQUIRE(lzma_index_buffer_decode(&index, &memlimit, nullptr, content.data(), &position, size - LZMA_STREAM_HEADER_SIZE) == LZMA_OK);
+
+    auto offsets = std::vector<uint64_t>();
+    lzma_index_iter iter;
+    lzma_index_iter_init(&iter, index);
+    while (!lzma_index_iter_next(&iter, LZMA_INDEX_ITER_BLOCK)) {
+        offsets.push_back(iter.block.uncompressed_file_offset);
+    }
+    lzma_index_end(index, nullptr);
+    return offsets;
+}
+
+TEST_CASE("Write xz files with multiple blocks") {
+    auto filename = NamedTempPath(".xz");
+    auto lines = std::vector<std::string>();
+    auto steps_starts = std::vector<uint64_t>();
+    uint64_t position = 0;
+    for (size_t i = 0; i < 20000; i++) {
+        lines.push_back("line " + std::to_string(i));
+        if (i % 100 == 0) {
+            steps_starts.push_back(position);
+        }
+        position += lines.back().size() + 1;
+    }
+
+    for (size_t threads: std::vector<size_t>{1, 4}) {
+        set_xz_compression(threads, 3, 10000);
+        {
+            XzFile file(filename, File::WRITE);
+            for (size_t i = 0; i < lines.size(); i++) {
+                file << lines[i] << "\n";
+                if (i % 100 == 99) {
+                    file.step_boundary();
+                }
+            }
+        }
+
+        // all blocks start on a step boundary
+        auto offsets = xz_blocks_offsets(filename);
+        CHECK(offsets.size() > 10);
+        for (auto offset: offsets) {
+            CHECK(std::binary_search(steps_starts.begin(), steps_starts.end(), offset));
+        }
+
+        XzFile file(filename, File::READ);
+        for (auto& line: lines) {
+            CHECK(file.readline() == line);
+        }
+    }
+
+    // without step boundaries, blocks are ended when they grow too large
+    set_xz_compression(2, 6, 10000);
+    {
+        XzFile file(filename, File::WRITE);
+        for (auto& line: lines) {
+            file << line << "\n";
+        }
+    }
+    CHECK(xz_blocks_offsets(filename).size() > 3);
+    {
+        XzFile file(filename, File::READ);
+        for (auto& line: lines) {
+            CHECK(file.readline() == line);
+        }
+    }
+
+    CHECK_THROWS_AS(set_xz_compression(1, 10), Error);
+    set_xz_compression(1);
+}
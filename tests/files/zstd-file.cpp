@@ -0,0 +1,121 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+
+#include "catch.hpp"
+#include "helpers.hpp"
+#include "chemfiles/Error.hpp"
+#include "chemfiles/misc.hpp"
+#include "chemfiles/files/ZstdFile.hpp"
+#include <fstream>
+#include <iterator>
+#include <algorithm>
+using namespace chemfiles;
+
+static std::vector<char> read_binary(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    return std::vector<char>(
+        (std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>()
+    );
+}
+
+TEST_CASE("Write and read a zstd file") {
+    auto filename = NamedTempPath(".zst");
+
+    {
+        ZstdFile file(filename, File::WRITE);
+        file << "Test" << std::endl;
+        file << 5467 << std::endl;
+    }
+
+    auto content = read_binary(filename);
+    auto expected = std::string("Test\n5467\n");
+    auto decompressed = std::vector<char>(expected.size());
+    auto size = ZSTD_decompress(decompressed.data(), decompressed.size(), content.data(), content.size());
+    REQUIRE(!ZSTD_isError(size));
+    CHECK(std::string(decompressed.data(), size) == expected);
+
+    ZstdFile file(filename, File::READ);
+    CHECK(file.readline() == "Test");
+    CHECK(file.readline() == "5467");
+    file.rewind();
+    CHECK(file.readline() == "Test");
+
+    CHECK_THROWS_AS(ZstdFile(filename, File::APPEND), FileError);
+    CHECK_THROWS_AS(ZstdFile("not-there.zst", File::READ), FileError);
+}
+
+TEST_CASE("Seek in zstd files") {
+    auto lines = std::vector<std::string>();
+    auto positions = std::vector<std::streamoff>();
+    auto content = std::string();
+    for (size_t i = 0; i < 20000; i++) {
+        lines.push_back("line " + std::to_string(i));
+        positions.push_back(static_cast<std::streamoff>(content.size()));
+        content += lines.back() + "\n";
+    }
+
+    auto check_file = [&](const std::string& path) {
+        for (size_t buffer_size: std::vector<size_t>{0, 5000, 1024 * 1024}) {
+            ZstdFile file(path, File::READ, buffer_size);
+            for (auto& line: lines) {
+                CHECK(file.readline() == line);
+            }
+            CHECK(file.readline() == "");
+            CHECK(file.eof());
+
+            for (size_t i: std::vector<size_t>{15000, 15001, 3, 19999, 4000, 4001}) {
+                file.seekg(positions[i]);
+                CHECK(file.tellg() == positions[i]);
+                CHECK(file.readline() == lines[i]);
+            }
+        }
+    };
+
+    SECTION("Seekable files") {
+        auto filename = NamedTempPath(".zst");
+        set_zstd_compression(3, 10000);
+        {
+            ZstdFile file(filename, File::WRITE);
+            for (size_t i = 0; i < lines.size(); i++) {
+                file << lines[i] << "\n";
+                if (i % 100 == 99) {
+                    file.step_boundary();
+                }
+            }
+        }
+        set_zstd_compression(3);
+
+        // all frames start on a step boundary
+        auto seekable = ZSTD_seekable_create();
+        auto compressed = read_binary(filename);
+        REQUIRE(!ZSTD_isError(ZSTD_seekable_initBuff(seekable, compressed.data(), compressed.size())));
+        auto frames = ZSTD_seekable_getNumFrames(seekable);
+        CHECK(frames > 10);
+        for (unsigned i = 0; i < frames; i++) {
+            auto offset = static_cast<std::streamoff>(ZSTD_seekable_getFrameDecompressedOffset(seekable, i));
+            auto line = std::lower_bound(positions.begin(), positions.end(), offset);
+            REQUIRE(line != positions.end());
+            CHECK(*line == offset);
+            CHECK((line - positions.begin()) % 100 == 0);
+        }
+        ZSTD_seekable_free(seekable);
+
+        check_file(filename);
+    }
+
+    SECTION("Files without seek table") {
+        auto filename = NamedTempPath(".zst");
+        {
+            auto compressed = std::vector<char>(ZSTD_compressBound(content.size()));
+            auto size = ZSTD_compress(compressed.data(), compressed.size(), content.data(), content.size(), 3);
+            REQUIRE(!ZSTD_isError(size));
+            std::ofstream file(filename, std::ios::binary);
+            file.write(compressed.data(), static_cast<std::streamsize>(size));
+        }
+
+        check_file(filename);
+    }
+
+    CHECK_THROWS_AS(set_zstd_compression(0), Error);
+    CHECK_THROWS_AS(set_zstd_compression(23), Error);
+}
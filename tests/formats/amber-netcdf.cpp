@@ -71,3 +71,85 @@ TEST_CASE("Write files in NetCDF format") {
     CHECK(approx_eq(positions[2], Vector3D(1, 2, 3), 1e-4));
     CHECK(approx_eq(positions[3], Vector3D(1, 2, 3), 1e-4));
 }
+
+TEST_CASE("Read atom subsets in NetCDF format") {
+    auto tmpfile = NamedTempPath(".nc");
+    {
+        Trajectory file(tmpfile, 'w');
+        Frame frame;
+        frame.resize(300);
+        frame.add_velocities();
+        for (size_t step = 0; step < 3; step++) {
+            auto positions = frame.positions();
+            auto velocities = *frame.velocities();
+            for (size_t i = 0; i < 300; i++) {
+                positions[i] = Vector3D(static_cast<double>(i), static_cast<double>(step), 0);
+                velocities[i] = Vector3D(0, 0, static_cast<double>(i));
+            }
+            file.write(frame);
+        }
+    }
+
+    Trajectory file(tmpfile);
+    SECTION("Contiguous runs of atoms") {
+        auto indices = std::vector<size_t>{3, 4, 5, 6, 100, 250, 251};
+        file.set_atom_subset(indices);
+
+        auto frame = file.read_step(2);
+        REQUIRE(frame.size() == indices.size());
+        auto positions = frame.positions();
+        auto velocities = *frame.velocities();
+        for (size_t i = 0; i < indices.size(); i++) {
+            auto index = static_cast<double>(indices[i]);
+            CHECK(approx_eq(positions[i], Vector3D(index, 2, 0), 1e-4));
+            CHECK(approx_eq(velocities[i], Vector3D(0, 0, index), 1e-4));
+        }
+
+        file.set_atom_subset({});
+        frame = file.read_step(1);
+        CHECK(frame.size() == 300);
+        CHECK(approx_eq(frame.positions()[299], Vector3D(299, 1, 0), 1e-4));
+    }
+
+    SECTION("Many separated atoms") {
+        auto indices = std::vector<size_t>();
+        for (size_t i = 10; i < 290; i += 2) {
+            indices.push_back(i);
+        }
+        file.set_atom_subset(indices);
+
+        auto frame = file.read();
+        REQUIRE(frame.size() == indices.size());
+        auto positions = frame.positions();
+        for (size_t i = 0; i < indices.size(); i++) {
+            CHECK(approx_eq(positions[i], Vector3D(static_cast<double>(indices[i]), 0, 0), 1e-4));
+        }
+    }
+
+    SECTION("Errors") {
+        file.set_atom_subset({3, 300});
+        CHECK_THROWS_AS(file.read(), OutOfBounds);
+    }
+}
+
+TEST_CASE("Read metadata in NetCDF format") {
+    auto tmpfile = NamedTempPath(".nc");
+    {
+        Trajectory file(tmpfile, 'w');
+        for (size_t step = 0; step < 3; step++) {
+            Frame frame(UnitCell(10 + static_cast<double>(step)));
+            frame.resize(10);
+            file.write(frame);
+        }
+    }
+
+    Trajectory file(tmpfile);
+    auto metadata = file.scan_metadata();
+    REQUIRE(metadata.size() == 3);
+    for (size_t step = 0; step < 3; step++) {
+        CHECK(metadata[step].step == step);
+        CHECK(metadata[step].natoms == 10);
+        CHECK(metadata[step].cell == UnitCell(10 + static_cast<double>(step)));
+        CHECK_FALSE(metadata[step].time);
+    }
+}
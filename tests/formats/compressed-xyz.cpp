@@ -6,6 +6,8 @@
 #include "chemfiles.hpp"
 #include "chemfiles/files/GzFile.hpp"
 #include "chemfiles/files/XzFile.hpp"
+#include "chemfiles/files/ZstdFile.hpp"
+#include <fstream>
 using namespace chemfiles;
 
 #include <boost/filesystem.hpp>
@@ -83,4 +85,112 @@ TEST_CASE("Write compressed files in XYZ format") {
     // xz compression
     auto xz_path = NamedTempPath(".xyz.xz");
     check_write_file<XzFile>(xz_path);
+
+    // zstd compression
+    auto zst_path = NamedTempPath(".xyz.zst");
+    check_write_file<ZstdFile>(zst_path);
+}
+
+TEST_CASE("Read steps in zstd compressed XYZ files") {
+    auto path = NamedTempPath(".xyz.zst");
+    set_zstd_compression(3, 1000);
+    {
+        auto file = Trajectory(path, 'w');
+        for (size_t step = 0; step < 50; step++) {
+            auto frame = Frame();
+            for (size_t i = 0; i < 20; i++) {
+                frame.add_atom(Atom("C"), {static_cast<double>(step), static_cast<double>(i), 0});
+            }
+            file.write(frame);
+        }
+    }
+    set_zstd_compression(3);
+
+    auto file = Trajectory(path);
+    CHECK(file.nsteps() == 50);
+    for (size_t step: std::vector<size_t>{42, 3, 17, 49, 0}) {
+        auto frame = file.read_step(step);
+        CHECK(frame.size() == 20);
+        CHECK(frame.positions()[19] == Vector3D(static_cast<double>(step), 19, 0));
+    }
+
+    file = Trajectory(path, 'r', "XYZ / ZST");
+    CHECK(file.read().positions()[0] == Vector3D(0, 0, 0));
+}
+
+TEST_CASE("Read zstd compressed XYZ files without seek table") {
+    auto content = std::string();
+    for (size_t step = 0; step < 5; step++) {
+        content += "2\n\nC 0 0 " + std::to_string(step) + "\nC 1 0 0\n";
+    }
+
+    // this is the kind of file produced by the zstd command line tool
+    auto path = NamedTempPath(".xyz.zst");
+    {
+        auto compressed = std::vector<char>(ZSTD_compressBound(content.size()));
+        auto size = ZSTD_compress(compressed.data(), compressed.size(), content.data(), content.size(), 3);
+        REQUIRE(!ZSTD_isError(size));
+        std::ofstream file(path, std::ios::binary);
+        file.write(compressed.data(), static_cast<std::streamsize>(size));
+    }
+
+    auto file = Trajectory(path);
+    size_t count = 0;
+    while (!file.done()) {
+        auto frame = file.read();
+        CHECK(frame.positions()[0] == Vector3D(0, 0, static_cast<double>(count)));
+        count++;
+    }
+    CHECK(count == 5);
+    CHECK(file.nsteps() == 5);
+}
+
+static void check_read_until_done(const std::string& path) {
+    {
+        auto file = Trajectory(path, 'w');
+        for (size_t step = 0; step < 5; step++) {
+            auto frame = Frame();
+            for (size_t i = 0; i < 50; i++) {
+                frame.add_atom(Atom("C"), {static_cast<double>(step), static_cast<double>(i), 0});
+            }
+            file.write(frame);
+        }
+    }
+
+    auto file = Trajectory(path);
+    size_t count = 0;
+    while (!file.done()) {
+        auto frame = file.read();
+        CHECK(frame.positions()[0] == Vector3D(static_cast<double>(count), 0, 0));
+        count++;
+    }
+    CHECK(count == 5);
+    CHECK(file.nsteps() == 5);
+
+    file = Trajectory(path);
+    for (size_t step = 0; step < 5; step++) {
+        file.read();
+    }
+    CHECK(file.nsteps() == 5);
+    CHECK(file.done());
+}
+
+TEST_CASE("Read compressed XYZ files until the end") {
+    check_read_until_done(NamedTempPath(".xyz"));
+    check_read_until_done(NamedTempPath(".xyz.gz"));
+    check_read_until_done(NamedTempPath(".xyz.xz"));
+    check_read_until_done(NamedTempPath(".xyz.zst"));
+
+    // files with multiple blocks/members/frames, decompressed in parallel
+    set_io_threads(4);
+    set_gz_compression(2, 6, 1000);
+    set_xz_compression(2, 6, 1000);
+    set_zstd_compression(3, 1000);
+    check_read_until_done(NamedTempPath(".xyz.gz"));
+    check_read_until_done(NamedTempPath(".xyz.xz"));
+    check_read_until_done(NamedTempPath(".xyz.zst"));
+    set_gz_compression(1);
+    set_xz_compression(1);
+    set_zstd_compression(3);
+    set_io_threads(0);
 }
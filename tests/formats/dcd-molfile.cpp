@@ -27,4 +27,24 @@ TEST_CASE("Read files in DCD format using Molfile") {
     positions = frame.positions();
     CHECK(approx_eq(positions[0], Vector3D(0.2990952, 8.31003, 11.72146), eps));
     CHECK(approx_eq(positions[296], Vector3D(6.797599, 11.50882, 12.70423), eps));
+
+    // going back to a previous step
+    frame = file.read_step(0);
+    positions = frame.positions();
+    CHECK(approx_eq(positions[0], Vector3D(0.4172191, 8.303366, 11.73717), eps));
+
+    // counting the steps does not change the current position
+    file.read_step(1);
+    CHECK(file.nsteps() == 100);
+    frame = file.read();
+    positions = frame.positions();
+    CHECK(approx_eq(positions[0], Vector3D(0.2990952, 8.31003, 11.72146), eps));
+
+    size_t count = 0;
+    for (auto& range_frame: file.read_range(2, 100, 10)) {
+        CHECK(range_frame.step() == 2 + 10 * count);
+        CHECK(range_frame.size() == 297);
+        count++;
+    }
+    CHECK(count == 10);
 }
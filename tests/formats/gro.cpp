@@ -285,3 +285,75 @@ TEST_CASE("GRO files with big values") {
         }
     }
 }
+
+TEST_CASE("Find steps in large GRO files") {
+    // use multiple threads, even on a single core
+    set_io_threads(4);
+
+    auto tmpfile = NamedTempPath(".gro");
+    {
+        auto trajectory = Trajectory(tmpfile, 'w');
+        for (size_t step = 0; step < 20000; step++) {
+            auto frame = Frame();
+            // the name of the frame is the comment line
+            frame.set("name", std::to_string(step % 5));
+            for (size_t i = 0; i < step % 5; i++) {
+                frame.add_atom(Atom("A"), {static_cast<double>(i), 0, 0});
+            }
+            trajectory.write(frame);
+        }
+    }
+
+    auto trajectory = Trajectory(tmpfile);
+    CHECK(trajectory.nsteps() == 20000);
+
+    auto frame = trajectory.read_step(0);
+    CHECK(frame.size() == 0);
+
+    frame = trajectory.read_step(12344);
+    CHECK(frame.size() == 4);
+    CHECK(frame.get("name")->as_string() == "4");
+    CHECK(approx_eq(frame.positions()[3], Vector3D(3, 0, 0), 1e-5));
+
+    frame = trajectory.read_step(19998);
+    CHECK(frame.size() == 3);
+
+    set_io_threads(0);
+}
+
+TEST_CASE("Read only positions in GRO format") {
+    auto tmpfile = NamedTempPath(".gro");
+    {
+        auto file = Trajectory(tmpfile, 'w');
+        for (size_t step = 0; step < 3; step++) {
+            auto frame = Frame(UnitCell(10 + static_cast<double>(step)));
+            frame.add_velocities();
+            for (size_t i = 0; i < 4; i++) {
+                auto x = static_cast<double>(i);
+                frame.add_atom(Atom("C"), {x, static_cast<double>(step), 0}, {0, 0, x});
+            }
+            auto residue = Residue("ALA", 1);
+            residue.add_atom(0);
+            residue.add_atom(1);
+            frame.add_residue(residue);
+            file.write(frame);
+        }
+    }
+
+    auto full = Trajectory(tmpfile);
+    auto fast = Trajectory(tmpfile);
+    fast.set_positions_only();
+    for (size_t step = 0; step < 3; step++) {
+        auto expected = full.read();
+        auto frame = fast.read();
+        REQUIRE(frame.size() == 4);
+        REQUIRE(frame.velocities());
+        for (size_t i = 0; i < 4; i++) {
+            CHECK(approx_eq(frame.positions()[i], expected.positions()[i], 1e-3));
+            CHECK(approx_eq((*frame.velocities())[i], (*expected.velocities())[i], 1e-3));
+            CHECK(frame[i] == expected[i]);
+        }
+        CHECK(frame.cell() == expected.cell());
+        CHECK(frame.topology().residues() == expected.topology().residues());
+    }
+}
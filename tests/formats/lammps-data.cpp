@@ -5,6 +5,7 @@
 #include "catch.hpp"
 #include "helpers.hpp"
 #include "chemfiles.hpp"
+#include "chemfiles/formats/LAMMPSData.hpp"
 using namespace chemfiles;
 
 TEST_CASE("Read files in LAMMPS data format") {
@@ -233,3 +234,30 @@ TEST_CASE("Write files in LAMMPS data format") {
                          std::istreambuf_iterator<char>());
     CHECK(content == EXPECTED_CONTENT);
 }
+
+TEST_CASE("Atom styles in LAMMPS data format") {
+    auto data = atom_style("full").read_line("3 2 1 -0.8 1.5 2.5e1 -3", 0);
+    CHECK(data.index == 2);
+    CHECK(data.molid == 2);
+    CHECK(data.type == 1);
+    CHECK(data.charge == -0.8);
+    CHECK(data.x == 1.5);
+    CHECK(data.y == 25);
+    CHECK(data.z == -3);
+
+    data = atom_style("wavepacket").read_line("0 4 0.5 1 2.0 3 0.1 0.2 7 8 9", 12);
+    CHECK(data.index == 12);
+    CHECK(data.type == 4);
+    CHECK(data.charge == 0.5);
+    CHECK(data.x == 7);
+    CHECK(data.y == 8);
+    CHECK(data.z == 9);
+
+    data = atom_style("body").read_line("1 2 0 3.5 1 2 3", 0);
+    CHECK(data.mass == 3.5);
+    CHECK(data.z == 3);
+
+    CHECK_THROWS_AS(atom_style("atomic").read_line("1 2 3 4", 0), FormatError);
+    CHECK_THROWS_AS(atom_style("atomic").read_line("1 2 3 4 five", 0), FormatError);
+    CHECK_THROWS_AS(atom_style("template").read_line("1 2 3.5 4 5 6 7 8", 0), FormatError);
+}
@@ -393,3 +393,39 @@ TEST_CASE("PDB files with big values") {
         }
     }
 }
+
+TEST_CASE("Read only positions in PDB format") {
+    auto tmpfile = NamedTempPath(".pdb");
+    {
+        auto file = Trajectory(tmpfile, 'w');
+        for (size_t step = 0; step < 3; step++) {
+            auto frame = Frame(UnitCell(10 + static_cast<double>(step)));
+            for (size_t i = 0; i < 4; i++) {
+                auto x = static_cast<double>(i);
+                frame.add_atom(Atom("C"), {x, static_cast<double>(step), 0});
+            }
+            auto residue = Residue("FOO", 1);
+            residue.add_atom(0);
+            residue.add_atom(1);
+            frame.add_residue(residue);
+            frame.add_bond(2, 3);
+            file.write(frame);
+        }
+    }
+
+    auto full = Trajectory(tmpfile);
+    auto fast = Trajectory(tmpfile);
+    fast.set_positions_only();
+    for (size_t step = 0; step < 3; step++) {
+        auto expected = full.read();
+        auto frame = fast.read();
+        REQUIRE(frame.size() == 4);
+        for (size_t i = 0; i < 4; i++) {
+            CHECK(approx_eq(frame.positions()[i], expected.positions()[i], 1e-3));
+            CHECK(frame[i] == expected[i]);
+        }
+        CHECK(frame.cell() == expected.cell());
+        CHECK(frame.topology().bonds() == expected.topology().bonds());
+        CHECK(frame.topology().residues() == expected.topology().residues());
+    }
+}
@@ -142,3 +142,73 @@ F 4 5 6
                          std::istreambuf_iterator<char>());
     CHECK(content == expected_content);
 }
+
+TEST_CASE("Find steps in large XYZ files") {
+    // use multiple threads, even on a single core
+    set_io_threads(4);
+
+    auto tmpfile = NamedTempPath(".xyz");
+    auto write_steps = [](std::ofstream& file, size_t start, size_t stop) {
+        for (size_t step = start; step < stop; step++) {
+            auto natoms = step % 7;
+            file << natoms << "\n";
+            // comment lines can also contain integers
+            file << (step % 3 == 0 ? "3" : "comment") << "\n";
+            for (size_t i = 0; i < natoms; i++) {
+                file << "Fe " << step << " " << i << " 0\n";
+            }
+        }
+    };
+
+    auto check_steps = [](Trajectory& trajectory) {
+        auto frame = trajectory.read_step(0);
+        CHECK(frame.size() == 0);
+
+        frame = trajectory.read_step(12345);
+        CHECK(frame.size() == 4);
+        CHECK(frame.positions()[3] == Vector3D(12345, 3, 0));
+
+        frame = trajectory.read_step(59999);
+        CHECK(frame.size() == 2);
+        CHECK(frame.positions()[1] == Vector3D(59999, 1, 0));
+    };
+
+    SECTION("Well formed file") {
+        {
+            std::ofstream file(tmpfile, std::ios::binary);
+            write_steps(file, 0, 60000);
+        }
+
+        auto trajectory = Trajectory(tmpfile);
+        CHECK(trajectory.nsteps() == 60000);
+        check_steps(trajectory);
+    }
+
+    SECTION("Unexpected lines") {
+        {
+            std::ofstream file(tmpfile, std::ios::binary);
+            write_steps(file, 0, 30000);
+            file << "not an atom count\n";
+            write_steps(file, 30000, 60000);
+        }
+
+        auto trajectory = Trajectory(tmpfile);
+        CHECK(trajectory.nsteps() == 60000);
+        check_steps(trajectory);
+    }
+
+    SECTION("Incomplete last step") {
+        {
+            std::ofstream file(tmpfile, std::ios::binary);
+            write_steps(file, 0, 60000);
+            file << "3\ncomment\nFe 0 0 0\n";
+        }
+
+        // the incomplete step is not counted, it might still be written
+        auto trajectory = Trajectory(tmpfile);
+        CHECK(trajectory.nsteps() == 60000);
+        check_steps(trajectory);
+    }
+
+    set_io_threads(0);
+}
@@ -84,6 +84,29 @@ TEST_CASE("Positions and velocities") {
     }
 }
 
+TEST_CASE("Clear frames") {
+    auto frame = Frame();
+    frame.resize(15);
+    frame.add_velocities();
+    frame.set("name", "foo");
+
+    frame.clear();
+    const auto& cleared = frame;
+    CHECK(frame.size() == 0);
+    CHECK_FALSE(frame.velocities());
+    CHECK(frame.properties().size() == 0);
+    // the memory is kept for the next step
+    CHECK(cleared.positions().capacity() >= 15);
+
+    frame.add_atom(Atom("H"), {1, 2, 3}, {4, 5, 6});
+    CHECK_FALSE(frame.velocities());
+    frame.add_velocities();
+    CHECK(cleared.velocities()->capacity() >= 15);
+    CHECK((*frame.velocities())[0] == Vector3D(0, 0, 0));
+    frame.add_atom(Atom("H"), {1, 2, 3}, {4, 5, 6});
+    CHECK((*frame.velocities())[1] == Vector3D(4, 5, 6));
+}
+
 TEST_CASE("Frame step") {
     auto frame = Frame();
     CHECK(frame.step() == 0);
@@ -0,0 +1,76 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+
+#include <cstdio>
+#include <fstream>
+#include <catch.hpp>
+
+#include "helpers.hpp"
+#include "chemfiles.hpp"
+using namespace chemfiles;
+
+static bool file_exists(const std::string& path) {
+    return static_cast<bool>(std::ifstream(path));
+}
+
+static void write_frames(const std::string& path, char mode, size_t count) {
+    auto file = Trajectory(path, mode);
+    for (size_t i = 0; i < count; i++) {
+        auto frame = Frame();
+        frame.add_atom(Atom("C"), {static_cast<double>(i), 0, 0});
+        frame.add_atom(Atom("O"), {0, static_cast<double>(i), 0});
+        file.write(frame);
+    }
+}
+
+TEST_CASE("Step index files") {
+    auto tmpfile = NamedTempPath(".xyz");
+    auto index = std::string(tmpfile) + ".chfl-idx";
+    write_frames(tmpfile, 'w', 3);
+
+    SECTION("Disabled by default") {
+        auto file = Trajectory(tmpfile);
+        CHECK(file.nsteps() == 3);
+        CHECK_FALSE(file_exists(index));
+    }
+
+    SECTION("Create and use index files") {
+        set_step_index_files(true);
+
+        {
+            auto file = Trajectory(tmpfile);
+            CHECK(file.nsteps() == 3);
+        }
+        CHECK(file_exists(index));
+
+        {
+            auto file = Trajectory(tmpfile);
+            CHECK(file.nsteps() == 3);
+            auto frame = file.read_step(2);
+            CHECK(frame.size() == 2);
+            CHECK(frame.positions()[0] == Vector3D(2, 0, 0));
+            frame = file.read_step(1);
+            CHECK(frame.positions()[1] == Vector3D(0, 1, 0));
+        }
+
+        // the index is invalidated when the file changes
+        write_frames(tmpfile, 'a', 2);
+        {
+            auto file = Trajectory(tmpfile);
+            CHECK(file.nsteps() == 5);
+            auto frame = file.read_step(4);
+            CHECK(frame.positions()[0] == Vector3D(1, 0, 0));
+        }
+
+        // invalid index files are ignored
+        std::ofstream(index, std::ios::binary | std::ios::trunc) << "not an index file";
+        {
+            auto file = Trajectory(tmpfile);
+            CHECK(file.nsteps() == 5);
+        }
+
+        set_step_index_files(false);
+    }
+
+    std::remove(index.c_str());
+}
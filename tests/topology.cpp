@@ -1,6 +1,7 @@
 // Chemfiles, a modern library for chemistry file reading and writing
 // Copyright (C) Guillaume Fraux and contributors -- BSD license
 
+#include <thread>
 #include <catch.hpp>
 #include "chemfiles.hpp"
 using namespace chemfiles;
@@ -322,3 +323,89 @@ TEST_CASE("Residues in topologies") {
     second = topology.residue_for_atom(0);
     CHECK(topology.are_linked(*first, *second));
 }
+
+TEST_CASE("Copies of topologies") {
+    auto topology = Topology();
+    for (size_t i = 0; i < 4; i++) {
+        topology.add_atom(Atom("C"));
+    }
+    topology.add_bond(0, 1);
+    topology.add_bond(1, 2);
+    topology.add_residue(Residue("X"));
+
+    SECTION("Copies share the data") {
+        const auto& original = topology;
+        const auto copy = topology;
+        CHECK(&copy[0] == &original[0]);
+        CHECK(&copy.bonds() == &original.bonds());
+        CHECK(copy.angles().size() == 1);
+    }
+
+    SECTION("Modifications copy shared data") {
+        auto copy = topology;
+        copy.add_bond(2, 3);
+        copy.add_atom(Atom("O"));
+        copy.add_residue(Residue("Y"));
+        CHECK(copy.size() == 5);
+        CHECK(copy.bonds().size() == 3);
+        CHECK(copy.residues().size() == 2);
+
+        CHECK(topology.size() == 4);
+        CHECK(topology.bonds().size() == 2);
+        CHECK(topology.angles().size() == 1);
+        CHECK(topology.residues().size() == 1);
+
+        copy = topology;
+        copy[0].set_name("N");
+        CHECK(copy[0].name() == "N");
+        CHECK(topology[0].name() == "C");
+
+        copy.clear();
+        CHECK(copy.size() == 0);
+        CHECK(topology.size() == 4);
+    }
+
+    SECTION("References to atoms") {
+        // references to atoms can be used to modify the topology after
+        // making a copy, so the copy must not share the atoms
+        auto& atom = topology[0];
+        auto copy = topology;
+        atom.set_name("N");
+        CHECK(topology[0].name() == "N");
+        CHECK(copy[0].name() == "C");
+
+        for (auto& it: topology) {
+            it.set_name("O");
+        }
+        CHECK(copy[1].name() == "C");
+    }
+
+    SECTION("Moved-from topologies") {
+        auto moved = std::move(topology);
+        CHECK(moved.size() == 4);
+        // moved-from topologies are empty and can still be used
+        CHECK(topology.size() == 0);
+        topology.add_atom(Atom("H"));
+        CHECK(topology.size() == 1);
+        CHECK(moved.size() == 4);
+    }
+
+    SECTION("Shared data in multiple threads") {
+        // angles are computed lazily, even when the data is shared
+        const auto copy = topology;
+        auto counts = std::vector<size_t>(4, 0);
+        auto threads = std::vector<std::thread>();
+        for (size_t i = 0; i < counts.size(); i++) {
+            threads.emplace_back([&copy, &counts, i]() {
+                auto local = copy;
+                counts[i] = local.angles().size() + local.dihedrals().size();
+            });
+        }
+        for (auto& thread: threads) {
+            thread.join();
+        }
+        for (auto count: counts) {
+            CHECK(count == 1);
+        }
+    }
+}
@@ -1,6 +1,7 @@
 // Chemfiles, a modern library for chemistry file reading and writing
 // Copyright (C) Guillaume Fraux and contributors -- BSD license
 
+#include <thread>
 #include <fstream>
 #include <catch.hpp>
 
@@ -198,6 +199,857 @@ TEST_CASE("Specify a format parameter") {
     CHECK(frame[0].name() == "Fe");
 }
 
+TEST_CASE("Lazy indexing of steps") {
+    auto tmpfile = NamedTempPath(".xyz");
+    {
+        std::ofstream file(tmpfile);
+        for (size_t i = 0; i < 3; i++) {
+            file << "1\ncomment\nFe " << i << " 0 0\n";
+        }
+        // incomplete last step
+        file << "3\ncomment\nFe 0 0 0\n";
+    }
+
+    auto file = Trajectory(tmpfile);
+    // reading the first steps does not look at the end of the file
+    auto frame = file.read();
+    CHECK(frame.positions()[0] == Vector3D(0, 0, 0));
+    frame = file.read_step(2);
+    CHECK(frame.positions()[0] == Vector3D(2, 0, 0));
+    frame = file.read_step(1);
+    CHECK(frame.positions()[0] == Vector3D(1, 0, 0));
+
+    // the incomplete step is not there yet
+    CHECK_THROWS_AS(file.read_step(3), FileError);
+    CHECK(file.nsteps() == 3);
+
+    file = Trajectory(tmpfile);
+    size_t count = 0;
+    while (!file.done()) {
+        file.read();
+        count++;
+    }
+    CHECK(count == 3);
+
+    // a step missing only its last line is also incomplete
+    {
+        std::ofstream file(tmpfile, std::ios::app);
+        file << "Fe 0 0 0\n";
+    }
+    CHECK(file.done());
+    CHECK(file.nsteps() == 3);
+
+    // once the step is complete, reading continues with it
+    {
+        std::ofstream file(tmpfile, std::ios::app);
+        file << "Fe 4 0 0\n";
+    }
+    CHECK_FALSE(file.done());
+    frame = file.read();
+    CHECK(frame.positions()[2] == Vector3D(4, 0, 0));
+    CHECK(file.done());
+    CHECK(file.nsteps() == 4);
+    CHECK_THROWS_AS(file.read(), FileError);
+}
+
+TEST_CASE("Index steps in a growing file") {
+    auto tmpfile = NamedTempPath(".xyz.gz");
+    auto write_steps = [](const std::string& path, size_t count) {
+        auto file = Trajectory(path, 'w');
+        for (size_t i = 0; i < count; i++) {
+            auto frame = Frame();
+            frame.add_atom(Atom("Fe"), {static_cast<double>(i), 0, 0});
+            file.write(frame);
+        }
+    };
+
+    write_steps(tmpfile, 2);
+    auto file = Trajectory(tmpfile);
+    CHECK(file.nsteps() == 2);
+    auto frame = file.read();
+    CHECK(frame.positions()[0] == Vector3D(0, 0, 0));
+
+    // steps written after the file was opened are found. gzip does not
+    // support appending, so add a new gzip member at the end of the file
+    auto more = NamedTempPath(".xyz.gz");
+    write_steps(more, 3);
+    {
+        std::ifstream input(more, std::ios::binary);
+        std::ofstream output(tmpfile, std::ios::binary | std::ios::app);
+        output << input.rdbuf();
+    }
+    CHECK(file.nsteps() == 5);
+    // sequential reading continues where it stopped
+    frame = file.read();
+    CHECK(frame.positions()[0] == Vector3D(1, 0, 0));
+    frame = file.read_step(4);
+    CHECK(frame.positions()[0] == Vector3D(2, 0, 0));
+}
+
+TEST_CASE("Read multiple steps") {
+    auto tmpfile = NamedTempPath(".xyz.gz");
+    {
+        auto file = Trajectory(tmpfile, 'w');
+        for (size_t i = 0; i < 30; i++) {
+            auto frame = Frame();
+            frame.add_atom(Atom("Fe"), {static_cast<double>(i), 0, 0});
+            file.write(frame);
+        }
+    }
+
+    for (size_t threads: std::vector<size_t>{1, 4}) {
+        set_io_threads(threads);
+        auto file = Trajectory(tmpfile);
+        file.set_cell(UnitCell(12));
+
+        auto steps = std::vector<size_t>{5, 0, 29, 5, 12};
+        auto frames = file.read_steps(steps);
+        REQUIRE(frames.size() == 5);
+        for (size_t i = 0; i < steps.size(); i++) {
+            CHECK(frames[i].step() == steps[i]);
+            CHECK(frames[i].positions()[0] == Vector3D(static_cast<double>(steps[i]), 0, 0));
+            CHECK(frames[i].cell() == UnitCell(12));
+        }
+
+        frames = file.read_steps(3, 20, 4);
+        REQUIRE(frames.size() == 5);
+        for (size_t i = 0; i < frames.size(); i++) {
+            CHECK(frames[i].step() == 3 + 4 * i);
+        }
+
+        CHECK(file.read_steps(7, 8).size() == 1);
+        CHECK(file.read_steps(7, 7).empty());
+        CHECK(file.read_steps(std::vector<size_t>()).empty());
+
+        CHECK_THROWS_AS(file.read_steps({3, 30}), FileError);
+        CHECK_THROWS_AS(file.read_steps(25, 31), FileError);
+        CHECK_THROWS_AS(file.read_steps(0, SIZE_MAX), FileError);
+        CHECK(file.read_steps(21, 31, 4).size() == 3);
+        CHECK_THROWS_AS(file.read_steps(0, 10, 0), Error);
+    }
+    set_io_threads(0);
+}
+
+TEST_CASE("Clone trajectories") {
+    for (auto extension: {".xyz", ".xyz.gz"}) {
+        auto tmpfile = NamedTempPath(extension);
+        {
+            auto file = Trajectory(tmpfile, 'w');
+            for (size_t i = 0; i < 30; i++) {
+                auto frame = Frame();
+                frame.add_atom(Atom("Fe"), {static_cast<double>(i), 0, 0});
+                file.write(frame);
+            }
+        }
+
+        auto file = Trajectory(tmpfile);
+        file.set_cell(UnitCell(12));
+        // only find the first steps in the original trajectory
+        file.read_step(10);
+
+        auto clone = file.clone();
+        auto frame = clone.read();
+        CHECK(frame.step() == 0);
+        CHECK(frame.positions()[0] == Vector3D(0, 0, 0));
+        CHECK(frame.cell() == UnitCell(12));
+
+        // the clone continues looking for steps where the original stopped
+        frame = clone.read_step(25);
+        CHECK(frame.positions()[0] == Vector3D(25, 0, 0));
+        CHECK(clone.nsteps() == 30);
+
+        frame = file.read_step(20);
+        CHECK(frame.positions()[0] == Vector3D(20, 0, 0));
+        CHECK(file.nsteps() == 30);
+
+        // use clones from multiple threads
+        auto clones = std::vector<Trajectory>();
+        for (size_t i = 0; i < 4; i++) {
+            clones.emplace_back(file.clone());
+        }
+        auto errors = std::vector<size_t>(clones.size(), 0);
+        auto threads = std::vector<std::thread>();
+        for (size_t i = 0; i < clones.size(); i++) {
+            threads.emplace_back([&, i]() {
+                for (size_t step = i; step < 30; step += 4) {
+                    auto thread_frame = clones[i].read_step(step);
+                    if (thread_frame.positions()[0] != Vector3D(static_cast<double>(step), 0, 0)) {
+                        errors[i]++;
+                    }
+                }
+            });
+        }
+        for (auto& thread: threads) {
+            thread.join();
+        }
+        CHECK(errors == std::vector<size_t>(clones.size(), 0));
+
+        file.close();
+        CHECK_THROWS_AS(file.clone(), FileError);
+    }
+
+    auto file = Trajectory(NamedTempPath(".xyz"), 'w');
+    CHECK_THROWS_AS(file.clone(), FileError);
+}
+
+TEST_CASE("Concatenate trajectories") {
+    auto write_file = [](const std::string& path, size_t start, size_t count) {
+        auto file = Trajectory(path, 'w');
+        for (auto i = start; i < start + count; i++) {
+            auto frame = Frame();
+            frame.add_atom(Atom("Fe"), {static_cast<double>(i), 0, 0});
+            file.write(frame);
+        }
+    };
+
+    auto first = NamedTempPath(".xyz");
+    auto second = NamedTempPath(".xyz");
+    auto third = NamedTempPath(".xyz");
+    // the last step of each file is also the first step of the next one
+    write_file(first, 0, 10);
+    write_file(second, 9, 6);
+    write_file(third, 14, 11);
+
+    SECTION("Read steps") {
+        auto file = Trajectory::concatenate({first, second, third});
+        CHECK(file.path() == std::string(first));
+
+        auto frame = file.read_step(12);
+        CHECK(frame.step() == 12);
+        CHECK(frame.positions()[0] == Vector3D(11, 0, 0));
+
+        frame = file.read_step(3);
+        CHECK(frame.positions()[0] == Vector3D(3, 0, 0));
+
+        frame = file.read_step(26);
+        CHECK(frame.positions()[0] == Vector3D(24, 0, 0));
+
+        CHECK(file.nsteps() == 27);
+        CHECK_THROWS_AS(file.read_step(27), FileError);
+
+        file = Trajectory::concatenate({first, second, third});
+        size_t step = 0;
+        while (!file.done()) {
+            frame = file.read();
+            CHECK(frame.step() == step);
+            step++;
+        }
+        CHECK(step == 27);
+    }
+
+    SECTION("Skip duplicated steps") {
+        auto file = Trajectory::concatenate({first, second, third}, "", true);
+        CHECK(file.nsteps() == 25);
+        for (size_t step = 0; step < 25; step++) {
+            auto frame = file.read();
+            CHECK(frame.positions()[0] == Vector3D(static_cast<double>(step), 0, 0));
+        }
+        CHECK(file.done());
+
+        auto frame = file.read_step(10);
+        CHECK(frame.positions()[0] == Vector3D(10, 0, 0));
+
+        auto clone = file.clone();
+        frame = clone.read_step(14);
+        CHECK(frame.positions()[0] == Vector3D(14, 0, 0));
+        CHECK(clone.nsteps() == 25);
+
+        auto frames = file.read_steps(0, 25, 4);
+        REQUIRE(frames.size() == 7);
+        for (size_t i = 0; i < frames.size(); i++) {
+            CHECK(frames[i].positions()[0] == Vector3D(static_cast<double>(4 * i), 0, 0));
+        }
+    }
+
+    SECTION("Wildcards") {
+        auto base = std::string(NamedTempPath(""));
+        auto paths = std::vector<std::string>{base + "-b.xyz", base + "-a.xyz", base + "-c.pdb"};
+        write_file(paths[0], 5, 5);
+        write_file(paths[1], 0, 5);
+        write_file(paths[2], 10, 5);
+
+        auto file = Trajectory::concatenate({base + "-?.xyz"});
+        CHECK(file.path() == paths[1]);
+        CHECK(file.nsteps() == 10);
+        for (size_t step = 0; step < 10; step++) {
+            auto frame = file.read();
+            CHECK(frame.positions()[0] == Vector3D(static_cast<double>(step), 0, 0));
+        }
+
+        file = Trajectory::concatenate({base + "-*", std::string(first)});
+        CHECK(file.nsteps() == 25);
+
+        CHECK_THROWS_AS(Trajectory::concatenate({base + "-*.nc"}), FileError);
+
+        // step index files next to the data are not matched
+        auto index = paths[1] + ".chfl-idx";
+        std::ofstream(index) << "not a trajectory";
+        file = Trajectory::concatenate({base + "-*"});
+        CHECK(file.nsteps() == 15);
+        file = Trajectory::concatenate({base + "-a.xyz*"});
+        CHECK(file.nsteps() == 5);
+        std::remove(index.c_str());
+
+        // numbers in file names are sorted by value
+        auto numbered = std::vector<std::string>{base + "-part10.xyz", base + "-part2.xyz", base + "-part1.xyz"};
+        write_file(numbered[0], 20, 1);
+        write_file(numbered[1], 10, 1);
+        write_file(numbered[2], 0, 1);
+        file = Trajectory::concatenate({base + "-part*.xyz"});
+        CHECK(file.path() == numbered[2]);
+        REQUIRE(file.nsteps() == 3);
+        CHECK(file.read().positions()[0] == Vector3D(0, 0, 0));
+        CHECK(file.read().positions()[0] == Vector3D(10, 0, 0));
+        CHECK(file.read().positions()[0] == Vector3D(20, 0, 0));
+
+        paths.insert(paths.end(), numbered.begin(), numbered.end());
+        for (auto& path: paths) {
+            std::remove(path.c_str());
+        }
+    }
+
+    SECTION("Count steps in parallel") {
+        auto netcdf = NamedTempPath(".nc");
+        write_file(netcdf, 25, 3);
+
+        set_io_threads(4);
+        // the first file is already opened when counting the steps
+        auto file = Trajectory::concatenate({first, second, netcdf, third});
+        CHECK(file.read_step(5).positions()[0] == Vector3D(5, 0, 0));
+        CHECK(file.nsteps() == 30);
+        CHECK(file.read_step(16).positions()[0] == Vector3D(25, 0, 0));
+
+        file = Trajectory::concatenate({netcdf, first, second, third});
+        CHECK(file.nsteps() == 30);
+        set_io_threads(0);
+    }
+
+    SECTION("Positions only") {
+        // formats with bonds, not able to read only the positions
+        auto write_bonded = [](const std::string& path, size_t start) {
+            auto file = Trajectory(path, 'w');
+            for (auto i = start; i < start + 2; i++) {
+                auto frame = Frame();
+                frame.add_atom(Atom("C"), {static_cast<double>(i), 0, 0});
+                frame.add_atom(Atom("O"), {static_cast<double>(i), 1, 0});
+                frame.add_bond(0, 1);
+                file.write(frame);
+            }
+        };
+        auto sdf_1 = NamedTempPath(".sdf");
+        auto sdf_2 = NamedTempPath(".sdf");
+        auto xyz = NamedTempPath(".xyz");
+        write_bonded(sdf_1, 0);
+        write_bonded(sdf_2, 2);
+        write_bonded(xyz, 4);
+
+        auto file = Trajectory::concatenate({sdf_1, sdf_2, xyz});
+        file.set_positions_only();
+        for (size_t step = 0; step < 6; step++) {
+            auto frame = file.read();
+            CHECK(frame.positions()[0] == Vector3D(static_cast<double>(step), 0, 0));
+            CHECK(frame.topology().bonds().size() == 1);
+        }
+        CHECK(file.done());
+    }
+
+    SECTION("Atom subset") {
+        auto file = Trajectory::concatenate({first, second, third});
+        file.set_atom_subset(std::vector<size_t>{0});
+        auto frame = file.read_step(12);
+        CHECK(frame.size() == 1);
+        CHECK(frame.positions()[0] == Vector3D(11, 0, 0));
+
+        file.set_atom_subset({1});
+        CHECK_THROWS_AS(file.read_step(3), OutOfBounds);
+    }
+
+    SECTION("Errors") {
+        CHECK_THROWS_AS(Trajectory::concatenate({}), FileError);
+        CHECK_THROWS_AS(Trajectory::concatenate({first, "not-there.xyz"}), FileError);
+
+        auto file = Trajectory::concatenate({first, second});
+        CHECK_THROWS_AS(file.write(Frame()), FileError);
+    }
+}
+
+TEST_CASE("Read a subset of the atoms") {
+    auto tmpfile = NamedTempPath(".xyz");
+    {
+        auto file = Trajectory(tmpfile, 'w');
+        for (size_t step = 0; step < 5; step++) {
+            auto frame = Frame();
+            for (size_t i = 0; i < 10; i++) {
+                auto name = i % 3 == 0 ? "O" : "H";
+                frame.add_atom(Atom(name), {static_cast<double>(i), static_cast<double>(step), 0});
+            }
+            file.write(frame);
+        }
+    }
+
+    auto file = Trajectory(tmpfile);
+    file.set_atom_subset({6, 0, 3, 4, 3});
+
+    auto frame = file.read();
+    REQUIRE(frame.size() == 4);
+    CHECK(frame.step() == 0);
+    CHECK(frame.positions()[0] == Vector3D(0, 0, 0));
+    CHECK(frame.positions()[1] == Vector3D(3, 0, 0));
+    CHECK(frame.positions()[2] == Vector3D(4, 0, 0));
+    CHECK(frame.positions()[3] == Vector3D(6, 0, 0));
+    CHECK(frame[2].name() == "H");
+
+    SECTION("Custom topology") {
+        auto topology = Topology();
+        for (size_t i = 0; i < 10; i++) {
+            topology.add_atom(Atom(i % 3 == 0 ? "O" : "H"));
+        }
+        topology.add_bond(0, 1);
+        topology.add_bond(3, 4, Bond::DOUBLE);
+        topology.add_bond(4, 6);
+        auto residue = Residue("foo", 3);
+        residue.add_atom(2);
+        residue.add_atom(3);
+        residue.set("bar", 42);
+        topology.add_residue(residue);
+        topology.add_residue(Residue("not-used"));
+
+        file.set_topology(topology);
+        frame = file.read_step(3);
+        REQUIRE(frame.size() == 4);
+        CHECK(frame.positions()[3] == Vector3D(6, 3, 0));
+
+        auto& subset = frame.topology();
+        CHECK(subset.bonds() == std::vector<Bond>{{1, 2}, {2, 3}});
+        CHECK(subset.bond_order(1, 2) == Bond::DOUBLE);
+        REQUIRE(subset.residues().size() == 1);
+        CHECK(subset.residues()[0].name() == "foo");
+        CHECK(*subset.residues()[0].id() == 3);
+        CHECK(subset.residues()[0].contains(1));
+        CHECK(subset.residues()[0].size() == 1);
+        CHECK(subset.residues()[0].get("bar")->as_double() == 42);
+
+        CHECK_THROWS_AS(file.set_atom_subset({1, 5, 12}), OutOfBounds);
+        // the previous subset is still used
+        frame = file.read();
+        CHECK(frame.size() == 4);
+    }
+
+    SECTION("Selection") {
+        file.set_atom_subset(Selection("name O and x > 2"));
+
+        // the state of the trajectory is not changed by the selection
+        frame = file.read();
+        CHECK(frame.step() == 1);
+        REQUIRE(frame.size() == 3);
+        CHECK(frame.positions()[0] == Vector3D(3, 1, 0));
+
+        frame = file.read_step(4);
+        REQUIRE(frame.size() == 3);
+        CHECK(frame.positions()[0] == Vector3D(3, 4, 0));
+        CHECK(frame.positions()[1] == Vector3D(6, 4, 0));
+        CHECK(frame.positions()[2] == Vector3D(9, 4, 0));
+
+        CHECK_THROWS_AS(file.set_atom_subset(Selection("pairs: all")), SelectionError);
+    }
+
+    SECTION("Clones and multiple steps") {
+        auto clone = file.clone();
+        frame = clone.read_step(2);
+        CHECK(frame.size() == 4);
+        CHECK(frame.positions()[3] == Vector3D(6, 2, 0));
+
+        auto frames = file.read_steps({4, 1, 2});
+        for (auto& step_frame: frames) {
+            CHECK(step_frame.size() == 4);
+        }
+        CHECK(frames[0].positions()[3] == Vector3D(6, 4, 0));
+    }
+
+    SECTION("Read all atoms again") {
+        file.set_atom_subset({});
+        frame = file.read();
+        CHECK(frame.size() == 10);
+        CHECK(frame.positions()[9] == Vector3D(9, 1, 0));
+    }
+
+    SECTION("Errors") {
+        file.set_atom_subset({1, 10});
+        CHECK_THROWS_AS(file.read(), OutOfBounds);
+
+        auto output = Trajectory(NamedTempPath(".xyz"), 'w');
+        CHECK_THROWS_AS(output.set_atom_subset({1, 2}), FileError);
+    }
+}
+
+TEST_CASE("Read only positions") {
+    auto tmpfile = NamedTempPath(".xyz");
+    {
+        auto file = Trajectory(tmpfile, 'w');
+        for (size_t step = 0; step < 5; step++) {
+            auto frame = Frame();
+            for (size_t i = 0; i < 3; i++) {
+                // use different names at each step, to check which topology
+                // is used when reading
+                auto name = std::string(1, static_cast<char>('A' + step));
+                frame.add_atom(Atom(name), {static_cast<double>(i), static_cast<double>(step), 0});
+            }
+            file.write(frame);
+        }
+    }
+
+    auto file = Trajectory(tmpfile);
+    file.set_positions_only();
+
+    auto frame = file.read_step(1);
+    CHECK(frame[0].name() == "B");
+    CHECK(frame.positions()[2] == Vector3D(2, 1, 0));
+
+    // the topology of the first frame is used for all the next frames
+    frame = file.read_step(3);
+    CHECK(frame[0].name() == "B");
+    CHECK(frame.positions()[2] == Vector3D(2, 3, 0));
+
+    // the frames share the same atoms, including when reading into an
+    // existing frame
+    auto other = file.read_step(2);
+    auto atom = &other.topology()[0];
+    CHECK(&file.read_step(0).topology()[0] == atom);
+    file.read_step(4, other);
+    CHECK(&other.topology()[0] == atom);
+    CHECK(other.positions()[2] == Vector3D(2, 4, 0));
+
+    auto clone = file.clone();
+    frame = clone.read_step(4);
+    CHECK(frame[1].name() == "B");
+    CHECK(frame.positions()[1] == Vector3D(1, 4, 0));
+
+    SECTION("Prefetch frames") {
+        auto other = Trajectory(tmpfile);
+        other.set_positions_only();
+        size_t step = 0;
+        for (auto& prefetched: other.frames()) {
+            CHECK(prefetched[2].name() == "A");
+            CHECK(prefetched.positions()[2] == Vector3D(2, static_cast<double>(step), 0));
+            step++;
+        }
+        CHECK(step == 5);
+    }
+
+    SECTION("Custom topology") {
+        auto topology = Topology();
+        topology.add_atom(Atom("Zn"));
+        topology.add_atom(Atom("Zn"));
+        topology.add_atom(Atom("Zn"));
+        file.set_topology(topology);
+
+        frame = file.read_step(2);
+        CHECK(frame[0].name() == "Zn");
+        CHECK(frame.positions()[2] == Vector3D(2, 2, 0));
+
+        topology.add_atom(Atom("Zn"));
+        file.set_topology(topology);
+        CHECK_THROWS_AS(file.read_step(2), Error);
+    }
+
+    SECTION("Atom subset") {
+        file.set_atom_subset({1, 2});
+        frame = file.read_step(4);
+        CHECK(frame.size() == 2);
+        CHECK(frame[0].name() == "E");
+
+        frame = file.read_step(2);
+        CHECK(frame[0].name() == "E");
+        CHECK(frame.positions()[0] == Vector3D(1, 2, 0));
+    }
+
+    SECTION("Read full frames again") {
+        file.set_positions_only(false);
+        frame = file.read_step(2);
+        CHECK(frame[0].name() == "C");
+        frame = file.read_step(4);
+        CHECK(frame[0].name() == "E");
+    }
+}
+
+TEST_CASE("Read metadata") {
+    for (auto extension: {".xyz", ".pdb", ".gro"}) {
+        auto tmpfile = NamedTempPath(extension);
+        {
+            auto file = Trajectory(tmpfile, 'w');
+            for (size_t step = 0; step < 20; step++) {
+                auto frame = Frame(UnitCell(10 + static_cast<double>(step)));
+                for (size_t i = 0; i < step + 1; i++) {
+                    frame.add_atom(Atom("Zn"), {static_cast<double>(i), 0, 0});
+                }
+                file.write(frame);
+            }
+        }
+
+        auto file = Trajectory(tmpfile);
+        auto metadata = file.read_metadata(12);
+        CHECK(metadata.step == 12);
+        CHECK(metadata.natoms == 13);
+        CHECK_FALSE(metadata.time);
+        if (std::string(extension) != ".xyz") {
+            CHECK(metadata.cell == UnitCell(22));
+        }
+
+        // reading metadata does not change the current step
+        auto frame = file.read();
+        CHECK(frame.step() == 0);
+        CHECK(frame.size() == 1);
+
+        auto all = file.scan_metadata();
+        REQUIRE(all.size() == 20);
+        for (size_t step = 0; step < 20; step++) {
+            CHECK(all[step].step == step);
+            CHECK(all[step].natoms == step + 1);
+            if (std::string(extension) != ".xyz") {
+                CHECK(all[step].cell == UnitCell(10 + static_cast<double>(step)));
+            }
+        }
+
+        frame = file.read();
+        CHECK(frame.step() == 1);
+        CHECK(frame.size() == 2);
+
+        file.set_cell(UnitCell(3));
+        CHECK(file.read_metadata(4).cell == UnitCell(3));
+
+        CHECK_THROWS_AS(file.read_metadata(20), FileError);
+        file.close();
+        CHECK_THROWS_AS(file.read_metadata(0), FileError);
+    }
+
+    SECTION("Frame properties") {
+        auto tmpfile = NamedTempPath(".gro");
+        {
+            auto file = Trajectory(tmpfile, 'w');
+            auto frame = Frame();
+            frame.set("name", "first frame");
+            frame.add_atom(Atom("Zn"), {0, 0, 0});
+            file.write(frame);
+        }
+
+        auto file = Trajectory(tmpfile);
+        auto metadata = file.read_metadata(0);
+        CHECK(metadata.properties.get("name")->as_string() == "first frame");
+    }
+
+    SECTION("Errors") {
+        auto file = Trajectory(NamedTempPath(".xyz"), 'w');
+        CHECK_THROWS_AS(file.read_metadata(0), FileError);
+        CHECK_THROWS_AS(file.scan_metadata(), FileError);
+    }
+}
+
+TEST_CASE("Read a range of steps") {
+    auto tmpfile = NamedTempPath(".xyz");
+    {
+        std::ofstream file(tmpfile);
+        for (size_t i = 0; i < 30; i++) {
+            file << "1\ncomment\nFe " << i << " 0 0\n";
+        }
+    }
+
+    auto file = Trajectory(tmpfile);
+    auto steps = std::vector<size_t>();
+    for (auto& frame: file.read_range(3, 20, 4)) {
+        CHECK(frame.positions()[0] == Vector3D(static_cast<double>(frame.step()), 0, 0));
+        steps.push_back(frame.step());
+    }
+    CHECK(steps == std::vector<size_t>{3, 7, 11, 15, 19});
+
+    // iteration stops at the end of the file
+    steps.clear();
+    for (auto& frame: file.read_range(25)) {
+        steps.push_back(frame.step());
+    }
+    CHECK(steps == std::vector<size_t>{25, 26, 27, 28, 29});
+
+    steps.clear();
+    for (auto& frame: file.read_range(0, SIZE_MAX, 10)) {
+        steps.push_back(frame.step());
+    }
+    CHECK(steps == std::vector<size_t>{0, 10, 20});
+
+    auto range = file.read_range(40);
+    CHECK(range.begin() == range.end());
+
+    CHECK_THROWS_AS(file.read_range(0, 10, 0), Error);
+
+    range = file.read_range(0);
+    file.close();
+    CHECK_THROWS_AS(range.begin(), FileError);
+}
+
+TEST_CASE("Prefetch frames in a background thread") {
+    auto tmpfile = NamedTempPath(".xyz");
+    {
+        std::ofstream file(tmpfile);
+        for (size_t i = 0; i < 20; i++) {
+            file << "1\ncomment\nFe " << i << " 0 0\n";
+        }
+    }
+
+    SECTION("Read all frames") {
+        auto file = Trajectory(tmpfile);
+        size_t count = 0;
+        for (auto& frame: file.frames(3)) {
+            CHECK(frame.step() == count);
+            CHECK(frame.positions()[0] == Vector3D(static_cast<double>(count), 0, 0));
+            count++;
+        }
+        CHECK(count == 20);
+        CHECK(file.done());
+
+        file = Trajectory(tmpfile);
+        auto frames = file.frames(0);
+        auto frame = Frame();
+        count = 0;
+        while (frames.next(frame)) {
+            CHECK(frame.step() == count);
+            count++;
+        }
+        CHECK(count == 20);
+        CHECK_FALSE(frames.next(frame));
+    }
+
+    SECTION("Start after the current step") {
+        auto file = Trajectory(tmpfile);
+        file.read();
+        file.read();
+
+        auto frames = file.frames();
+        auto it = frames.begin();
+        CHECK(it->step() == 2);
+        ++it;
+        CHECK(it->step() == 3);
+    }
+
+    SECTION("Stop before the end") {
+        auto file = Trajectory(tmpfile);
+        {
+            auto frames = file.frames(2);
+            for (auto& frame: frames) {
+                if (frame.step() == 5) {
+                    break;
+                }
+            }
+        }
+        // the background thread read at most a few frames in advance
+        CHECK_FALSE(file.done());
+        auto frame = file.read();
+        CHECK(frame.step() > 5);
+        CHECK(frame.step() <= 9);
+    }
+
+    SECTION("Errors") {
+        {
+            std::ofstream file(tmpfile, std::ios::app);
+            // invalid last step
+            file << "2\ncomment\nFe 0 0 0\nFe a b c\n";
+        }
+
+        auto file = Trajectory(tmpfile);
+        size_t count = 0;
+        auto frames = file.frames(4);
+        auto frame = Frame();
+        while (count < 20) {
+            CHECK(frames.next(frame));
+            count++;
+        }
+        CHECK_THROWS_AS(frames.next(frame), Error);
+        CHECK_FALSE(frames.next(frame));
+
+        auto output = Trajectory(NamedTempPath(".xyz"), 'w');
+        CHECK_THROWS_AS(output.frames(), FileError);
+    }
+}
+
+TEST_CASE("Read into an existing frame") {
+    auto tmpfile = NamedTempPath(".xyz");
+    {
+        std::ofstream file(tmpfile);
+        file << "3\ncomment\nFe 0 0 0\nFe 1 0 0\nFe 2 0 0\n";
+        file << "2\ncomment\nZn 0 1 0\nZn 0 2 0\n";
+    }
+
+    auto frame = Frame(UnitCell(10));
+    frame.add_velocities();
+    for (size_t i = 0; i < 10; i++) {
+        frame.add_atom(Atom("O"), {0, 0, 0});
+    }
+    frame.add_bond(0, 1);
+    auto residue = Residue("ALA");
+    residue.add_atom(0);
+    frame.add_residue(residue);
+    frame.set("name", "water");
+    frame.set_step(33);
+    const auto* positions = frame.positions().data();
+
+    auto file = Trajectory(tmpfile);
+    file.read(frame);
+    CHECK(frame.size() == 3);
+    CHECK(frame.step() == 0);
+    CHECK(frame[0].name() == "Fe");
+    CHECK(frame.positions()[2] == Vector3D(2, 0, 0));
+    CHECK_FALSE(frame.velocities());
+    CHECK(frame.cell() == UnitCell());
+    CHECK(frame.topology().bonds().empty());
+    CHECK(frame.topology().residues().empty());
+    CHECK_FALSE(frame.get("name"));
+    // the memory allocated for the positions is re-used
+    CHECK(frame.positions().data() == positions);
+
+    file.read(frame);
+    CHECK(frame.size() == 2);
+    CHECK(frame.step() == 1);
+    CHECK(frame[1].name() == "Zn");
+    CHECK(frame.positions()[1] == Vector3D(0, 2, 0));
+    CHECK(frame.positions().data() == positions);
+    CHECK_THROWS_AS(file.read(frame), FileError);
+
+    file.read_step(0, frame);
+    CHECK(frame.size() == 3);
+    CHECK(frame.step() == 0);
+    CHECK(frame.positions()[1] == Vector3D(1, 0, 0));
+    CHECK_THROWS_AS(file.read_step(2, frame), FileError);
+
+    file.set_cell(UnitCell(22));
+    file.read_step(1, frame);
+    CHECK(frame.cell() == UnitCell(22));
+}
+
+TEST_CASE("Copies of frames read from files") {
+    for (auto extension: std::vector<std::string>{".xyz", ".pdb"}) {
+        auto tmpfile = NamedTempPath(extension);
+        {
+            auto frame = Frame();
+            frame.add_atom(Atom("Fe"), {0, 0, 0});
+            frame.add_atom(Atom("Zn"), {1, 0, 0});
+            auto file = Trajectory(tmpfile, 'w');
+            file.write(frame);
+        }
+
+        auto file = Trajectory(tmpfile);
+        auto frame = file.read();
+        const auto& topology = frame.topology();
+
+        // copies of the frame and of its topology share the atoms
+        auto clone = frame.clone();
+        CHECK(&clone.topology()[0] == &topology[0]);
+        const auto copy = frame.topology();
+        CHECK(&copy[0] == &topology[0]);
+
+        frame[0].set_name("Cu");
+        CHECK(frame[0].name() == "Cu");
+        CHECK(clone[0].name() == "Fe");
+        CHECK(copy[0].name() == "Fe");
+    }
+}
+
 TEST_CASE("Errors") {
     SECTION("Unknow opening mode") {
         CHECK_THROWS_AS(Trajectory("trajectory.xyz", 'z'), FileError);
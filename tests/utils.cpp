@@ -1,5 +1,7 @@
 // Chemfiles, a modern library for chemistry file reading and writing
 // Copyright (C) Guillaume Fraux and contributors -- BSD license
+#include <cmath>
+#include <climits>
 #include <catch.hpp>
 #include <boost/filesystem.hpp>
 namespace fs=boost::filesystem;
@@ -29,6 +31,12 @@ TEST_CASE("trim") {
     CHECK(chemfiles::trim("lines\r\n") == "lines");
     CHECK(chemfiles::trim("\r\nlines\r") == "lines");
     CHECK(chemfiles::trim("   and \t with\rsome\n   inside  \t") == "and \t with\rsome\n   inside");
+
+    auto string = std::string("  view  ");
+    auto view = chemfiles::trim(chemfiles::string_view(string));
+    CHECK(view == "view");
+    CHECK(view.data() == string.data() + 2);
+    CHECK(chemfiles::trim(chemfiles::string_view(" \t ")).empty());
 }
 
 TEST_CASE("split") {
@@ -37,6 +45,13 @@ TEST_CASE("split") {
 
     expected = std::vector<std::string>{"bla  bla", " jk:fiuks"};
     CHECK(chemfiles::split(",,bla  bla, jk:fiuks", ',') == expected);
+
+    auto string = std::string("  12.5 3  -8 ");
+    auto views = chemfiles::split(chemfiles::string_view(string), ' ');
+    REQUIRE(views.size() == 3);
+    CHECK(views[0] == "12.5");
+    CHECK(views[1] == "3");
+    CHECK(views[2] == "-8");
 }
 
 TEST_CASE("String parsing") {
@@ -44,12 +59,35 @@ TEST_CASE("String parsing") {
         CHECK(chemfiles::parse<double>("12.5") == 12.5);
         CHECK(chemfiles::parse<double>("125") == 125);
         CHECK(chemfiles::parse<double>("-32") == -32);
+        CHECK(chemfiles::parse<double>(chemfiles::string_view("12.5 and more", 4)) == 12.5);
 
         CHECK_THROWS_AS(chemfiles::parse<double>("foo"), chemfiles::Error);
         CHECK_THROWS_AS(chemfiles::parse<double>("1,2"), chemfiles::Error);
         CHECK_THROWS_AS(chemfiles::parse<double>("3e456782"), chemfiles::Error);
     }
 
+    SECTION("Double edge cases") {
+        CHECK(chemfiles::parse<double>("  +4.5") == 4.5);
+        CHECK(chemfiles::parse<double>(".5") == 0.5);
+        CHECK(chemfiles::parse<double>("5.") == 5);
+        CHECK(chemfiles::parse<double>("1.5e3") == 1500);
+        CHECK(chemfiles::parse<double>("-2E-2") == -0.02);
+        CHECK(chemfiles::parse<double>("1.5e25") == 1.5e25);
+        CHECK(chemfiles::parse<double>("0.30000000000000004441") == 0.30000000000000004441);
+        CHECK(chemfiles::parse<double>("123456789012345678901234567890") == 123456789012345678901234567890.0);
+        CHECK(chemfiles::parse<double>("2.2250738585072011e-308") == 2.2250738585072011e-308);
+        CHECK(chemfiles::parse<double>("1e-400") == 0);
+        CHECK(std::isinf(chemfiles::parse<double>("-inf")));
+        CHECK(std::isnan(chemfiles::parse<double>("NaN")));
+
+        CHECK_THROWS_AS(chemfiles::parse<double>(""), chemfiles::Error);
+        CHECK_THROWS_AS(chemfiles::parse<double>("."), chemfiles::Error);
+        CHECK_THROWS_AS(chemfiles::parse<double>("+-3"), chemfiles::Error);
+        CHECK_THROWS_AS(chemfiles::parse<double>("1e"), chemfiles::Error);
+        CHECK_THROWS_AS(chemfiles::parse<double>("1.5 "), chemfiles::Error);
+        CHECK_THROWS_AS(chemfiles::parse<double>("0x1p3"), chemfiles::Error);
+    }
+
     SECTION("long long") {
         CHECK(chemfiles::parse<long long>("125") == 125);
         CHECK(chemfiles::parse<long long>("-32") == -32);
@@ -68,3 +106,90 @@ TEST_CASE("String parsing") {
         CHECK_THROWS_AS(chemfiles::parse<size_t>("9223372036854775808"), chemfiles::Error);
     }
 }
+
+TEST_CASE("String parsing without exceptions") {
+    CHECK(chemfiles::try_parse<double>(" 12.5").value() == 12.5);
+    CHECK_FALSE(chemfiles::try_parse<double>("12.5 and more"));
+    CHECK_FALSE(chemfiles::try_parse<double>("1e456782"));
+
+    CHECK(chemfiles::try_parse<long long>("-32").value() == -32);
+    CHECK_FALSE(chemfiles::try_parse<long long>("2.5"));
+    CHECK_FALSE(chemfiles::try_parse<long long>("9223372036854775808"));
+
+    CHECK(chemfiles::try_parse<size_t>("125").value() == 125);
+    CHECK_FALSE(chemfiles::try_parse<size_t>("-32"));
+    CHECK_FALSE(chemfiles::try_parse<size_t>(""));
+}
+
+TEST_CASE("from_chars") {
+    auto string = std::string("-12.5e2abc");
+    double value = 0;
+    auto result = chemfiles::from_chars(string.data(), string.data() + string.size(), value);
+    CHECK(result.ec == std::errc());
+    CHECK(result.ptr == string.data() + 7);
+    CHECK(value == -1250);
+
+    // only use the given range
+    result = chemfiles::from_chars(string.data(), string.data() + 3, value);
+    CHECK(result.ec == std::errc());
+    CHECK(value == -12);
+
+    string = "foo";
+    value = 42;
+    result = chemfiles::from_chars(string.data(), string.data() + string.size(), value);
+    CHECK(result.ec == std::errc::invalid_argument);
+    CHECK(result.ptr == string.data());
+    CHECK(value == 42);
+
+    string = "1e500";
+    result = chemfiles::from_chars(string.data(), string.data() + string.size(), value);
+    CHECK(result.ec == std::errc::result_out_of_range);
+    CHECK(value == 42);
+
+    long long integer = 0;
+    string = "-9223372036854775808 ";
+    result = chemfiles::from_chars(string.data(), string.data() + string.size(), integer);
+    CHECK(result.ec == std::errc());
+    CHECK(result.ptr == string.data() + 20);
+    CHECK(integer == LLONG_MIN);
+
+    string = "9223372036854775808";
+    result = chemfiles::from_chars(string.data(), string.data() + string.size(), integer);
+    CHECK(result.ec == std::errc::result_out_of_range);
+
+    unsigned long long unsigned_integer = 0;
+    result = chemfiles::from_chars(string.data(), string.data() + string.size(), unsigned_integer);
+    CHECK(result.ec == std::errc());
+    CHECK(unsigned_integer == 9223372036854775808ull);
+
+    string = "-3";
+    result = chemfiles::from_chars(string.data(), string.data() + string.size(), unsigned_integer);
+    CHECK(result.ec == std::errc::invalid_argument);
+}
+
+TEST_CASE("scan") {
+    auto line = chemfiles::string_view("  Fe 1.5\t-2 +3e1   5 6  ");
+    chemfiles::string_view name;
+    double x = 0, y = 0, z = 0;
+    unsigned count = 0;
+    auto used = chemfiles::scan(line, name, x, y, z, count);
+    CHECK(name == "Fe");
+    CHECK(x == 1.5);
+    CHECK(y == -2);
+    CHECK(z == 30);
+    CHECK(count == 5);
+    CHECK(used == 21);
+
+    std::string last;
+    used += chemfiles::scan(line.substr(used), last);
+    CHECK(last == "6");
+    CHECK(used == line.size());
+
+    CHECK_THROWS_AS(chemfiles::scan(line, name, x, y, z, count, count, count), chemfiles::Error);
+    CHECK_THROWS_AS(chemfiles::scan(line, x), chemfiles::Error);
+    CHECK_THROWS_AS(chemfiles::scan("-5", count), chemfiles::Error);
+    CHECK_THROWS_AS(chemfiles::scan("2.5", count), chemfiles::Error);
+
+    uint8_t small = 0;
+    CHECK_THROWS_AS(chemfiles::scan("300", small), chemfiles::Error);
+}